@@ -17,5 +17,7 @@ win32 {
 
 unix {
         LIBS += -L$$OUT_PWD/../VBE/
+        # OBJLoader parses large files on several threads
+        LIBS += -pthread
         PRE_TARGETDEPS += $$OUT_PWD/../VBE/libVBE.a
 }
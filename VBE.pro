@@ -14,6 +14,13 @@ INCLUDEPATH += include src
 LIBS += -lGLEW -lGL -lSDL2
 QMAKE_CXXFLAGS += -std=c++0x -fno-exceptions
 
+# qmake CONFIG+=headless builds the EGL backend, for servers and CI without a display
+headless {
+    DEFINES += VBE_HEADLESS
+    LIBS -= -lSDL2
+    LIBS += -lEGL
+}
+
 OTHER_FILES += \
     Doxyfile \
     src/VBE/system/android/ClockImpl.hpp \
@@ -43,11 +50,16 @@ HEADERS += \
     include/VBE/graphics/RenderBuffer.hpp \
     include/VBE/graphics/Shader.hpp \
     include/VBE/graphics/ShaderProgram.hpp \
+    include/VBE/graphics/Sampler.hpp \
     include/VBE/graphics/Texture.hpp \
     include/VBE/graphics/Texture2D.hpp \
     include/VBE/graphics/Texture2DArray.hpp \
+    include/VBE/graphics/Texture2DMultisample.hpp \
+    include/VBE/graphics/TextureAtlas.hpp \
     include/VBE/graphics/Texture3D.hpp \
     include/VBE/graphics/TextureCubemap.hpp \
+    include/VBE/graphics/TextureCache.hpp \
+    include/VBE/graphics/TextureHandleTable.hpp \
     include/VBE/graphics/TextureFormat.hpp \
     include/VBE/graphics/Uniform.hpp \
     include/VBE/graphics/Vertex.hpp \
@@ -61,6 +73,8 @@ HEADERS += \
     src/VBE/graphics/ShaderBinding.hpp \
     src/VBE/dependencies/stb_image/stb_image.hpp \
     include/VBE/system/Clock.hpp \
+    include/VBE/system/FramePacer.hpp \
+    include/VBE/system/Profiler.hpp \
     src/VBE/system/sdl2/ClockImpl.hpp \
     src/VBE/system/ClockImpl.hpp \
     src/VBE/system/InputImpl.hpp \
@@ -78,9 +92,17 @@ HEADERS += \
     include/VBE/graphics/RenderTarget.hpp \
     include/VBE/graphics/Image.hpp \
     include/VBE/graphics/RenderTargetLayered.hpp \
+    include/VBE/graphics/FrameGraph.hpp \
+    include/VBE/graphics/GpuProfiler.hpp \
+    include/VBE/graphics/GLStats.hpp \
     include/VBE/graphics/MeshSeparate.hpp \
     include/VBE/graphics/MeshBase.hpp \
     include/VBE/graphics/MeshBatched.hpp \
+    include/VBE/graphics/MeshCache.hpp \
+    include/VBE/graphics/MeshClusterizer.hpp \
+    include/VBE/graphics/MeshOptimizer.hpp \
+    include/VBE/graphics/MeshQuantizer.hpp \
+    include/VBE/graphics/MeshSimplifier.hpp \
     include/VBE/system/Gamepad.hpp \
     include/VBE/system/Touch.hpp
 
@@ -96,17 +118,24 @@ SOURCES += \
     src/VBE/graphics/Shader.cpp \
     src/VBE/graphics/ShaderBinding.cpp \
     src/VBE/graphics/ShaderProgram.cpp \
+    src/VBE/graphics/Sampler.cpp \
     src/VBE/graphics/Texture.cpp \
     src/VBE/graphics/Texture2D.cpp \
     src/VBE/graphics/Texture2DArray.cpp \
+    src/VBE/graphics/Texture2DMultisample.cpp \
+    src/VBE/graphics/TextureAtlas.cpp \
     src/VBE/graphics/Texture3D.cpp \
     src/VBE/graphics/TextureCubemap.cpp \
+    src/VBE/graphics/TextureCache.cpp \
+    src/VBE/graphics/TextureHandleTable.cpp \
     src/VBE/graphics/Uniform.cpp \
     src/VBE/graphics/Vertex.cpp \
     src/VBE/system/Log.cpp \
     src/VBE/system/Mouse.cpp \
     src/VBE/system/Keyboard.cpp \
     src/VBE/system/Clock.cpp \
+    src/VBE/system/FramePacer.cpp \
+    src/VBE/system/Profiler.cpp \
     src/VBE/system/sdl2/ClockImpl.cpp \
     src/VBE/system/sdl2/InputImpl.cpp \
     src/VBE/system/Window.cpp \
@@ -118,8 +147,40 @@ SOURCES += \
     src/VBE/graphics/RenderTarget.cpp \
     src/VBE/graphics/Image.cpp \
     src/VBE/graphics/RenderTargetLayered.cpp \
+    src/VBE/graphics/FrameGraph.cpp \
+    src/VBE/graphics/GpuProfiler.cpp \
+    src/VBE/graphics/GLStats.cpp \
     src/VBE/graphics/MeshSeparate.cpp \
     src/VBE/graphics/MeshBase.cpp \
     src/VBE/graphics/MeshBatched.cpp \
+    src/VBE/graphics/MeshCache.cpp \
+    src/VBE/graphics/MeshClusterizer.cpp \
+    src/VBE/graphics/MeshOptimizer.cpp \
+    src/VBE/graphics/MeshQuantizer.cpp \
+    src/VBE/graphics/MeshSimplifier.cpp \
     src/VBE/system/Gamepad.cpp \
     src/VBE/system/Touch.cpp
+
+headless {
+    HEADERS -= \
+        src/VBE/system/sdl2/ClockImpl.hpp \
+        src/VBE/system/sdl2/InputImpl.hpp \
+        src/VBE/system/sdl2/sdl2.hpp \
+        src/VBE/system/sdl2/WindowImpl.hpp \
+        src/VBE/system/sdl2/StorageImpl.hpp
+    SOURCES -= \
+        src/VBE/system/sdl2/ClockImpl.cpp \
+        src/VBE/system/sdl2/InputImpl.cpp \
+        src/VBE/system/sdl2/WindowImpl.cpp \
+        src/VBE/system/sdl2/StorageImpl.cpp
+    HEADERS += \
+        src/VBE/system/headless/ClockImpl.hpp \
+        src/VBE/system/headless/InputImpl.hpp \
+        src/VBE/system/headless/WindowImpl.hpp \
+        src/VBE/system/headless/StorageImpl.hpp
+    SOURCES += \
+        src/VBE/system/headless/ClockImpl.cpp \
+        src/VBE/system/headless/InputImpl.cpp \
+        src/VBE/system/headless/WindowImpl.cpp \
+        src/VBE/system/headless/StorageImpl.cpp
+}
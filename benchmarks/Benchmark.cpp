@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <ostream>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/system/Clock.hpp>
+#include <VBE/system/Log.hpp>
+
+#include "Benchmark.hpp"
+
+namespace {
+    void writeJsonString(std::ostream& out, const std::string& s) {
+        out << '"';
+        for(char c : s) {
+            if(c == '"' || c == '\\') out << '\\' << c;
+            else if((unsigned char) c < 0x20) out << ' ';
+            else out << c;
+        }
+        out << '"';
+    }
+
+    std::string getGLString(GLenum name) {
+        const GLubyte* s = glGetString(name);
+        return s == nullptr ? std::string() : std::string((const char*) s);
+    }
+
+    const char* getBackend() {
+#if defined(VBE_SYSTEM_HEADLESS)
+        return "headless";
+#elif defined(VBE_SYSTEM_ANDROID)
+        return "android";
+#else
+        return "sdl2";
+#endif
+    }
+
+    const char* getBuildType() {
+#ifdef VBE_DEBUG
+        return "debug";
+#else
+        return "release";
+#endif
+    }
+}
+
+// static
+std::vector<Benchmark::Entry> Benchmark::entries;
+std::string Benchmark::filter;
+unsigned int Benchmark::samples = 10;
+long long Benchmark::minSampleTime = 20000000;
+volatile unsigned long long Benchmark::sink = 0;
+
+Benchmark::State::State(unsigned long long iterations, unsigned int argument)
+    : iterations(iterations), argument(argument) {
+}
+
+bool Benchmark::State::keepRunning() {
+    if(done < iterations) {
+        if(done == 0) {
+            // Work queued by the setup must not be billed to the first iterations
+            glFinish();
+            running = true;
+            start = Clock::getNanoseconds();
+        }
+        ++done;
+        return true;
+    }
+    glFinish();
+    if(running) elapsed += Clock::getNanoseconds() - start;
+    running = false;
+    return false;
+}
+
+void Benchmark::State::pauseTiming() {
+    VBE_ASSERT(running, "Benchmark timer is not running");
+    elapsed += Clock::getNanoseconds() - start;
+    running = false;
+}
+
+void Benchmark::State::resumeTiming() {
+    VBE_ASSERT(!running, "Benchmark timer is already running");
+    running = true;
+    start = Clock::getNanoseconds();
+}
+
+void Benchmark::State::setItemsPerIteration(unsigned long long newItems) {
+    items = newItems;
+}
+
+void Benchmark::State::setBytesPerIteration(unsigned long long newBytes) {
+    bytes = newBytes;
+}
+
+// static
+void Benchmark::add(const std::string& name, Function function) {
+    Entry e;
+    e.name = name;
+    e.function = function;
+    e.argument = 0;
+    entries.push_back(e);
+}
+
+// static
+void Benchmark::add(const std::string& name, Function function, const std::vector<unsigned int>& arguments) {
+    for(unsigned int argument : arguments) {
+        Entry e;
+        e.name = name + "/" + std::to_string(argument);
+        e.function = function;
+        e.argument = argument;
+        entries.push_back(e);
+    }
+}
+
+// static
+void Benchmark::setFilter(const std::string& newFilter) {
+    filter = newFilter;
+}
+
+// static
+void Benchmark::setSamples(unsigned int newSamples) {
+    VBE_ASSERT(newSamples > 0, "Benchmarks need at least one sample");
+    samples = newSamples;
+}
+
+// static
+void Benchmark::setMinSampleTime(float milliseconds) {
+    VBE_ASSERT(milliseconds > 0.0f, "Minimum sample time must be positive");
+    minSampleTime = (long long) (milliseconds*1e6f);
+}
+
+// static
+std::vector<std::string> Benchmark::getNames() {
+    std::vector<std::string> names;
+    for(const Entry& e : entries)
+        if(matches(e)) names.push_back(e.name);
+    return names;
+}
+
+// static
+std::vector<Benchmark::Result> Benchmark::run(std::ostream* progress) {
+    std::vector<Result> results;
+    for(const Entry& e : entries) {
+        if(!matches(e)) continue;
+        if(progress != nullptr) *progress << e.name << std::endl;
+        results.push_back(measure(e));
+    }
+    return results;
+}
+
+// static
+void Benchmark::writeTable(std::ostream& out, const std::vector<Result>& results) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    out << std::left << std::setw(48) << "benchmark" << std::right
+        << std::setw(14) << "median ns" << std::setw(14) << "min ns" << std::setw(14) << "stddev"
+        << std::setw(14) << "iterations" << std::setw(16) << "items/s" << "\n";
+    for(const Result& r : results) {
+        out << std::left << std::setw(48) << r.name << std::right
+            << std::setw(14) << r.median << std::setw(14) << r.min << std::setw(14) << r.stddev
+            << std::setw(14) << r.iterations;
+        if(r.itemsPerSecond > 0.0) out << std::setw(16) << std::setprecision(0) << r.itemsPerSecond << std::setprecision(1);
+        out << "\n";
+    }
+    out.precision(precision);
+    out.flags(flags);
+}
+
+// static
+void Benchmark::writeJson(std::ostream& out, const std::vector<Result>& results) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    char date[32] = "";
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << "{\n  \"context\": {\n    \"date\": \"" << date << "\",\n"
+        << "    \"backend\": \"" << getBackend() << "\",\n"
+        << "    \"build\": \"" << getBuildType() << "\",\n"
+        << "    \"vendor\": ";
+    writeJsonString(out, getGLString(GL_VENDOR));
+    out << ",\n    \"renderer\": ";
+    writeJsonString(out, getGLString(GL_RENDERER));
+    out << ",\n    \"version\": ";
+    writeJsonString(out, getGLString(GL_VERSION));
+    out << ",\n    \"samples\": " << samples
+        << ",\n    \"min_sample_time_ms\": " << minSampleTime*1e-6
+        << "\n  },\n  \"benchmarks\": [";
+    for(unsigned int i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+        writeJsonString(out, r.name);
+        out << ", \"iterations\": " << r.iterations << ", \"samples\": " << r.samples
+            << ", \"median_ns\": " << r.median << ", \"min_ns\": " << r.min
+            << ", \"mean_ns\": " << r.mean << ", \"stddev_ns\": " << r.stddev
+            << ", \"items_per_second\": " << r.itemsPerSecond
+            << ", \"bytes_per_second\": " << r.bytesPerSecond << "}";
+    }
+    out << "\n  ]\n}\n";
+    out.precision(precision);
+    out.flags(flags);
+}
+
+// static
+void Benchmark::writeCsv(std::ostream& out, const std::vector<Result>& results) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "name,iterations,samples,median_ns,min_ns,mean_ns,stddev_ns,items_per_second,bytes_per_second\n";
+    for(const Result& r : results)
+        out << r.name << "," << r.iterations << "," << r.samples << "," << r.median << "," << r.min
+            << "," << r.mean << "," << r.stddev << "," << r.itemsPerSecond << "," << r.bytesPerSecond << "\n";
+    out.precision(precision);
+    out.flags(flags);
+}
+
+// static
+bool Benchmark::matches(const Entry& e) {
+    return filter.empty() || e.name.find(filter) != std::string::npos;
+}
+
+// static
+Benchmark::State Benchmark::runSample(const Entry& e, unsigned long long iterations) {
+    State state(iterations, e.argument);
+    e.function(state);
+    VBE_ASSERT(state.done == iterations && !state.running,
+               "Benchmark " << e.name << " must loop until keepRunning() returns false");
+    return state;
+}
+
+// static
+Benchmark::Result Benchmark::measure(const Entry& e) {
+    // Grow the iteration count until a sample lasts long enough to be timed reliably
+    unsigned long long iterations = 1;
+    for(;;) {
+        long long elapsed = runSample(e, iterations).elapsed;
+        if(elapsed >= minSampleTime || iterations >= 1000000000ULL) break;
+        double scale = (elapsed > 0 ? 1.2*minSampleTime/elapsed : 10.0);
+        iterations = std::max(iterations + 1, (unsigned long long) (iterations*std::min(scale, 10.0)));
+    }
+
+    Result r;
+    r.name = e.name;
+    r.iterations = iterations;
+    r.samples = samples;
+    std::vector<double> times;
+    unsigned long long items = 0, bytes = 0;
+    for(unsigned int i = 0; i < samples; ++i) {
+        State state = runSample(e, iterations);
+        times.push_back(double(state.elapsed)/iterations);
+        items = state.items;
+        bytes = state.bytes;
+    }
+    std::sort(times.begin(), times.end());
+
+    r.min = times.front();
+    r.median = (samples%2 == 1 ? times[samples/2] : (times[samples/2 - 1] + times[samples/2])/2.0);
+    for(double t : times) r.mean += t;
+    r.mean /= samples;
+    for(double t : times) r.stddev += (t - r.mean)*(t - r.mean);
+    r.stddev = std::sqrt(r.stddev/samples);
+    if(r.median > 0.0) {
+        r.itemsPerSecond = items*1e9/r.median;
+        r.bytesPerSecond = bytes*1e9/r.median;
+    }
+    return r;
+}
@@ -0,0 +1,179 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+///
+/// \brief Benchmark times registered functions and reports the cost of one iteration
+///
+/// Every benchmark runs a calibration pass that finds how many iterations fill the
+/// minimum sample time, then measures that many iterations once per sample. The GL
+/// queue is drained before and after every sample so queued work is not carried
+/// over to the next measurement.
+///
+class Benchmark {
+    public:
+        ///
+        /// \brief Passed to every benchmark function, drives its measured loop
+        ///
+        /// ~~~{.cpp}
+        /// void benchFoo(Benchmark::State& state) {
+        ///     Foo foo(state.getArgument()); // Setup, not measured
+        ///     while(state.keepRunning())
+        ///         foo.bar();
+        /// }
+        /// ~~~
+        ///
+        class State {
+            public:
+                ///
+                /// \brief Returns true while there are iterations left. The timer starts on the first call.
+                ///
+                bool keepRunning();
+
+                ///
+                /// \brief Stops the timer, for per-iteration work that must not be measured
+                ///
+                void pauseTiming();
+
+                ///
+                /// \brief Restarts the timer after pauseTiming()
+                ///
+                void resumeTiming();
+
+                ///
+                /// \brief Sets how many items one iteration processes, for the items per second column
+                ///
+                void setItemsPerIteration(unsigned long long items);
+
+                ///
+                /// \brief Sets how many bytes one iteration processes, for the bytes per second column
+                ///
+                void setBytesPerIteration(unsigned long long bytes);
+
+                ///
+                /// \brief Returns the argument this benchmark was registered with, or 0
+                ///
+                unsigned int getArgument() const {return argument;}
+
+                ///
+                /// \brief Returns how many iterations this sample runs
+                ///
+                unsigned long long getIterations() const {return iterations;}
+
+            private:
+                State(unsigned long long iterations, unsigned int argument);
+
+                const unsigned long long iterations;
+                const unsigned int argument;
+                unsigned long long done = 0;
+                unsigned long long items = 0;
+                unsigned long long bytes = 0;
+                long long start = 0;
+                long long paused = 0;
+                long long elapsed = 0;
+                bool running = false;
+
+                friend class Benchmark;
+        };
+
+        typedef std::function<void(State&)> Function;
+
+        ///
+        /// \brief The measurements of one benchmark. Times are in nanoseconds per iteration.
+        ///
+        struct Result {
+                std::string name; ///< Name, with the argument appended as "name/argument"
+                unsigned long long iterations = 0; ///< Iterations per sample
+                unsigned int samples = 0; ///< Number of samples taken
+                double median = 0.0; ///< Median time
+                double min = 0.0; ///< Fastest sample
+                double mean = 0.0; ///< Average of all samples
+                double stddev = 0.0; ///< Standard deviation of the samples
+                double itemsPerSecond = 0.0; ///< From the median, 0 if the benchmark doesn't set items
+                double bytesPerSecond = 0.0; ///< From the median, 0 if the benchmark doesn't set bytes
+        };
+
+        ///
+        /// \brief Registers a benchmark
+        ///
+        static void add(const std::string& name, Function function);
+
+        ///
+        /// \brief Registers a benchmark once for every argument
+        ///
+        static void add(const std::string& name, Function function, const std::vector<unsigned int>& arguments);
+
+        ///
+        /// \brief Only run the benchmarks whose name contains filter. Empty runs them all.
+        ///
+        static void setFilter(const std::string& filter);
+
+        ///
+        /// \brief Sets how many samples are taken of every benchmark. Defaults to 10.
+        ///
+        static void setSamples(unsigned int samples);
+
+        ///
+        /// \brief Sets the minimum duration of a sample, in milliseconds. Defaults to 20.
+        ///
+        static void setMinSampleTime(float milliseconds);
+
+        ///
+        /// \brief Returns the names of the registered benchmarks that pass the filter
+        ///
+        static std::vector<std::string> getNames();
+
+        ///
+        /// \brief Runs the benchmarks that pass the filter, in registration order
+        /// \param progress Receives the name of every benchmark as it starts, may be null
+        ///
+        static std::vector<Result> run(std::ostream* progress = nullptr);
+
+        ///
+        /// \brief Writes results as an aligned table for people
+        ///
+        static void writeTable(std::ostream& out, const std::vector<Result>& results);
+
+        ///
+        /// \brief Writes results as JSON, with the context they were measured in
+        ///
+        static void writeJson(std::ostream& out, const std::vector<Result>& results);
+
+        ///
+        /// \brief Writes results as CSV, one line per benchmark
+        ///
+        static void writeCsv(std::ostream& out, const std::vector<Result>& results);
+
+        ///
+        /// \brief Keeps the compiler from discarding a computation whose result is otherwise unused
+        ///
+        template<typename T>
+        static void keep(const T& value) {
+            sink = sink + static_cast<unsigned long long>(value);
+        }
+
+    private:
+        Benchmark();
+
+        struct Entry {
+                std::string name;
+                Function function;
+                unsigned int argument;
+        };
+
+        static bool matches(const Entry& e);
+        static State runSample(const Entry& e, unsigned long long iterations);
+        static Result measure(const Entry& e);
+
+        static std::vector<Entry> entries;
+        static std::string filter;
+        static unsigned int samples;
+        static long long minSampleTime;
+        static volatile unsigned long long sink;
+};
+
+#endif // BENCHMARK_HPP
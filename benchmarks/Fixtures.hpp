@@ -0,0 +1,63 @@
+#ifndef FIXTURES_HPP
+#define FIXTURES_HPP
+
+#include <string>
+#include <vector>
+
+#include <VBE/graphics/Vertex.hpp>
+
+// Every suite registers its benchmarks from main()
+void registerMeshBenchmarks();
+void registerMeshOptimizerBenchmarks();
+void registerOBJBenchmarks();
+void registerShaderBenchmarks();
+void registerStateBenchmarks();
+void registerVertexBenchmarks();
+
+// Position, normal and texture coordinate, like the meshes from OBJLoader
+inline Vertex::Format getBenchmarkFormat() {
+    std::vector<Vertex::Attribute> elements;
+    elements.push_back(Vertex::Attribute("a_position", Vertex::Attribute::Float, 3));
+    elements.push_back(Vertex::Attribute("a_normal", Vertex::Attribute::Float, 3));
+    elements.push_back(Vertex::Attribute("a_texCoord", Vertex::Attribute::Float, 2));
+    return Vertex::Format(elements);
+}
+
+// Tiny triangles in a corner of the screen, so draws cost submission rather than fill
+inline std::vector<float> getBenchmarkVertices(unsigned int count) {
+    std::vector<float> data(count*8, 0.0f);
+    for(unsigned int i = 0; i < count; ++i) {
+        float* v = &data[i*8];
+        v[0] = -1.0f + (i%3 == 1 ? 0.01f : 0.0f);
+        v[1] = -1.0f + (i%3 == 2 ? 0.01f : 0.0f);
+        v[5] = 1.0f;
+    }
+    return data;
+}
+
+// Draws the format above, uses draw_index so it works with MeshBatched::drawBatched
+inline std::string getBenchmarkVertexShader() {
+    return
+        "#version 430 core\n"
+        "in vec3 a_position;\n"
+        "in vec3 a_normal;\n"
+        "in vec2 a_texCoord;\n"
+        "in uint draw_index;\n"
+        "out vec4 v_color;\n"
+        "void main() {\n"
+        "    v_color = vec4(a_normal*0.5 + 0.5, float(draw_index & 255u)/255.0) + vec4(a_texCoord, 0.0, 0.0);\n"
+        "    gl_Position = vec4(a_position, 1.0);\n"
+        "}\n";
+}
+
+inline std::string getBenchmarkFragmentShader() {
+    return
+        "#version 430 core\n"
+        "in vec4 v_color;\n"
+        "out vec4 color;\n"
+        "void main() {\n"
+        "    color = v_color;\n"
+        "}\n";
+}
+
+#endif // FIXTURES_HPP
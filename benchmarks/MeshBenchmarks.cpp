@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+
+#include <VBE/graphics/MeshBatched.hpp>
+#include <VBE/graphics/ShaderProgram.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    const unsigned int meshesPerIteration = 64;
+
+    typedef std::vector<std::unique_ptr<MeshBatched>> Meshes;
+
+    void allocate(Meshes& meshes, const Vertex::Format& format, const std::vector<float>& data, unsigned int vertices) {
+        for(unsigned int i = 0; i < meshesPerIteration; ++i) {
+            meshes.emplace_back(new MeshBatched(format));
+            meshes.back()->setVertexData(&data[0], vertices);
+        }
+    }
+
+    // Frees in a fixed random order, so free intervals have to be merged from both sides
+    void freeShuffled(Meshes& meshes, std::mt19937& random) {
+        std::shuffle(meshes.begin(), meshes.end(), random);
+        meshes.clear();
+    }
+
+    void benchAllocate(Benchmark::State& state) {
+        unsigned int vertices = state.getArgument();
+        Vertex::Format format = getBenchmarkFormat();
+        std::vector<float> data = getBenchmarkVertices(vertices);
+        // Keeps the shared buffer alive, or every iteration would measure creating it
+        MeshBatched anchor(format);
+        anchor.setVertexData(&data[0], vertices);
+        Meshes meshes;
+        meshes.reserve(meshesPerIteration);
+        std::mt19937 random(42);
+        // Grow the buffer to its final size before measuring
+        allocate(meshes, format, data, vertices);
+        freeShuffled(meshes, random);
+
+        state.setItemsPerIteration(meshesPerIteration);
+        state.setBytesPerIteration(meshesPerIteration*vertices*format.vertexSize());
+        while(state.keepRunning()) {
+            allocate(meshes, format, data, vertices);
+            state.pauseTiming();
+            freeShuffled(meshes, random);
+            state.resumeTiming();
+        }
+    }
+
+    void benchFree(Benchmark::State& state) {
+        unsigned int vertices = state.getArgument();
+        Vertex::Format format = getBenchmarkFormat();
+        std::vector<float> data = getBenchmarkVertices(vertices);
+        MeshBatched anchor(format);
+        anchor.setVertexData(&data[0], vertices);
+        Meshes meshes;
+        meshes.reserve(meshesPerIteration);
+        std::mt19937 random(42);
+        // Grow the buffer to its final size before measuring
+        allocate(meshes, format, data, vertices);
+        freeShuffled(meshes, random);
+
+        state.setItemsPerIteration(meshesPerIteration);
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            allocate(meshes, format, data, vertices);
+            state.resumeTiming();
+            freeShuffled(meshes, random);
+        }
+    }
+
+    void benchDrawBatched(Benchmark::State& state) {
+        unsigned int count = state.getArgument();
+        Vertex::Format format = getBenchmarkFormat();
+        std::vector<float> data = getBenchmarkVertices(3);
+        ShaderProgram program(getBenchmarkVertexShader(), getBenchmarkFragmentShader());
+        std::vector<MeshBatched> meshes;
+        meshes.reserve(count);
+        for(unsigned int i = 0; i < count; ++i) {
+            meshes.emplace_back(format);
+            meshes.back().setVertexData(&data[0], 3);
+        }
+
+        // The first draw creates the shader binding and compiles the driver's shader variant
+        meshes[0].draw(program);
+
+        state.setItemsPerIteration(count);
+        while(state.keepRunning()) {
+            MeshBatched::startBatch();
+            for(const MeshBatched& m : meshes)
+                m.drawBatched(program);
+            MeshBatched::endBatch();
+        }
+    }
+
+    void benchDraw(Benchmark::State& state) {
+        unsigned int count = state.getArgument();
+        Vertex::Format format = getBenchmarkFormat();
+        std::vector<float> data = getBenchmarkVertices(3);
+        ShaderProgram program(getBenchmarkVertexShader(), getBenchmarkFragmentShader());
+        std::vector<MeshBatched> meshes;
+        meshes.reserve(count);
+        for(unsigned int i = 0; i < count; ++i) {
+            meshes.emplace_back(format);
+            meshes.back().setVertexData(&data[0], 3);
+        }
+
+        meshes[0].draw(program);
+
+        state.setItemsPerIteration(count);
+        while(state.keepRunning())
+            for(const MeshBatched& m : meshes)
+                m.draw(program);
+    }
+}
+
+void registerMeshBenchmarks() {
+    Benchmark::add("MeshBatched/allocate", benchAllocate, {36, 1024});
+    Benchmark::add("MeshBatched/free", benchFree, {36, 1024});
+    Benchmark::add("MeshBatched/drawBatched", benchDrawBatched, {16, 256, 4096});
+    Benchmark::add("MeshBatched/draw", benchDraw, {16, 256, 4096});
+}
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <VBE/graphics/MeshClusterizer.hpp>
+#include <VBE/graphics/MeshOptimizer.hpp>
+#include <VBE/graphics/MeshSimplifier.hpp>
+#include <VBE/math.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    struct GridVertex {
+            vec3f pos, nor;
+            vec2f tex;
+    };
+
+    // A size x size grid with its triangles shuffled, the worst order for the cache
+    struct Grid {
+            std::vector<GridVertex> vertices;
+            std::vector<unsigned int> indices;
+    };
+
+    Grid makeGrid(unsigned int size) {
+        Grid g;
+        for(unsigned int y = 0; y <= size; ++y) {
+            for(unsigned int x = 0; x <= size; ++x) {
+                GridVertex v;
+                v.pos = vec3f(float(x)/size, 0.1f*std::sin(x*0.37f + y*0.11f), float(y)/size);
+                v.nor = vec3f(0.0f, 1.0f, 0.0f);
+                v.tex = vec2f(float(x)/size, float(y)/size);
+                g.vertices.push_back(v);
+            }
+        }
+        std::vector<unsigned int> quads(size*size);
+        for(unsigned int i = 0; i < quads.size(); ++i) quads[i] = i;
+        std::shuffle(quads.begin(), quads.end(), std::mt19937(42));
+        for(unsigned int q : quads) {
+            unsigned int a = (q/size)*(size + 1) + q%size, b = a + 1, c = a + size + 1, d = c + 1;
+            unsigned int quad[6] = {a, c, b, b, c, d};
+            g.indices.insert(g.indices.end(), quad, quad + 6);
+        }
+        return g;
+    }
+
+    Vertex::Format getGridFormat() {
+        std::vector<Vertex::Attribute> elements;
+        elements.push_back(Vertex::Attribute("position", Vertex::Attribute::Float, 3));
+        elements.push_back(Vertex::Attribute("normal", Vertex::Attribute::Float, 3));
+        elements.push_back(Vertex::Attribute("texcoord", Vertex::Attribute::Float, 2));
+        return Vertex::Format(elements);
+    }
+
+    MeshSimplifier::Options getGridOptions() {
+        MeshSimplifier::Options options;
+        options.position = "position";
+        options.normal = "normal";
+        options.texcoord = "texcoord";
+        return options;
+    }
+
+    void benchVertexCache(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> indices;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            indices = grid.indices;
+            state.resumeTiming();
+            MeshOptimizer::optimizeVertexCache(indices, grid.vertices.size());
+        }
+    }
+
+    void benchOverdraw(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> indices;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            indices = grid.indices;
+            state.resumeTiming();
+            MeshOptimizer::optimizeOverdraw(indices, grid.vertices.data(), grid.vertices.size(), sizeof(GridVertex));
+        }
+    }
+
+    void benchVertexFetch(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        state.setItemsPerIteration(grid.vertices.size());
+        std::vector<GridVertex> vertices;
+        std::vector<unsigned int> indices;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            vertices = grid.vertices;
+            indices = grid.indices;
+            state.resumeTiming();
+            Benchmark::keep(MeshOptimizer::optimizeVertexFetch(vertices.data(), vertices.size(), sizeof(GridVertex), indices));
+        }
+    }
+
+    void benchStripify(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> indices;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            indices = grid.indices;
+            state.resumeTiming();
+            MeshOptimizer::stripify(indices, grid.vertices.size());
+        }
+    }
+
+    void benchSplit(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> indices;
+        std::vector<unsigned int> remap;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            indices = grid.indices;
+            state.resumeTiming();
+            Benchmark::keep(MeshOptimizer::splitIndices(indices, grid.vertices.size(), remap).size());
+        }
+    }
+
+    void benchSimplify(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        Vertex::Format format = getGridFormat();
+        MeshSimplifier::Options options = getGridOptions();
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> result;
+        while(state.keepRunning())
+            Benchmark::keep(MeshSimplifier::simplify(format, grid.vertices.data(), grid.vertices.size(), grid.indices, result,
+                                                     grid.indices.size()/2, 1.0f, options));
+    }
+
+    void benchBuildLods(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        Vertex::Format format = getGridFormat();
+        MeshSimplifier::Options options = getGridOptions();
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> result;
+        while(state.keepRunning())
+            Benchmark::keep(MeshSimplifier::buildLods(format, grid.vertices.data(), grid.vertices.size(), grid.indices, result,
+                                                      4, 0.5f, options).size());
+    }
+
+    void benchClusterize(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        std::vector<unsigned int> indices;
+        while(state.keepRunning()) {
+            state.pauseTiming();
+            indices = grid.indices;
+            state.resumeTiming();
+            Benchmark::keep(MeshClusterizer::build(indices, grid.vertices.data(), grid.vertices.size(), sizeof(GridVertex)).size());
+        }
+    }
+
+    void benchClusterCull(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        MeshOptimizer::optimizeVertexCache(grid.indices, grid.vertices.size());
+        std::vector<MeshClusterizer::Cluster> clusters = MeshClusterizer::build(grid.indices, grid.vertices.data(), grid.vertices.size(), sizeof(GridVertex));
+        Frustum frustum;
+        frustum.calculate(glm::perspective(glm::radians(60.0f), 1.0f, 0.01f, 10.0f)*
+                          glm::lookAt(vec3f(0.5f, 0.3f, -0.2f), vec3f(0.5f, 0.0f, 0.5f), vec3f(0.0f, 1.0f, 0.0f)));
+        state.setItemsPerIteration(clusters.size());
+        std::vector<MeshClusterizer::Range> ranges;
+        while(state.keepRunning()) {
+            MeshClusterizer::cull(clusters, frustum, vec3f(0.5f, 0.3f, -0.2f), ranges);
+            Benchmark::keep(ranges.size());
+        }
+    }
+
+    void benchAnalyze(Benchmark::State& state) {
+        Grid grid = makeGrid(state.getArgument());
+        state.setItemsPerIteration(grid.indices.size()/3);
+        while(state.keepRunning())
+            Benchmark::keep(MeshOptimizer::analyzeVertexCache(grid.indices, grid.vertices.size()).transformed);
+    }
+}
+
+void registerMeshOptimizerBenchmarks() {
+    Benchmark::add("MeshOptimizer::optimizeVertexCache", benchVertexCache, {64, 512});
+    Benchmark::add("MeshOptimizer::optimizeOverdraw", benchOverdraw, {64, 512});
+    Benchmark::add("MeshOptimizer::optimizeVertexFetch", benchVertexFetch, {64, 512});
+    Benchmark::add("MeshOptimizer::stripify", benchStripify, {64, 512});
+    Benchmark::add("MeshOptimizer::splitIndices", benchSplit, {64, 512});
+    Benchmark::add("MeshSimplifier::simplify", benchSimplify, {64, 256});
+    Benchmark::add("MeshSimplifier::buildLods", benchBuildLods, {64, 256});
+    Benchmark::add("MeshClusterizer::build", benchClusterize, {64, 512});
+    Benchmark::add("MeshClusterizer::cull", benchClusterCull, {64, 512});
+    Benchmark::add("MeshOptimizer::analyzeVertexCache", benchAnalyze, {64, 512});
+}
@@ -0,0 +1,191 @@
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include <VBE/graphics/Mesh.hpp>
+#include <VBE/graphics/MeshCache.hpp>
+#include <VBE/graphics/MeshIndexed.hpp>
+#include <VBE/graphics/OBJLoader.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    // A size x size grid of quads, written like exporters do: v, vt and vn for every
+    // grid point, then two v/t/n triangles per quad
+    std::string makeGridOBJ(unsigned int size) {
+        std::ostringstream out;
+        out.precision(6);
+        out << std::fixed;
+        out << "# " << size << "x" << size << " grid\n";
+        for(unsigned int y = 0; y <= size; ++y)
+            for(unsigned int x = 0; x <= size; ++x)
+                out << "v " << float(x)/size << " " << 0.1f*std::sin(x*0.37f + y*0.11f) << " " << float(y)/size << "\n";
+        for(unsigned int y = 0; y <= size; ++y)
+            for(unsigned int x = 0; x <= size; ++x)
+                out << "vt " << float(x)/size << " " << float(y)/size << "\n";
+        for(unsigned int y = 0; y <= size; ++y)
+            for(unsigned int x = 0; x <= size; ++x)
+                out << "vn " << 0.0f << " " << 1.0f << " " << 0.0f << "\n";
+        for(unsigned int y = 0; y < size; ++y) {
+            for(unsigned int x = 0; x < size; ++x) {
+                unsigned int a = y*(size + 1) + x + 1, b = a + 1, c = a + size + 1, d = c + 1;
+                out << "f " << a << "/" << a << "/" << a << " " << c << "/" << c << "/" << c << " " << b << "/" << b << "/" << b << "\n";
+                out << "f " << b << "/" << b << "/" << b << " " << c << "/" << c << "/" << c << " " << d << "/" << d << "/" << d << "\n";
+            }
+        }
+        return out.str();
+    }
+
+    struct FunctorComparevec3i {
+            bool operator()(const vec3i& a, const vec3i& b) const {
+                if(a.x != b.x) return a.x < b.x;
+                if(a.y != b.y) return a.y < b.y;
+                return a.z < b.z;
+            }
+    };
+
+    // The line by line loader OBJLoader used before parsing whole buffers, kept as the baseline
+    MeshSeparate* loadLegacy(std::istream& in) {
+        std::vector<Vertex::Attribute> elements;
+        elements.push_back(Vertex::Attribute("position", Vertex::Attribute::Float, 3));
+        elements.push_back(Vertex::Attribute("normal", Vertex::Attribute::Float, 3));
+        elements.push_back(Vertex::Attribute("texcoord", Vertex::Attribute::Float, 2));
+
+        struct vert {
+                vert(vec3f pos, vec3f nor, vec2f tex) : pos(pos) , nor(nor), tex(tex) {}
+                vec3f pos, nor;
+                vec2f tex;
+        };
+
+        std::vector<vec3f> vertices;
+        std::vector<vec3f> normals;
+        std::vector<vec2f> textures;
+        std::vector<unsigned int> indices;
+        std::vector<vert> dataIndexed;
+        std::vector<vert> dataNotIndexed;
+        std::map<vec3i, int, FunctorComparevec3i> indexMap;
+
+        std::string line;
+        while (getline(in, line)) {
+            if (line.substr(0, 2) == "v ") {
+                std::istringstream s(line.substr(2));
+                vec3f v;
+                s >> v.x >> v.y >> v.z;
+                vertices.push_back(v);
+            }
+            else if (line.substr(0, 3) == "vn ") {
+                std::istringstream s(line.substr(3));
+                vec3f v;
+                s >> v.x >> v.y >> v.z;
+                normals.push_back(v);
+            }
+            else if (line.substr(0, 3) == "vt ") {
+                std::istringstream s(line.substr(3));
+                vec2f v;
+                s >> v.x >> v.y;
+                v.y = 1-v.y;
+                textures.push_back(v);
+            }
+            else if (line.substr(0, 2) == "f ") {
+                std::istringstream s(line.substr(2));
+                std::vector<vec3i> vInf(3, vec3i(0));
+                char b;
+                s   >> vInf[0].x >> b >> vInf[0].y >> b >> vInf[0].z
+                        >> vInf[1].x >> b >> vInf[1].y >> b >> vInf[1].z
+                        >> vInf[2].x >> b >> vInf[2].y >> b >> vInf[2].z;
+                for(unsigned int i = 0; i < 3; ++i) {
+                    std::map<vec3i, int, FunctorComparevec3i>::iterator it = indexMap.find(vInf[i]);
+                    int ind = 0;
+                    if(it == indexMap.end()) {
+                        ind = indexMap.size();
+                        indexMap.insert(std::pair<vec3i, int>(vInf[i], dataIndexed.size()));
+                        dataIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], textures[vInf[i].y-1]));
+                    }
+                    else ind = it->second;
+                    indices.push_back(ind);
+                    dataNotIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], textures[vInf[i].y-1]));
+                }
+            }
+        }
+        int sizeWithIndex = dataIndexed.size()*sizeof(vert)+indices.size()*sizeof(int);
+        int sizeWithoutIndex = dataNotIndexed.size()*sizeof(vert);
+        MeshSeparate* mesh = nullptr;
+        if(sizeWithoutIndex > sizeWithIndex) {
+            mesh = new MeshIndexed(Vertex::Format(elements));
+            mesh->setVertexData(&dataIndexed[0], dataIndexed.size());
+            ((MeshIndexed*)mesh)->setIndexData(&indices[0], indices.size());
+        }
+        else {
+            mesh = new Mesh(Vertex::Format(elements));
+            mesh->setVertexData(&dataNotIndexed[0], dataNotIndexed.size());
+        }
+        return mesh;
+    }
+
+    void benchLegacy(Benchmark::State& state) {
+        unsigned int size = state.getArgument();
+        std::string obj = makeGridOBJ(size);
+        state.setItemsPerIteration(2*size*size);
+        state.setBytesPerIteration(obj.size());
+        while(state.keepRunning()) {
+            std::istringstream in(obj);
+            delete loadLegacy(in);
+        }
+    }
+
+    void benchStandard(Benchmark::State& state) {
+        unsigned int size = state.getArgument();
+        std::string obj = makeGridOBJ(size);
+        state.setItemsPerIteration(2*size*size);
+        state.setBytesPerIteration(obj.size());
+        while(state.keepRunning())
+            delete OBJLoader::loadFromOBJStandard(std::unique_ptr<std::istream>(new std::istringstream(obj)), Mesh::STATIC);
+    }
+
+    void benchTangents(Benchmark::State& state) {
+        unsigned int size = state.getArgument();
+        std::string obj = makeGridOBJ(size);
+        state.setItemsPerIteration(2*size*size);
+        state.setBytesPerIteration(obj.size());
+        while(state.keepRunning())
+            delete OBJLoader::loadFromOBJTangents(std::unique_ptr<std::istream>(new std::istringstream(obj)), Mesh::STATIC);
+    }
+
+    // The argument is the thread count, on the largest grid
+    void benchThreads(Benchmark::State& state) {
+        std::string obj = makeGridOBJ(512);
+        state.setItemsPerIteration(2*512*512);
+        state.setBytesPerIteration(obj.size());
+        OBJLoader::setThreadCount(state.getArgument());
+        while(state.keepRunning())
+            delete OBJLoader::loadFromOBJStandard(std::unique_ptr<std::istream>(new std::istringstream(obj)), Mesh::STATIC);
+        OBJLoader::setThreadCount(0);
+    }
+
+    // A cache file of the same size as the mesh loadFromOBJStandard builds from the grid
+    void benchCache(Benchmark::State& state) {
+        unsigned int size = state.getArgument();
+        std::vector<float> vertices = getBenchmarkVertices((size + 1)*(size + 1));
+        std::vector<unsigned int> indices(6*size*size);
+        for(unsigned int i = 0; i < indices.size(); ++i) indices[i] = i%(vertices.size()/8);
+        const char* filename = "vbe-benchmark-cache.vbm";
+        MeshCache::write(filename, 1, getBenchmarkFormat(), AABB(vec3f(0.0f), vec3f(1.0f)),
+                         vertices.data(), vertices.size()/8, indices.data(), indices.size());
+        state.setItemsPerIteration(2*size*size);
+        while(state.keepRunning())
+            delete MeshCache::load(filename, 1, Mesh::STATIC);
+        std::remove(filename);
+    }
+}
+
+void registerOBJBenchmarks() {
+    // 512 is a 524k triangle, 44MB file
+    Benchmark::add("OBJLoader/legacy", benchLegacy, {64, 512});
+    Benchmark::add("OBJLoader/loadFromOBJStandard", benchStandard, {64, 512});
+    Benchmark::add("OBJLoader/loadFromOBJTangents", benchTangents, {64, 512});
+    Benchmark::add("OBJLoader/threads", benchThreads, {1, 2, 4, 8});
+    Benchmark::add("MeshCache::load", benchCache, {64, 512});
+}
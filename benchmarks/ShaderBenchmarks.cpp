@@ -0,0 +1,125 @@
+#include <VBE/graphics/Mesh.hpp>
+#include <VBE/graphics/ShaderProgram.hpp>
+#include <VBE/graphics/Texture2D.hpp>
+#include <VBE/graphics/Uniform.hpp>
+#include <VBE/graphics/ShaderBinding.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    // A program with the given uniform declarations, each of them read by the fragment shader
+    ShaderProgram makeProgram(const std::string& declarations, const std::string& expression) {
+        return ShaderProgram(
+            "#version 430 core\n"
+            "in vec3 a_position;\n"
+            "void main() {\n"
+            "    gl_Position = vec4(a_position, 1.0);\n"
+            "}\n",
+            "#version 430 core\n" +
+            declarations +
+            "out vec4 color;\n"
+            "void main() {\n"
+            "    color = vec4(" + expression + ");\n"
+            "}\n");
+    }
+
+    ShaderProgram makeFloatsProgram(unsigned int count) {
+        std::string declarations, expression = "0.0";
+        for(unsigned int i = 0; i < count; ++i) {
+            declarations += "uniform float u" + std::to_string(i) + ";\n";
+            expression += " + u" + std::to_string(i);
+        }
+        return makeProgram(declarations, expression);
+    }
+
+    void benchUse(Benchmark::State& state) {
+        ShaderProgram program = makeFloatsProgram(state.getArgument());
+        program.use();
+        while(state.keepRunning())
+            program.use();
+    }
+
+    void benchUseDirty(Benchmark::State& state) {
+        unsigned int count = state.getArgument();
+        ShaderProgram program = makeFloatsProgram(count);
+        std::vector<Uniform*> uniforms;
+        for(unsigned int i = 0; i < count; ++i)
+            uniforms.push_back(program.uniform("u" + std::to_string(i)));
+
+        state.setItemsPerIteration(count);
+        float value = 0.0f;
+        while(state.keepRunning()) {
+            value += 1.0f;
+            for(Uniform* u : uniforms) u->set(value);
+            program.use();
+        }
+    }
+
+    // Sets one uniform, alternating two values so every set has to reach GL
+    template<typename T>
+    void addUniformBenchmark(const std::string& glslType, const std::string& expression, T a, T b) {
+        Benchmark::add("Uniform::set/" + glslType, [glslType, expression, a, b](Benchmark::State& state) {
+            ShaderProgram program = makeProgram("uniform " + glslType + " u;\n", expression);
+            Uniform* u = program.uniform("u");
+            bool odd = false;
+            while(state.keepRunning()) {
+                odd = !odd;
+                u->set(odd ? a : b);
+                program.use();
+            }
+        });
+    }
+
+    void benchSetUnchanged(Benchmark::State& state) {
+        ShaderProgram program = makeProgram("uniform mat4 u;\n", "u[0]");
+        Uniform* u = program.uniform("u");
+        mat4f value(1.0f);
+        while(state.keepRunning()) {
+            u->set(value);
+            program.use();
+        }
+    }
+
+    void benchCreateBinding(Benchmark::State& state) {
+        std::vector<float> data = getBenchmarkVertices(3);
+        Mesh mesh(getBenchmarkFormat());
+        mesh.setVertexData(&data[0], 3);
+        ShaderProgram program = makeProgram("", "1.0");
+        while(state.keepRunning()) {
+            ShaderBinding binding(&program, &mesh);
+        }
+        ShaderBinding::bind(nullptr);
+    }
+}
+
+void registerShaderBenchmarks() {
+    Benchmark::add("ShaderProgram::use", benchUse, {1, 8, 32, 128});
+    Benchmark::add("ShaderProgram::use/dirty", benchUseDirty, {1, 8, 32, 128});
+
+    addUniformBenchmark<float>("float", "u", 0.0f, 1.0f);
+    addUniformBenchmark<vec2f>("vec2", "u, 0.0, 0.0", vec2f(0.0f), vec2f(1.0f));
+    addUniformBenchmark<vec3f>("vec3", "u, 0.0", vec3f(0.0f), vec3f(1.0f));
+    addUniformBenchmark<vec4f>("vec4", "u", vec4f(0.0f), vec4f(1.0f));
+    addUniformBenchmark<int>("int", "float(u)", 0, 1);
+    addUniformBenchmark<vec2i>("ivec2", "vec2(u), 0.0, 0.0", vec2i(0), vec2i(1));
+    addUniformBenchmark<vec3i>("ivec3", "vec3(u), 0.0", vec3i(0), vec3i(1));
+    addUniformBenchmark<vec4i>("ivec4", "vec4(u)", vec4i(0), vec4i(1));
+    addUniformBenchmark<bool>("bool", "float(u)", false, true);
+    addUniformBenchmark<mat3f>("mat3", "u[0], 0.0", mat3f(0.0f), mat3f(1.0f));
+    addUniformBenchmark<mat4f>("mat4", "u[0]", mat4f(0.0f), mat4f(1.0f));
+    Benchmark::add("Uniform::set/mat4/unchanged", benchSetUnchanged);
+    Benchmark::add("Uniform::set/sampler2D", [](Benchmark::State& state) {
+        Texture2D a(vec2ui(4)), b(vec2ui(4));
+        ShaderProgram program = makeProgram("uniform sampler2D u;\n", "texture(u, vec2(0.5))");
+        Uniform* u = program.uniform("u");
+        bool odd = false;
+        while(state.keepRunning()) {
+            odd = !odd;
+            u->set(odd ? a : b);
+            program.use();
+        }
+    });
+
+    Benchmark::add("ShaderBinding/create", benchCreateBinding);
+}
@@ -0,0 +1,89 @@
+#include <memory>
+
+#include <VBE/graphics/RenderTarget.hpp>
+#include <VBE/graphics/Texture2D.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    typedef std::vector<std::unique_ptr<Texture2D>> Textures;
+
+    Textures makeTextures(unsigned int count, unsigned int size) {
+        Textures textures;
+        for(unsigned int i = 0; i < count; ++i)
+            textures.emplace_back(new Texture2D(vec2ui(size)));
+        return textures;
+    }
+
+    // Every bind replaces the texture of the same slot
+    void benchBindChurn(Benchmark::State& state) {
+        Textures textures = makeTextures(state.getArgument(), 4);
+        state.setItemsPerIteration(textures.size());
+        while(state.keepRunning())
+            for(const std::unique_ptr<Texture2D>& t : textures)
+                Texture2D::bind(t.get(), 0);
+    }
+
+    // Every bind changes the active slot, the textures rotate between iterations
+    void benchBindSlots(Benchmark::State& state) {
+        unsigned int slots = state.getArgument();
+        Textures textures = makeTextures(slots + 1, 4);
+        state.setItemsPerIteration(slots);
+        unsigned int first = 0;
+        while(state.keepRunning()) {
+            for(unsigned int s = 0; s < slots; ++s)
+                Texture2D::bind(textures[(first + s)%textures.size()].get(), s);
+            first = (first + 1)%textures.size();
+        }
+    }
+
+    void benchBindRedundant(Benchmark::State& state) {
+        Texture2D texture(vec2ui(4));
+        while(state.keepRunning())
+            Texture2D::bind(&texture, 0);
+    }
+
+    struct Target {
+            Target(unsigned int size, RenderTargetBase::LoadAction load) : target(size, size), color(vec2ui(size)) {
+                target.setTexture(RenderTargetBase::COLOR0, &color);
+                target.setLoadAction(RenderTargetBase::COLOR0, load);
+            }
+            RenderTarget target;
+            Texture2D color;
+    };
+
+    void benchTargets(Benchmark::State& state, RenderTargetBase::LoadAction load, bool withDefault) {
+        std::vector<std::unique_ptr<Target>> targets;
+        for(unsigned int i = 0; i < state.getArgument(); ++i)
+            targets.emplace_back(new Target(64, load));
+        // Validate every framebuffer before measuring
+        for(const std::unique_ptr<Target>& t : targets) RenderTargetBase::bind(t->target);
+        RenderTargetBase::bind(nullptr);
+
+        state.setItemsPerIteration(targets.size()*(withDefault ? 2 : 1));
+        while(state.keepRunning()) {
+            for(const std::unique_ptr<Target>& t : targets) {
+                RenderTargetBase::bind(t->target);
+                if(withDefault) RenderTargetBase::bind(nullptr);
+            }
+        }
+        RenderTargetBase::bind(nullptr);
+    }
+}
+
+void registerStateBenchmarks() {
+    Benchmark::add("Texture::bind/churn", benchBindChurn, {2, 16});
+    Benchmark::add("Texture::bind/slots", benchBindSlots, {4, 16});
+    Benchmark::add("Texture::bind/redundant", benchBindRedundant);
+
+    Benchmark::add("RenderTarget::bind", [](Benchmark::State& state) {
+        benchTargets(state, RenderTargetBase::LOAD, false);
+    }, {2, 8});
+    Benchmark::add("RenderTarget::bind/withDefault", [](Benchmark::State& state) {
+        benchTargets(state, RenderTargetBase::LOAD, true);
+    }, {1, 8});
+    Benchmark::add("RenderTarget::bind/clear", [](Benchmark::State& state) {
+        benchTargets(state, RenderTargetBase::CLEAR, false);
+    }, {2, 8});
+}
@@ -0,0 +1,35 @@
+#include <VBE/graphics/Vertex.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    Vertex::Format makeFormat(unsigned int attributes, const std::string& lastName) {
+        std::vector<Vertex::Attribute> elements;
+        for(unsigned int i = 0; i + 1 < attributes; ++i)
+            elements.push_back(Vertex::Attribute("a_attribute" + std::to_string(i), Vertex::Attribute::Float, 4));
+        elements.push_back(Vertex::Attribute(lastName, Vertex::Attribute::Float, 4));
+        return Vertex::Format(elements);
+    }
+
+    // Formats are built separately so the comparison can't take any shortcut on identity
+    void benchEqual(Benchmark::State& state) {
+        Vertex::Format a = makeFormat(state.getArgument(), "a_last");
+        Vertex::Format b = makeFormat(state.getArgument(), "a_last");
+        while(state.keepRunning())
+            Benchmark::keep(a == b);
+    }
+
+    // The worst case for a mismatch, the formats only differ in the last attribute
+    void benchDifferent(Benchmark::State& state) {
+        Vertex::Format a = makeFormat(state.getArgument(), "a_last");
+        Vertex::Format b = makeFormat(state.getArgument(), "a_other");
+        while(state.keepRunning())
+            Benchmark::keep(a == b);
+    }
+}
+
+void registerVertexBenchmarks() {
+    Benchmark::add("Vertex::Format/equal", benchEqual, {1, 3, 8});
+    Benchmark::add("Vertex::Format/different", benchDifferent, {1, 3, 8});
+}
@@ -0,0 +1,36 @@
+QT       -= core gui
+
+TARGET = vbe-benchmarks
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+# Build VBE first, with the same CONFIG (headless or not), into ../VBE next to this build
+include(../VBE.pri)
+
+# The ShaderBinding benchmark needs the private headers
+INCLUDEPATH += ../src
+
+headless {
+    DEFINES += VBE_HEADLESS
+    LIBS += -lEGL
+}
+else {
+    LIBS += -lSDL2
+}
+LIBS += -lGLEW -lGL
+QMAKE_CXXFLAGS += -std=c++0x -fno-exceptions
+
+HEADERS += \
+    Benchmark.hpp \
+    Fixtures.hpp
+
+SOURCES += \
+    Benchmark.cpp \
+    main.cpp \
+    MeshBenchmarks.cpp \
+    MeshOptimizerBenchmarks.cpp \
+    OBJBenchmarks.cpp \
+    ShaderBenchmarks.cpp \
+    StateBenchmarks.cpp \
+    VertexBenchmarks.cpp
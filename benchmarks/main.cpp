@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <VBE/system/ContextSettings.hpp>
+#include <VBE/system/Window.hpp>
+
+#include "Benchmark.hpp"
+#include "Fixtures.hpp"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cout << "Usage: " << program << " [options]\n"
+                  << "  --filter=TEXT     only run the benchmarks whose name contains TEXT\n"
+                  << "  --samples=N       samples taken of every benchmark (10)\n"
+                  << "  --min-time=MS     minimum duration of a sample in milliseconds (20)\n"
+                  << "  --format=FORMAT   table, json or csv (table)\n"
+                  << "  --out=FILE        write the results to FILE instead of the standard output\n"
+                  << "  --list            print the benchmark names and exit\n";
+    }
+
+    bool readOption(const std::string& arg, const std::string& name, std::string& value) {
+        std::string prefix = "--" + name + "=";
+        if(arg.compare(0, prefix.size(), prefix) != 0) return false;
+        value = arg.substr(prefix.size());
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string format = "table", out, value;
+    bool list = false;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if(readOption(arg, "filter", value)) Benchmark::setFilter(value);
+        else if(readOption(arg, "samples", value)) Benchmark::setSamples(std::max(1, std::atoi(value.c_str())));
+        else if(readOption(arg, "min-time", value)) Benchmark::setMinSampleTime(std::max(0.001, std::atof(value.c_str())));
+        else if(readOption(arg, "format", value)) format = value;
+        else if(readOption(arg, "out", value)) out = value;
+        else if(arg == "--list") list = true;
+        else {
+            printUsage(argv[0]);
+            return (arg == "--help" ? 0 : 1);
+        }
+    }
+    if(format != "table" && format != "json" && format != "csv") {
+        std::cerr << "Unknown format " << format << std::endl;
+        return 1;
+    }
+
+    registerMeshBenchmarks();
+    registerMeshOptimizerBenchmarks();
+    registerOBJBenchmarks();
+    registerShaderBenchmarks();
+    registerStateBenchmarks();
+    registerVertexBenchmarks();
+
+    if(list) {
+        for(const std::string& name : Benchmark::getNames())
+            std::cout << name << "\n";
+        return 0;
+    }
+
+    // MeshBatched draws with glMultiDrawArraysIndirect, which needs 4.3
+    ContextSettings settings;
+    settings.versionMajor = 4;
+    settings.versionMinor = 3;
+    Window window(Window::DisplayMode::createWindowedMode(256, 256), settings);
+    window.setVsync(Window::DisabledVsync);
+
+    std::vector<Benchmark::Result> results = Benchmark::run(&std::cerr);
+
+    std::ofstream file;
+    if(!out.empty()) {
+        file.open(out.c_str());
+        if(!file) {
+            std::cerr << "Can't write " << out << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& stream = (out.empty() ? std::cout : file);
+    if(format == "json") Benchmark::writeJson(stream, results);
+    else if(format == "csv") Benchmark::writeCsv(stream, results);
+    else Benchmark::writeTable(stream, results);
+    return 0;
+}
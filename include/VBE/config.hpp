@@ -2,10 +2,19 @@
 #if defined(ANDROID)
 #define VBE_GLES2
 #define VBE_SYSTEM_ANDROID
+#elif defined(VBE_HEADLESS)
+// Renders offscreen through EGL, without a display server nor input devices
+#define VBE_SYSTEM_HEADLESS
 #else
 #define VBE_SYSTEM_SDL2
 #endif
 
+// Define VBE_PROFILER to record the CPU profiler zones, see Profiler
+//#define VBE_PROFILER
+
+// Define VBE_GL_STATS to count the GL calls issued every frame, see GLStats
+//#define VBE_GL_STATS
+
 #if defined(WINDOWS)
 #define VBE_SYSTEM_WINDOWS
 #else
@@ -5,14 +5,27 @@
 #include <VBE/graphics/Mesh.hpp>
 #include <VBE/graphics/MeshIndexed.hpp>
 #include <VBE/graphics/MeshBatched.hpp>
+#include <VBE/graphics/MeshCache.hpp>
+#include <VBE/graphics/MeshClusterizer.hpp>
+#include <VBE/graphics/MeshOptimizer.hpp>
+#include <VBE/graphics/MeshQuantizer.hpp>
+#include <VBE/graphics/MeshSimplifier.hpp>
 #include <VBE/graphics/OBJLoader.hpp>
 #include <VBE/graphics/RenderTarget.hpp>
 #include <VBE/graphics/RenderTargetLayered.hpp>
+#include <VBE/graphics/FrameGraph.hpp>
+#include <VBE/graphics/GpuProfiler.hpp>
+#include <VBE/graphics/GLStats.hpp>
 #include <VBE/graphics/Shader.hpp>
 #include <VBE/graphics/ShaderProgram.hpp>
+#include <VBE/graphics/Sampler.hpp>
 #include <VBE/graphics/Texture.hpp>
 #include <VBE/graphics/Texture2D.hpp>
+#include <VBE/graphics/TextureCache.hpp>
+#include <VBE/graphics/TextureHandleTable.hpp>
 #include <VBE/graphics/Texture2DArray.hpp>
+#include <VBE/graphics/Texture2DMultisample.hpp>
+#include <VBE/graphics/TextureAtlas.hpp>
 #include <VBE/graphics/Texture3D.hpp>
 #include <VBE/graphics/TextureCubemap.hpp>
 #include <VBE/graphics/TextureCubemapArray.hpp>
@@ -0,0 +1,226 @@
+#ifndef FRAMEGRAPH_HPP
+#define FRAMEGRAPH_HPP
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/RenderTarget.hpp>
+#include <VBE/graphics/Texture2D.hpp>
+#include <VBE/math.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+///
+/// \brief FrameGraph schedules render passes and their transient render targets
+///
+class FrameGraph : public NonCopyable {
+    public:
+        ///
+        /// \brief Identifies a texture inside the graph
+        ///
+        typedef unsigned int Resource;
+
+        ///
+        /// \brief Used by a pass during setup to declare what it reads and writes
+        ///
+        class Builder {
+            public:
+                ///
+                /// \brief Declares a new transient texture. Its memory comes from the graph pool.
+                ///
+                Resource create(vec2ui size, TextureFormat::Format format = TextureFormat::RGBA);
+
+                ///
+                /// \brief Declares that the pass samples from a texture
+                ///
+                void read(Resource r);
+
+                ///
+                /// \brief Declares that the pass renders to a texture through the given attachment
+                ///
+                void write(Resource r, RenderTargetBase::Attachment a);
+
+                ///
+                /// \brief Prevents the pass from being culled, for passes that render to the screen
+                /// or have other effects outside of the graph.
+                ///
+                /// Passes that write no attachments render to the screen.
+                ///
+                void setSideEffects();
+
+            private:
+                Builder(FrameGraph& graph, unsigned int pass) : graph(graph), pass(pass) {}
+
+                FrameGraph& graph;
+                unsigned int pass;
+
+                friend class FrameGraph;
+        };
+
+        ///
+        /// \brief Declares the inputs and outputs of a pass. Runs once, inside addPass().
+        ///
+        typedef std::function<void(Builder& builder)> Setup;
+
+        ///
+        /// \brief Renders the pass. The render target with its attachments is already bound.
+        ///
+        typedef std::function<void(const FrameGraph& graph)> Execute;
+
+        ///
+        /// \brief Default constructor
+        ///
+        FrameGraph();
+
+        ///
+        /// \brief Destructor. Frees all the pooled textures.
+        ///
+        ~FrameGraph();
+
+        ///
+        /// \brief Adds a pass to the graph. Passes execute in the order they are added.
+        ///
+        void addPass(const std::string& name, Setup setup, Execute execute);
+
+        ///
+        /// \brief Makes an external texture available to the passes.
+        ///
+        /// Imported textures are never culled nor pooled, and they must outlive the graph
+        /// (or clearPool() must be called once they are destroyed).
+        ///
+        Resource import(Texture2D* tex);
+
+        ///
+        /// \brief Culls unused passes and computes the lifetime of every transient texture
+        ///
+        /// Called by execute() if needed.
+        ///
+        void compile();
+
+        ///
+        /// \brief Runs all the passes that were not culled
+        ///
+        /// Transient textures are taken from the pool right before their first use and given back
+        /// right after their last one, so textures with non-overlapping lifetimes share memory.
+        /// Attachments whose contents are not needed after a pass are invalidated at its end.
+        ///
+        void execute();
+
+        ///
+        /// \brief Removes all passes and resources to record the next frame. The pool is kept.
+        ///
+        void reset();
+
+        ///
+        /// \brief Returns the texture behind a resource. Only valid while its passes execute.
+        ///
+        Texture2D* getTexture(Resource r) const;
+
+        ///
+        /// \brief Returns wether a pass was culled by the last compile()
+        ///
+        bool isCulled(const std::string& name) const;
+
+        ///
+        /// \brief Sets how many frames a pooled texture may stay unused before it is freed. Defaults to 1.
+        ///
+        void setMaxIdleFrames(unsigned int frames);
+
+        ///
+        /// \brief Frees all the pooled textures and their framebuffers
+        ///
+        void clearPool();
+
+        ///
+        /// \brief Returns the number of textures owned by the pool
+        ///
+        unsigned int getPoolSize() const;
+
+        ///
+        /// \brief Returns the estimated memory of the textures owned by the pool, in bytes
+        ///
+        unsigned long long getPoolMemory() const;
+
+    private:
+        struct ResourceNode {
+                vec2ui size = vec2ui(0);
+                TextureFormat::Format format = TextureFormat::RGBA;
+                Texture2D* texture = nullptr;
+                bool imported = false;
+                std::vector<unsigned int> producers;
+                unsigned int refCount = 0;
+                int firstUse = -1;
+                int lastUse = -1;
+        };
+
+        struct PassNode {
+                std::string name;
+                Execute execute;
+                std::vector<Resource> reads;
+                std::vector<std::pair<RenderTargetBase::Attachment, Resource>> writes;
+                bool sideEffects = false;
+                bool culled = false;
+                unsigned int refCount = 0;
+        };
+
+        struct PooledTexture {
+                Texture2D* texture = nullptr;
+                TextureFormat::Format format = TextureFormat::RGBA;
+                unsigned long long lastFrame = 0;
+                bool inUse = false;
+        };
+
+        typedef std::vector<std::pair<RenderTargetBase::Attachment, Texture2D*>> TargetKey;
+
+        Texture2D* acquire(vec2ui size, TextureFormat::Format format);
+        void release(Texture2D* tex);
+        RenderTarget* getTarget(const PassNode& pass);
+        void trimPool();
+
+        std::vector<PassNode> passes;
+        std::vector<ResourceNode> resources;
+        std::vector<PooledTexture> pool;
+        std::map<TargetKey, RenderTarget*> targets;
+        unsigned long long frame = 0;
+        unsigned int maxIdleFrames = 1;
+        bool compiled = false;
+};
+///
+/// \class FrameGraph FrameGraph.hpp <VBE/graphics/FrameGraph.hpp>
+/// \ingroup Graphics
+///
+/// Instead of every pass owning its own RenderTarget and textures, passes declare the
+/// textures they need and the graph provides them for as long as they are used. Passes
+/// whose results are never read are skipped. The graph is meant to be recorded every frame:
+/// ~~~{.cpp}
+/// FrameGraph::Resource hdr, bloom;
+/// graph.addPass("scene", [&](FrameGraph::Builder& b) {
+///     hdr = b.create(size, TextureFormat::RGBA16F);
+///     b.write(hdr, RenderTargetBase::COLOR0);
+///     b.write(b.create(size, TextureFormat::DEPTH_COMPONENT24), RenderTargetBase::DEPTH);
+/// }, [&](const FrameGraph& g) {
+///     drawScene();
+/// });
+/// graph.addPass("bloom", [&](FrameGraph::Builder& b) {
+///     b.read(hdr);
+///     bloom = b.create(size/2u, TextureFormat::RGBA16F);
+///     b.write(bloom, RenderTargetBase::COLOR0);
+/// }, [&](const FrameGraph& g) {
+///     bloomProgram.uniform("tex")->set(g.getTexture(hdr));
+///     quad.draw(bloomProgram);
+/// });
+/// graph.addPass("tonemap", [&](FrameGraph::Builder& b) {
+///     b.read(hdr);
+///     b.read(bloom);
+///     b.setSideEffects(); // renders to the screen
+/// }, [&](const FrameGraph& g) {
+///     ...
+/// });
+/// graph.execute();
+/// graph.reset();
+/// ~~~
+///
+
+#endif // FRAMEGRAPH_HPP
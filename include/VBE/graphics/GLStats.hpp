@@ -0,0 +1,237 @@
+#ifndef GLSTATS_HPP
+#define GLSTATS_HPP
+
+#include <VBE/config.hpp>
+
+// The statistics layer only exists when VBE_GL_STATS is defined. Otherwise the
+// GL entry points are called directly.
+#ifdef VBE_GL_STATS
+
+#include <iosfwd>
+#include <map>
+
+#include <VBE/graphics/OpenGL.hpp>
+
+///
+/// \brief GLStats counts the GL calls issued every frame and the ones that change nothing
+///
+class GLStats {
+    public:
+        ///
+        /// \brief The calls issued during one frame
+        ///
+        /// Redundant calls set a binding to the value it already had.
+        ///
+        struct FrameStats {
+                unsigned long long calls = 0; ///< Calls to any of the tracked entry points
+                unsigned long long drawCalls = 0; ///< Draw calls, every indirect draw counts as one
+                unsigned long long vertices = 0; ///< Vertices or indices submitted by direct draws, instances included
+                unsigned long long bufferUploads = 0; ///< glBufferData and glBufferSubData calls with data
+                unsigned long long bufferBytes = 0; ///< Bytes uploaded to buffers
+                unsigned long long textureUploads = 0; ///< glTexImage and glTexSubImage calls with data
+                unsigned long long textureBytes = 0; ///< Bytes uploaded to textures
+                unsigned long long uniformUploads = 0; ///< glUniform calls
+                unsigned long long programBinds = 0; ///< glUseProgram calls
+                unsigned long long redundantProgramBinds = 0;
+                unsigned long long textureBinds = 0; ///< glBindTexture calls
+                unsigned long long redundantTextureBinds = 0;
+                unsigned long long vertexArrayBinds = 0; ///< glBindVertexArray calls
+                unsigned long long redundantVertexArrayBinds = 0;
+                unsigned long long bufferBinds = 0; ///< glBindBuffer calls
+                unsigned long long redundantBufferBinds = 0;
+                unsigned long long framebufferBinds = 0; ///< glBindFramebuffer calls
+                unsigned long long redundantFramebufferBinds = 0;
+        };
+
+        ///
+        /// \brief Closes the current frame. Call once per frame, for example right after Window::swapBuffers().
+        ///
+        static void newFrame();
+
+        ///
+        /// \brief Returns the calls of the last closed frame
+        ///
+        static const FrameStats& getFrameStats();
+
+        ///
+        /// \brief Returns the calls of the frame being recorded
+        ///
+        static const FrameStats& getCurrentStats();
+
+        ///
+        /// \brief Writes the calls of the last closed frame, one counter per line
+        ///
+        static void writeFrameStats(std::ostream& out);
+
+        ///
+        /// \brief Forgets the tracked bindings
+        ///
+        /// Call after changing GL state through calls that don't include OpenGL.hpp,
+        /// so they are not wrongly reported as redundant.
+        ///
+        static void resetState();
+
+        // Wrappers for the tracked entry points, called through the macros below
+        static void drawArrays(GLenum mode, GLint first, GLsizei count);
+        static void drawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices);
+        static void bufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+        static void bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+        static void texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+        static void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels);
+        static void useProgram(GLuint program);
+        static void deleteProgram(GLuint program);
+        static void activeTexture(GLenum unit);
+        static void bindTexture(GLenum target, GLuint texture);
+        static void deleteTextures(GLsizei n, const GLuint* textures);
+        static void bindBuffer(GLenum target, GLuint buffer);
+        static void deleteBuffers(GLsizei n, const GLuint* buffers);
+        static void bindFramebuffer(GLenum target, GLuint framebuffer);
+        static void deleteFramebuffers(GLsizei n, const GLuint* framebuffers);
+        static void uniform1i(GLint location, GLint v);
+        static void uniform1f(GLint location, GLfloat v);
+        static void uniform1iv(GLint location, GLsizei count, const GLint* v);
+        static void uniform2iv(GLint location, GLsizei count, const GLint* v);
+        static void uniform3iv(GLint location, GLsizei count, const GLint* v);
+        static void uniform4iv(GLint location, GLsizei count, const GLint* v);
+        static void uniform1fv(GLint location, GLsizei count, const GLfloat* v);
+        static void uniform2fv(GLint location, GLsizei count, const GLfloat* v);
+        static void uniform3fv(GLint location, GLsizei count, const GLfloat* v);
+        static void uniform4fv(GLint location, GLsizei count, const GLfloat* v);
+        static void uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v);
+        static void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v);
+#ifndef VBE_GLES2
+        static void drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances);
+        static void drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instances);
+        static void drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint baseVertex);
+        static void drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instances, GLint baseVertex);
+        static void multiDrawArraysIndirect(GLenum mode, const GLvoid* indirect, GLsizei drawCount, GLsizei stride);
+        static void multiDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid* indirect, GLsizei drawCount, GLsizei stride);
+        static void texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const GLvoid* pixels);
+        static void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels);
+        static void bindVertexArray(GLuint array);
+        static void deleteVertexArrays(GLsizei n, const GLuint* arrays);
+        static void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+#endif
+
+    private:
+        GLStats();
+
+        static bool bind(std::map<GLenum, GLuint>& bindings, GLenum target, GLuint value);
+        static void unbind(std::map<GLenum, GLuint>& bindings, GLsizei n, const GLuint* names);
+        static void textureUpload(GLsizei texels, GLenum format, GLenum type, const GLvoid* pixels);
+
+        static FrameStats current;
+        static FrameStats last;
+        static bool programKnown;
+        static GLuint program;
+        static GLenum activeUnit;
+        static std::map<GLenum, std::map<GLenum, GLuint>> textures; // Per texture unit
+        static std::map<GLenum, GLuint> buffers;
+        static std::map<GLenum, GLuint> framebuffers;
+        static std::map<GLenum, GLuint> vertexArrays;
+};
+///
+/// \class GLStats GLStats.hpp <VBE/graphics/GLStats.hpp>
+/// \ingroup Graphics
+///
+/// Define VBE_GL_STATS when building both VBE and the application to enable it. The
+/// tracked GL entry points are then replaced by macros that count the call and forward
+/// it, so every file that includes OpenGL.hpp is measured, VBE's own code included.
+///
+/// ~~~{.cpp}
+/// render();
+/// window.swapBuffers();
+/// GLStats::newFrame();
+/// const GLStats::FrameStats& s = GLStats::getFrameStats();
+/// Log::message() << s.drawCalls << " draws, " << s.redundantTextureBinds << " redundant texture binds" << Log::Flush;
+/// ~~~
+///
+/// A call is redundant when it binds the value the tracked binding already has. Bindings
+/// are only known after being set through a tracked call, and deleting an object forgets
+/// the bindings it had.
+///
+
+#ifndef VBE_GL_STATS_IMPL
+#undef glDrawArrays
+#define glDrawArrays(mode, first, count) GLStats::drawArrays(mode, first, count)
+#undef glDrawElements
+#define glDrawElements(mode, count, type, indices) GLStats::drawElements(mode, count, type, indices)
+#undef glBufferData
+#define glBufferData(target, size, data, usage) GLStats::bufferData(target, size, data, usage)
+#undef glBufferSubData
+#define glBufferSubData(target, offset, size, data) GLStats::bufferSubData(target, offset, size, data)
+#undef glTexImage2D
+#define glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels) GLStats::texImage2D(target, level, internalFormat, width, height, border, format, type, pixels)
+#undef glTexSubImage2D
+#define glTexSubImage2D(target, level, x, y, width, height, format, type, pixels) GLStats::texSubImage2D(target, level, x, y, width, height, format, type, pixels)
+#undef glUseProgram
+#define glUseProgram(program) GLStats::useProgram(program)
+#undef glDeleteProgram
+#define glDeleteProgram(program) GLStats::deleteProgram(program)
+#undef glActiveTexture
+#define glActiveTexture(unit) GLStats::activeTexture(unit)
+#undef glBindTexture
+#define glBindTexture(target, texture) GLStats::bindTexture(target, texture)
+#undef glDeleteTextures
+#define glDeleteTextures(n, textures) GLStats::deleteTextures(n, textures)
+#undef glBindBuffer
+#define glBindBuffer(target, buffer) GLStats::bindBuffer(target, buffer)
+#undef glDeleteBuffers
+#define glDeleteBuffers(n, buffers) GLStats::deleteBuffers(n, buffers)
+#undef glBindFramebuffer
+#define glBindFramebuffer(target, framebuffer) GLStats::bindFramebuffer(target, framebuffer)
+#undef glDeleteFramebuffers
+#define glDeleteFramebuffers(n, framebuffers) GLStats::deleteFramebuffers(n, framebuffers)
+#undef glUniform1i
+#define glUniform1i(location, v) GLStats::uniform1i(location, v)
+#undef glUniform1f
+#define glUniform1f(location, v) GLStats::uniform1f(location, v)
+#undef glUniform1iv
+#define glUniform1iv(location, count, v) GLStats::uniform1iv(location, count, v)
+#undef glUniform2iv
+#define glUniform2iv(location, count, v) GLStats::uniform2iv(location, count, v)
+#undef glUniform3iv
+#define glUniform3iv(location, count, v) GLStats::uniform3iv(location, count, v)
+#undef glUniform4iv
+#define glUniform4iv(location, count, v) GLStats::uniform4iv(location, count, v)
+#undef glUniform1fv
+#define glUniform1fv(location, count, v) GLStats::uniform1fv(location, count, v)
+#undef glUniform2fv
+#define glUniform2fv(location, count, v) GLStats::uniform2fv(location, count, v)
+#undef glUniform3fv
+#define glUniform3fv(location, count, v) GLStats::uniform3fv(location, count, v)
+#undef glUniform4fv
+#define glUniform4fv(location, count, v) GLStats::uniform4fv(location, count, v)
+#undef glUniformMatrix3fv
+#define glUniformMatrix3fv(location, count, transpose, v) GLStats::uniformMatrix3fv(location, count, transpose, v)
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv(location, count, transpose, v) GLStats::uniformMatrix4fv(location, count, transpose, v)
+#ifndef VBE_GLES2
+#undef glDrawArraysInstanced
+#define glDrawArraysInstanced(mode, first, count, instances) GLStats::drawArraysInstanced(mode, first, count, instances)
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced(mode, count, type, indices, instances) GLStats::drawElementsInstanced(mode, count, type, indices, instances)
+#undef glDrawElementsBaseVertex
+#define glDrawElementsBaseVertex(mode, count, type, indices, baseVertex) GLStats::drawElementsBaseVertex(mode, count, type, indices, baseVertex)
+#undef glDrawElementsInstancedBaseVertex
+#define glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex) GLStats::drawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex)
+#undef glMultiDrawArraysIndirect
+#define glMultiDrawArraysIndirect(mode, indirect, drawCount, stride) GLStats::multiDrawArraysIndirect(mode, indirect, drawCount, stride)
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride) GLStats::multiDrawElementsIndirect(mode, type, indirect, drawCount, stride)
+#undef glTexImage3D
+#define glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels) GLStats::texImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels)
+#undef glTexSubImage3D
+#define glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels) GLStats::texSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels)
+#undef glBindVertexArray
+#define glBindVertexArray(array) GLStats::bindVertexArray(array)
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays(n, arrays) GLStats::deleteVertexArrays(n, arrays)
+#undef glBindBufferBase
+#define glBindBufferBase(target, index, buffer) GLStats::bindBufferBase(target, index, buffer)
+#endif // VBE_GLES2
+#endif // VBE_GL_STATS_IMPL
+
+#endif // VBE_GL_STATS
+
+#endif // GLSTATS_HPP
@@ -0,0 +1,209 @@
+#ifndef GPUPROFILER_HPP
+#define GPUPROFILER_HPP
+
+#include <deque>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+// Timer queries are not supported in GLES2
+#ifndef VBE_GLES2
+
+///
+/// \brief GpuProfiler measures how long the GPU spends on named scopes of GL commands
+///
+class GpuProfiler {
+    public:
+        ///
+        /// \brief Aggregated timings of every scope with the same name, in milliseconds
+        ///
+        struct Stats {
+                std::string name; ///< Name of the scope
+                unsigned int depth = 0; ///< Nesting depth the last time it was measured
+                unsigned long long count = 0; ///< Number of measurements
+                double last = 0.0; ///< Last measured time
+                double min = 0.0; ///< Shortest measured time
+                double avg = 0.0; ///< Average measured time
+                double max = 0.0; ///< Longest measured time
+        };
+
+        ///
+        /// \brief One measured scope, with its start and end on the CPU clock in microseconds
+        ///
+        /// The GPU timestamps are translated to the clock used by Clock::getMicroseconds() so
+        /// they can be shown in the same timeline as CPU zones.
+        ///
+        struct Event {
+                std::string name; ///< Name of the scope
+                unsigned int depth = 0; ///< Nesting depth
+                unsigned long long frame = 0; ///< Frame the scope was recorded in
+                long long begin = 0; ///< Start time, in microseconds
+                long long end = 0; ///< End time, in microseconds
+        };
+
+        ///
+        /// \brief Measures the GPU time of the commands issued during its lifetime
+        ///
+        class Scope : public NonCopyable {
+            public:
+                Scope(const char* name) : active(enabled) {if(active) GpuProfiler::begin(name);}
+                Scope(const std::string& name) : active(enabled) {if(active) GpuProfiler::begin(name);}
+                ~Scope() {if(active) GpuProfiler::end();}
+
+            private:
+                const bool active;
+        };
+
+        ///
+        /// \brief Returns wether the context supports timer queries
+        ///
+        static bool isSupported();
+
+        ///
+        /// \brief Enables or disables the profiler. It is disabled by default.
+        ///
+        /// While disabled begin() and end() do nothing. Disabling it discards the
+        /// measurements still in flight.
+        ///
+        static void setEnabled(bool enabled);
+
+        ///
+        /// \brief Returns wether the profiler is enabled
+        ///
+        static bool isEnabled();
+
+        ///
+        /// \brief Starts a named scope. Scopes can be nested.
+        ///
+        static void begin(const std::string& name);
+
+        ///
+        /// \brief Ends the innermost open scope
+        ///
+        static void end();
+
+        ///
+        /// \brief Closes the current frame and collects the results that became available
+        ///
+        /// Call once per frame, after all scopes are closed (for example right after
+        /// Window::swapBuffers()). Results are never waited for unless more than
+        /// getMaxLatency() frames are still in flight.
+        ///
+        static void newFrame();
+
+        ///
+        /// \brief Sets how many frames can be in flight before newFrame() waits for results. Defaults to 4.
+        ///
+        static void setMaxLatency(unsigned int frames);
+
+        ///
+        /// \brief Returns how many frames can be in flight before newFrame() waits for results
+        ///
+        static unsigned int getMaxLatency();
+
+        ///
+        /// \brief Sets how many of the last measured events getEvents() keeps. Defaults to 1024.
+        ///
+        static void setMaxEvents(unsigned int events);
+
+        ///
+        /// \brief Returns the aggregated timings of every scope, sorted by name
+        ///
+        static std::vector<Stats> getStats();
+
+        ///
+        /// \brief Returns the timings of a single scope. It must have been measured at least once.
+        ///
+        static const Stats& getStats(const std::string& name);
+
+        ///
+        /// \brief Returns the last measured events, oldest first
+        ///
+        static const std::deque<Event>& getEvents();
+
+        ///
+        /// \brief Writes the aggregated timings as a table, one scope per line
+        ///
+        static void writeStats(std::ostream& out);
+
+        ///
+        /// \brief Clears the aggregated timings and the event history
+        ///
+        static void reset();
+
+        ///
+        /// \brief Deletes all the query objects. Call before destroying the context.
+        ///
+        static void clear();
+
+    private:
+        GpuProfiler();
+
+        struct Measure {
+                unsigned int name = 0;
+                unsigned int depth = 0;
+                GLuint begin = 0;
+                GLuint end = 0;
+        };
+
+        struct Frame {
+                unsigned long long index = 0;
+                GLuint last = 0; // The last query issued, results arrive in order
+                std::vector<Measure> measures;
+        };
+
+        static GLuint acquireQuery();
+        static void collect(Frame& frame);
+        static void discard(Frame& frame);
+        static void calibrate();
+
+        static bool enabled;
+        static unsigned int maxLatency;
+        static unsigned int maxEvents;
+        static unsigned long long frameIndex;
+        static long long clockOffset;
+        static std::vector<GLuint> freeQueries;
+        static std::vector<unsigned int> open;
+        static Frame recording;
+        static std::deque<Frame> inFlight;
+        static std::vector<Stats> stats;
+        static std::map<std::string, unsigned int> statsIndex;
+        static std::deque<Event> events;
+};
+///
+/// \class GpuProfiler GpuProfiler.hpp <VBE/graphics/GpuProfiler.hpp>
+/// \ingroup Graphics
+///
+/// Every scope is bracketed by two GL_TIMESTAMP queries, which unlike GL_TIME_ELAPSED
+/// allows nesting. Queries are taken from a pool that is recycled once their results have
+/// been read, which happens a few frames later so the CPU never waits for the GPU to catch up.
+///
+/// ~~~{.cpp}
+/// GpuProfiler::setEnabled(true);
+/// while(running) {
+///     {
+///         GpuProfiler::Scope scope("shadows");
+///         drawShadows();
+///     }
+///     {
+///         GpuProfiler::Scope scope("scene");
+///         drawScene();
+///     }
+///     window.swapBuffers();
+///     GpuProfiler::newFrame();
+/// }
+/// GpuProfiler::writeStats(std::cout);
+/// ~~~
+///
+/// FrameGraph passes and MeshBatched::endBatch() open their own scopes, so they show up
+/// without any extra code while the profiler is enabled.
+///
+
+#endif // VBE_GLES2
+
+#endif // GPUPROFILER_HPP
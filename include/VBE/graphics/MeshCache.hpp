@@ -0,0 +1,97 @@
+#ifndef MESHCACHE_HPP
+#define MESHCACHE_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <VBE/geometry/AABB.hpp>
+#include <VBE/graphics/Mesh.hpp>
+#include <VBE/graphics/MeshIndexed.hpp>
+#include <VBE/graphics/Vertex.hpp>
+
+///
+/// \brief MeshCache reads and writes meshes in a binary format that is uploaded without parsing
+///
+class MeshCache {
+    public:
+        ///
+        /// \brief Hashes the contents of a source file, to tell whether a cache is stale
+        ///
+        /// \param data The bytes to hash
+        /// \param size The number of bytes
+        /// \param seed Mixed into the result. Useful to tell apart caches built from the same source with different settings.
+        ///
+        static unsigned long long hash(const void* data, std::size_t size, unsigned long long seed = 0);
+
+        ///
+        /// \brief Writes a mesh cache file
+        ///
+        /// The file is written under a temporary name unique to this call and then
+        /// renamed over the old one, so other processes never see it half written.
+        ///
+        /// \param filename The file to write, outside of the asset path
+        /// \param sourceHash Hash of the data the mesh was built from, see hash()
+        /// \param format The format of the vertices
+        /// \param box The bounding box of the mesh
+        /// \param vertexData The vertices, packed as described by format
+        /// \param vertexCount The number of vertices
+        /// \param indexData The indices, or nullptr for meshes without indices
+        /// \param indexCount The number of indices
+        /// \param indexFormat The type of the indices
+        /// \param primitiveType The primitive type of the mesh
+        /// \param primitiveRestart Whether the indices use primitive restart, see MeshIndexed::setPrimitiveRestart()
+        /// \param subMeshes The sub-meshes of the indices, see MeshIndexed::setSubMeshes()
+        /// \return Whether the file could be written
+        ///
+        static bool write(const std::string& filename, unsigned long long sourceHash, const Vertex::Format& format, const AABB& box,
+                          const void* vertexData, unsigned int vertexCount,
+                          const void* indexData = nullptr, unsigned int indexCount = 0,
+                          MeshIndexed::IndexFormat indexFormat = MeshIndexed::UNSIGNED_INT,
+                          Mesh::PrimitiveType primitiveType = Mesh::TRIANGLES, bool primitiveRestart = false,
+                          const std::vector<MeshIndexed::SubMesh>& subMeshes = std::vector<MeshIndexed::SubMesh>());
+
+        ///
+        /// \brief Loads a mesh cache file
+        ///
+        /// The file is memory mapped and its vertex and index blobs are handed
+        /// to the mesh straight from the mapping, without copying them. Indices are
+        /// only read to check that every one of them names a vertex.
+        ///
+        /// \param filename The file to read, outside of the asset path
+        /// \param sourceHash Hash of the data the mesh is expected to be built from
+        /// \param bufferType The buffer type of the new mesh
+        /// \param box If not nullptr, receives the bounding box of the mesh
+        /// \return A Mesh or a MeshIndexed, or nullptr if the file is missing, broken, stale, or
+        ///         uses primitive restart where MeshIndexed::isPrimitiveRestartSupported() is false
+        ///
+        static MeshSeparate* load(const std::string& filename, unsigned long long sourceHash, Mesh::BufferType bufferType, AABB* box = nullptr);
+
+    private:
+        MeshCache();
+};
+///
+/// \class MeshCache MeshCache.hpp <VBE/graphics/MeshCache.hpp>
+/// \ingroup Graphics
+///
+/// A cache file holds a header with the Vertex::Format and the AABB of the mesh, followed
+/// by the raw vertex and index data and the sub-meshes, each aligned to 64 bytes. Files are
+/// written in the native byte order, so they are meant to be rebuilt on every machine rather
+/// than shipped.
+///
+/// OBJLoader uses it when given a cache path, keyed on the hash of the OBJ contents.
+/// It can also cache meshes built by hand:
+/// ~~~{.cpp}
+/// std::string source = Storage::readToString(Storage::openAsset("terrain.heights"));
+/// unsigned long long key = MeshCache::hash(source.data(), source.size());
+/// MeshSeparate* mesh = MeshCache::load("cache/terrain.vbm", key, Mesh::STATIC);
+/// if(mesh == nullptr) {
+///     std::vector<TerrainVertex> vertices = buildTerrain(source);
+///     MeshCache::write("cache/terrain.vbm", key, format, box, vertices.data(), vertices.size());
+///     mesh = new Mesh(format);
+///     mesh->setVertexData(vertices.data(), vertices.size());
+/// }
+/// ~~~
+///
+
+#endif // MESHCACHE_HPP
@@ -0,0 +1,130 @@
+#ifndef MESHCLUSTERIZER_HPP
+#define MESHCLUSTERIZER_HPP
+
+#include <vector>
+
+#include <VBE/geometry/Frustum.hpp>
+#include <VBE/geometry/Sphere.hpp>
+#include <VBE/math.hpp>
+
+///
+/// \brief MeshClusterizer splits triangle lists in small clusters that can be culled one by one
+///
+class MeshClusterizer {
+    public:
+        ///
+        /// \brief A range of the index buffer, or of the vertices once unindexed
+        ///
+        struct Range {
+                unsigned int offset = 0; ///< First index
+                unsigned int count = 0; ///< Number of indices
+        };
+
+        ///
+        /// \brief A cluster of nearby triangles and what is needed to cull it
+        ///
+        /// Every triangle faces away from a camera inside the cone that starts at coneApex,
+        /// points along -coneAxis and opens by 90 degrees minus the half angle of the normal cone.
+        ///
+        struct Cluster : public Range {
+                Sphere bounds; ///< Holds every vertex of the cluster
+                vec3f coneApex = vec3f(0.0f); ///< Apex of the normal cone
+                vec3f coneAxis = vec3f(0.0f); ///< Average direction the triangles face
+                float coneCutoff = 1.0f; ///< Sine of the half angle of the normal cone. 1 when the triangles face too many ways to cull.
+        };
+
+        ///
+        /// \brief Reorders a triangle list so it is made of clusters of nearby triangles
+        ///
+        /// Clusters grow from a triangle through the ones sharing its vertices, taking first
+        /// those that add the fewest vertices and then the closest ones, so they come out round
+        /// and flat. Triangles keep their relative order inside a cluster, so run
+        /// MeshOptimizer::optimizeVertexCache() before, not after.
+        ///
+        /// \param indices The triangle list, reordered cluster after cluster
+        /// \param vertexData The vertices the indices refer to
+        /// \param vertexCount The number of vertices
+        /// \param vertexSize The size of a vertex, in bytes
+        /// \param positionOffset Offset of the position within a vertex. Positions must be three floats.
+        /// \param maxTriangles The most triangles a cluster may have
+        /// \return The clusters, in the order they appear in indices
+        ///
+        static std::vector<Cluster> build(std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexCount,
+                                          unsigned int vertexSize, unsigned int positionOffset = 0, unsigned int maxTriangles = 128);
+
+        ///
+        /// \brief Copies the vertex of every index, one after the other
+        ///
+        /// The result is drawn without indices, as a Mesh or a MeshBatched, and the ranges of
+        /// the clusters still apply to it.
+        ///
+        /// \param indices The triangle list
+        /// \param vertexData The vertices the indices refer to
+        /// \param vertexSize The size of a vertex, in bytes
+        /// \param result Receives indices.size() vertices
+        ///
+        static void unindex(const std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexSize, std::vector<char>& result);
+
+        ///
+        /// \brief Tells whether every triangle of a cluster faces away from the camera
+        ///
+        /// \param cluster The cluster to test
+        /// \param cameraPosition The position of the camera, in the space of the mesh
+        ///
+        static bool isBackfacing(const Cluster& cluster, const vec3f& cameraPosition);
+
+        ///
+        /// \brief Tells whether a cluster may be seen: it is inside the frustum and not backfacing
+        ///
+        /// \param cluster The cluster to test
+        /// \param frustum The frustum of projection*view*model, so its planes are in the space of the mesh
+        /// \param cameraPosition The position of the camera, in the space of the mesh
+        ///
+        static bool isVisible(const Cluster& cluster, const Frustum& frustum, const vec3f& cameraPosition);
+
+        ///
+        /// \brief Finds the ranges of the clusters that may be seen, merging the ones that follow each other
+        ///
+        /// \param clusters The clusters, as returned by build()
+        /// \param frustum The frustum of projection*view*model, so its planes are in the space of the mesh
+        /// \param cameraPosition The position of the camera, in the space of the mesh
+        /// \param ranges Receives the ranges to draw
+        ///
+        static void cull(const std::vector<Cluster>& clusters, const Frustum& frustum, const vec3f& cameraPosition, std::vector<Range>& ranges);
+
+    private:
+        MeshClusterizer();
+};
+///
+/// \class MeshClusterizer MeshClusterizer.hpp <VBE/graphics/MeshClusterizer.hpp>
+/// \ingroup Graphics
+///
+/// Culling whole meshes keeps everything of a large scanned mesh as soon as a corner of it
+/// is in view, and it never drops the half that faces away. Splitting it in clusters of about
+/// a hundred triangles lets the CPU skip those parts before they are submitted:
+/// ~~~{.cpp}
+/// std::vector<MeshClusterizer::Cluster> clusters = MeshClusterizer::build(indices, vertices.data(), vertexCount, vertexSize);
+/// std::vector<char> soup;
+/// MeshClusterizer::unindex(indices, vertices.data(), vertexSize, soup);
+/// MeshBatched mesh(format);
+/// mesh.setVertexData(soup.data(), indices.size());
+/// ...
+/// Frustum frustum;
+/// frustum.calculate(projection*view*model);
+/// vec3f camera = vec3f(glm::inverse(view*model)*vec4f(0.0f, 0.0f, 0.0f, 1.0f));
+/// std::vector<MeshClusterizer::Range> ranges;
+/// MeshClusterizer::cull(clusters, frustum, camera, ranges);
+/// MeshBatched::startBatch();
+/// for(const MeshClusterizer::Range& r : ranges) mesh.drawBatched(program, r.offset, r.count);
+/// MeshBatched::endBatch();
+/// ~~~
+/// The same ranges can be drawn from a MeshIndexed holding the reordered indices instead.
+/// Models with a non uniform scale need their bounds and cones transformed, the object space
+/// tests above assume distances and angles are kept.
+///
+/// Backface culling with the cones only drops clusters whose triangles all face away, which
+/// works best on dense, smooth meshes. Flat clusters get the narrowest cones and are dropped
+/// from half of the directions around them.
+///
+
+#endif // MESHCLUSTERIZER_HPP
@@ -1,6 +1,8 @@
 #ifndef MESHINDEXED_HPP
 #define MESHINDEXED_HPP
 
+#include <vector>
+
 #include <VBE/graphics/MeshSeparate.hpp>
 
 class MeshIndexed final : public MeshSeparate {
@@ -10,6 +12,18 @@ class MeshIndexed final : public MeshSeparate {
             UNSIGNED_INT = GL_UNSIGNED_INT
         };
 
+        // A range of indices drawn with its own base vertex, so that meshes with more
+        // than 65536 vertices can still use UNSIGNED_SHORT indices
+        struct SubMesh {
+                unsigned int offset; // first index
+                unsigned int count; // number of indices
+                unsigned int baseVertex; // added to every index of the range
+        };
+
+        // The index that restarts strips when primitive restart is enabled,
+        // before it is narrowed to the index format
+        static const unsigned int restartIndex = 0xFFFFFFFF;
+
         MeshIndexed();
         MeshIndexed(const Vertex::Format& format, BufferType bufferType = STATIC, IndexFormat indexFormat = UNSIGNED_INT);
         ~MeshIndexed() override;
@@ -25,14 +39,43 @@ class MeshIndexed final : public MeshSeparate {
 
         GLuint getIndexBuffer() const;
         unsigned int getIndexCount() const;
+        IndexFormat getIndexFormat() const;
+
+        // Indices in the index format of the mesh
         void setIndexData(const void* indexData, unsigned int newIndexCount);
+        // Picks UNSIGNED_SHORT whenever the indices fit, and keeps that format for later calls
+        void setIndexData(const std::vector<unsigned int>& indices);
+
+#ifndef VBE_GLES2
+        // Empty (the default) draws all indices with a base vertex of 0
+        const std::vector<SubMesh>& getSubMeshes() const;
+        void setSubMeshes(const std::vector<SubMesh>& newSubMeshes);
+
+        // Restarts strips and fans at the largest value of the index format. Off by default.
+        // Can only be enabled when isPrimitiveRestartSupported().
+        bool getPrimitiveRestart() const;
+        void setPrimitiveRestart(bool enabled);
+#endif
+
+        // Whether fixed index primitive restart is available: GL 4.3 or ARB_ES3_compatibility.
+        // Always false on GLES2.
+        static bool isPrimitiveRestartSupported();
+
+        // Narrows indices to 16 bits, mapping restartIndex to 0xFFFF.
+        // Returns false, leaving result empty, if some index does not fit.
+        static bool compactIndices(const std::vector<unsigned int>& indices, std::vector<GLushort>& result);
 
         friend void swap(MeshIndexed& a, MeshIndexed& b);
 
     private:
+        void drawElements(unsigned int offset, unsigned int length, bool instanced, unsigned int instanceCount) const;
+        unsigned int getIndexSize() const;
+
         unsigned int indexCount = 0;
         GLuint indexBuffer = 0;
         IndexFormat indexFormat = UNSIGNED_INT;
+        std::vector<SubMesh> subMeshes;
+        bool primitiveRestart = false;
 };
 
 
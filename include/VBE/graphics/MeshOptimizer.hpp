@@ -0,0 +1,130 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/MeshIndexed.hpp>
+
+///
+/// \brief MeshOptimizer reorders indexed triangle lists to render faster
+///
+class MeshOptimizer {
+    public:
+        ///
+        /// \brief Post-transform vertex cache efficiency of an index list
+        ///
+        struct Statistics {
+                unsigned int transformed = 0; ///< Vertices transformed, i.e. cache misses
+                float acmr = 0.0f; ///< Average cache miss ratio: transformed vertices per triangle. 0.5 is ideal, 3 is the worst.
+                float atvr = 0.0f; ///< Average transform to vertex ratio: transformed vertices per vertex. 1 is ideal.
+        };
+
+        ///
+        /// \brief Simulates a FIFO post-transform cache over a triangle list
+        ///
+        /// \param indices The triangle list
+        /// \param vertexCount The number of vertices the indices refer to
+        /// \param cacheSize The number of vertices the simulated cache holds
+        ///
+        static Statistics analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+        ///
+        /// \brief Reorders triangles so that vertices are reused while they are still in the post-transform cache
+        ///
+        /// Uses Tipsify, which runs in linear time and does not depend much on the exact cache size.
+        ///
+        /// \param indices The triangle list to reorder
+        /// \param vertexCount The number of vertices the indices refer to
+        /// \param cacheSize The number of vertices the target cache holds
+        ///
+        static void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+        ///
+        /// \brief Reorders clusters of triangles so the outer ones are drawn first, to reduce overdraw
+        ///
+        /// The triangles are split in clusters wherever the vertex cache gets flushed anyway, and
+        /// wherever it costs little. Clusters facing away from the center of the mesh are drawn first,
+        /// so early depth testing rejects more of the ones behind them. Call it after optimizeVertexCache().
+        ///
+        /// \param indices The triangle list to reorder
+        /// \param vertexData The vertices the indices refer to
+        /// \param vertexCount The number of vertices
+        /// \param vertexSize The size of a vertex, in bytes
+        /// \param positionOffset Offset of the position within a vertex. Positions must be three floats.
+        /// \param threshold How much worse the cache efficiency is allowed to get, 1.05 allows a 5% loss
+        /// \param cacheSize The number of vertices the target cache holds
+        ///
+        static void optimizeOverdraw(std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexCount, unsigned int vertexSize,
+                                     unsigned int positionOffset = 0, float threshold = 1.05f, unsigned int cacheSize = 16);
+
+        ///
+        /// \brief Reorders vertices in the order they are first used, so they are fetched linearly
+        ///
+        /// Vertices that are not referenced are dropped.
+        ///
+        /// \param vertexData The vertices, reordered in place
+        /// \param vertexCount The number of vertices
+        /// \param vertexSize The size of a vertex, in bytes
+        /// \param indices The triangle list, remapped to the new vertex order
+        /// \return The number of vertices kept, at the start of vertexData
+        ///
+        static unsigned int optimizeVertexFetch(void* vertexData, unsigned int vertexCount, unsigned int vertexSize, std::vector<unsigned int>& indices);
+
+        ///
+        /// \brief Runs optimizeVertexCache(), optimizeOverdraw() and optimizeVertexFetch(), in that order
+        ///
+        /// \return The number of vertices kept, at the start of vertexData
+        ///
+        static unsigned int optimize(void* vertexData, unsigned int vertexCount, unsigned int vertexSize, std::vector<unsigned int>& indices,
+                                     unsigned int positionOffset = 0);
+
+        ///
+        /// \brief Splits a triangle list in sub-meshes that use at most maxVertices vertices each
+        ///
+        /// Triangles keep their order, a sub-mesh ends where the next triangle would go over the
+        /// limit. Vertices shared by several sub-meshes are duplicated, so the split pays off when
+        /// the 16 bit indices it allows save more than the duplicated vertices take.
+        ///
+        /// \param indices The triangle list, rewritten relative to the base vertex of every sub-mesh
+        /// \param vertexCount The number of vertices the indices refer to
+        /// \param vertexRemap Receives, for every vertex of the split mesh, the vertex it is a copy of
+        /// \param maxVertices The most vertices a sub-mesh may use. 65535 leaves 0xFFFF for primitive restart.
+        /// \return The sub-meshes, to be passed to MeshIndexed::setSubMeshes()
+        ///
+        static std::vector<MeshIndexed::SubMesh> splitIndices(std::vector<unsigned int>& indices, unsigned int vertexCount,
+                                                              std::vector<unsigned int>& vertexRemap, unsigned int maxVertices = 65535);
+
+        ///
+        /// \brief Turns a triangle list into triangle strips separated by MeshIndexed::restartIndex
+        ///
+        /// Strips start at the first triangle left in list order and grow through neighbours
+        /// with the right winding, so they mostly keep the vertex cache order of the list.
+        /// The result is drawn as a TRIANGLE_STRIP with MeshIndexed::setPrimitiveRestart().
+        /// Isolated triangles take four indices instead of three, so check the result is shorter.
+        ///
+        /// \param indices The triangle list, replaced by the strips
+        /// \param vertexCount The number of vertices the indices refer to
+        ///
+        static void stripify(std::vector<unsigned int>& indices, unsigned int vertexCount);
+
+    private:
+        MeshOptimizer();
+};
+///
+/// \class MeshOptimizer MeshOptimizer.hpp <VBE/graphics/MeshOptimizer.hpp>
+/// \ingroup Graphics
+///
+/// Meshes usually come in whatever order the modelling tool wrote them, which makes the GPU
+/// transform shared vertices several times and shade pixels that end up hidden. MeshOptimizer
+/// works on the CPU copy of the data before it is uploaded, so it can run at load time (see
+/// OBJLoader::setOptimize) or offline, writing the result with MeshCache:
+/// ~~~{.cpp}
+/// MeshOptimizer::Statistics before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+/// vertices.resize(MeshOptimizer::optimize(vertices.data(), vertices.size(), sizeof(Vert), indices));
+/// MeshOptimizer::Statistics after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+/// Log::message() << "ACMR " << before.acmr << " -> " << after.acmr << Log::Flush;
+/// ~~~
+///
+
+#endif // MESHOPTIMIZER_HPP
@@ -0,0 +1,122 @@
+#ifndef MESHQUANTIZER_HPP
+#define MESHQUANTIZER_HPP
+
+#include <string>
+#include <vector>
+
+#include <VBE/geometry/AABB.hpp>
+#include <VBE/graphics/Vertex.hpp>
+#include <VBE/math.hpp>
+
+///
+/// \brief MeshQuantizer packs float vertex attributes into smaller normalized types
+///
+class MeshQuantizer {
+    public:
+        ///
+        /// \brief Which attributes to quantize, by name. Empty names are skipped.
+        ///
+        /// Every named attribute must be three floats, except the texture
+        /// coordinates, which may have any size. The rest are copied as they are.
+        ///
+        struct Options {
+                std::string position = ""; ///< Stored as four UnsignedShort, normalized to the box. w is always 1.
+                std::string normal = ""; ///< Stored octahedral encoded, as two Short or two Byte
+                std::string tangent = ""; ///< Stored like the normal
+                std::string texcoord = ""; ///< Stored as HalfFloat. Left as floats on GLES2, where they are not available.
+                bool highPrecisionNormals = true; ///< 2x16 bits for normals and tangents instead of 2x8
+        };
+
+        ///
+        /// \brief Turns quantized positions back into object space: offset + scale*position
+        ///
+        struct Dequantization {
+                vec3f offset = vec3f(0.0f);
+                vec3f scale = vec3f(0.0f);
+
+                ///
+                /// \brief Returns the same transform as a matrix, to be applied before the model matrix
+                ///
+                mat4f getTransform() const;
+        };
+
+        ///
+        /// \brief Returns the format quantize() produces for a given format
+        ///
+        static Vertex::Format getQuantizedFormat(const Vertex::Format& format, const Options& options);
+
+        ///
+        /// \brief Returns the constants that undo the position quantization of a mesh with the given bounding box
+        ///
+        static Dequantization getDequantization(const AABB& box);
+
+        ///
+        /// \brief Quantizes vertices
+        ///
+        /// \param format The format of the vertices
+        /// \param vertexData The vertices
+        /// \param vertexCount The number of vertices
+        /// \param box The bounding box of the positions
+        /// \param options The attributes to quantize
+        /// \param result Receives the quantized vertices
+        /// \return The format of the quantized vertices
+        ///
+        static Vertex::Format quantize(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                                       const AABB& box, const Options& options, std::vector<char>& result);
+
+        ///
+        /// \brief Maps a unit vector to the [-1, 1] square, folding the lower half of the octahedron over the upper one
+        ///
+        static vec2f encodeOctahedral(const vec3f& v);
+
+        ///
+        /// \brief Inverse of encodeOctahedral(), returns a unit vector
+        ///
+        static vec3f decodeOctahedral(const vec2f& e);
+
+        ///
+        /// \brief Converts a float to a half float, rounding to nearest even
+        ///
+        static GLushort floatToHalf(float f);
+
+        ///
+        /// \brief Converts a half float to a float
+        ///
+        static float halfToFloat(GLushort h);
+
+    private:
+        MeshQuantizer();
+};
+///
+/// \class MeshQuantizer MeshQuantizer.hpp <VBE/graphics/MeshQuantizer.hpp>
+/// \ingroup Graphics
+///
+/// A position, normal and texture coordinate vertex takes 32 bytes as floats and 16 once
+/// quantized. Adding a tangent takes it from 44 to 20 bytes. With 8 bit normals they drop to
+/// 14 and 16. Positions keep 16 bits of precision along every axis of the bounding box.
+///
+/// GL normalizes the attributes back to [0, 1] and [-1, 1] when fetching them, so shaders only
+/// need to decode the normals and place the positions back in the box:
+/// ~~~{.glsl}
+/// uniform vec3 dequantOffset;
+/// uniform vec3 dequantScale;
+/// in vec3 a_position; // [0, 1] inside the box
+/// in vec2 a_normal; // octahedral
+///
+/// vec3 decodeOctahedral(vec2 e) {
+///     vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+///     if(v.z < 0.0) v.xy = (1.0 - abs(v.yx))*vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+///     return normalize(v);
+/// }
+///
+/// void main() {
+///     vec3 position = dequantOffset + dequantScale*a_position;
+///     vec3 normal = decodeOctahedral(a_normal);
+///     ...
+/// }
+/// ~~~
+/// The constants come from getDequantization(). Instead of the uniforms, Dequantization::getTransform()
+/// can be folded into the model matrix, though normals must then be transformed with the unscaled one.
+///
+
+#endif // MESHQUANTIZER_HPP
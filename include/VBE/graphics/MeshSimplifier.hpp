@@ -0,0 +1,117 @@
+#ifndef MESHSIMPLIFIER_HPP
+#define MESHSIMPLIFIER_HPP
+
+#include <string>
+#include <vector>
+
+#include <VBE/geometry/AABB.hpp>
+#include <VBE/graphics/Vertex.hpp>
+#include <VBE/math.hpp>
+
+///
+/// \brief MeshSimplifier reduces the triangle count of indexed meshes to build levels of detail
+///
+class MeshSimplifier {
+    public:
+        ///
+        /// \brief Which attributes drive the simplification, by name. Empty names are skipped.
+        ///
+        struct Options {
+                std::string position = ""; ///< Three floats. Required.
+                std::string normal = ""; ///< Three floats
+                std::string texcoord = ""; ///< Two floats
+                float normalWeight = 0.5f; ///< Cost of a normal changing by 1, relative to moving by the radius of the mesh
+                float texcoordWeight = 0.5f; ///< Cost of a texture coordinate changing by 1, relative to moving by the radius of the mesh
+                bool lockBorder = false; ///< Keeps the vertices on open borders in place, so pieces of a larger mesh still match
+        };
+
+        ///
+        /// \brief A level of detail: a range of the index buffer and how far it is from the original
+        ///
+        struct Lod {
+                unsigned int offset = 0; ///< First index
+                unsigned int count = 0; ///< Number of indices
+                float error = 0.0f; ///< Estimated distance to the full detail surface, in object space
+        };
+
+        ///
+        /// \brief Simplifies a triangle list by collapsing edges
+        ///
+        /// Edges are collapsed into one of their vertices, so the result indexes the same vertices
+        /// and no vertex is created or moved. The cheapest collapses go first, as measured by the
+        /// quadric error of the positions and by how much the normals and texture coordinates change.
+        /// Vertices that share a position, like both sides of a texture seam, collapse together.
+        ///
+        /// Errors are estimated as the root mean square distance to the planes of the triangles
+        /// that collapsed into a vertex, weighted by their area, so single points can end up
+        /// somewhat further away.
+        ///
+        /// \param format The format of the vertices
+        /// \param vertexData The vertices
+        /// \param vertexCount The number of vertices
+        /// \param indices The triangle list to simplify
+        /// \param result Receives the simplified triangle list
+        /// \param targetIndexCount Stop once the result has at most this many indices
+        /// \param maxError Skip collapses with a larger error, in object space
+        /// \param options The attributes to look at
+        /// \return The error of the result, in object space
+        ///
+        static float simplify(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                              const std::vector<unsigned int>& indices, std::vector<unsigned int>& result,
+                              unsigned int targetIndexCount, float maxError, const Options& options);
+
+        ///
+        /// \brief Builds a chain of levels of detail that share the vertices of the mesh
+        ///
+        /// Every level is simplified from the one before it. The chain stops early when a level
+        /// cannot be reduced by at least half of what was asked.
+        ///
+        /// \param format The format of the vertices
+        /// \param vertexData The vertices
+        /// \param vertexCount The number of vertices
+        /// \param indices The triangle list of the full detail mesh
+        /// \param result Receives the triangle lists of all levels, one after the other, starting with indices
+        /// \param levels The most levels to build, including the full detail one
+        /// \param ratio The fraction of the triangles of a level kept by the next one
+        /// \param options The attributes to look at
+        /// \return The ranges of result that hold every level
+        ///
+        static std::vector<Lod> buildLods(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                                          const std::vector<unsigned int>& indices, std::vector<unsigned int>& result,
+                                          unsigned int levels, float ratio, const Options& options);
+
+        ///
+        /// \brief Picks the coarsest level whose error covers at most pixelError pixels on screen
+        ///
+        /// \param lods The levels, as returned by buildLods()
+        /// \param box The bounding box of the mesh
+        /// \param viewProjection Projection times view. Multiply the model too if the box is in object space.
+        /// \param viewportHeight The height of the viewport, in pixels
+        /// \param pixelError The largest error allowed, in pixels
+        /// \return The index of the level
+        ///
+        static unsigned int selectLod(const std::vector<Lod>& lods, const AABB& box, const mat4f& viewProjection,
+                                      float viewportHeight, float pixelError = 1.0f);
+
+    private:
+        MeshSimplifier();
+};
+///
+/// \class MeshSimplifier MeshSimplifier.hpp <VBE/graphics/MeshSimplifier.hpp>
+/// \ingroup Graphics
+///
+/// All the levels live in one index buffer over one vertex buffer, so switching levels is just
+/// drawing a different range. OBJLoader builds them when given somewhere to put the ranges:
+/// ~~~{.cpp}
+/// std::vector<MeshSimplifier::Lod> lods;
+/// AABB box;
+/// MeshSeparate* mesh = OBJLoader::loadFromOBJStandard(Storage::openAsset("rock.obj"), Mesh::STATIC, &box, &lods);
+/// ...
+/// const MeshSimplifier::Lod& lod = lods[MeshSimplifier::selectLod(lods, box, projection*view*model, screenHeight)];
+/// ((MeshIndexed*) mesh)->draw(program, lod.offset, lod.count);
+/// ~~~
+/// Open borders only slide along themselves and seams stay closed, but vertices are never moved,
+/// so coarse levels of smooth meshes look slightly faceted.
+///
+
+#endif // MESHSIMPLIFIER_HPP
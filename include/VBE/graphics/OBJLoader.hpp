@@ -5,18 +5,50 @@
 #include <iostream>
 
 #include <VBE/graphics/MeshSeparate.hpp>
+#include <VBE/graphics/MeshSimplifier.hpp>
 #include <VBE/geometry/AABB.hpp>
 
 class OBJLoader {
     public:
-        static MeshSeparate* loadFromOBJStandard(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box = nullptr);
-        static MeshSeparate* loadFromOBJTangents(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box = nullptr);
+        // If lods is not nullptr, the mesh is indexed and holds levels of detail, see MeshSimplifier.
+        // The cache is not used then.
+        static MeshSeparate* loadFromOBJStandard(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box = nullptr,
+                                                 std::vector<MeshSimplifier::Lod>* lods = nullptr);
+        static MeshSeparate* loadFromOBJTangents(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box = nullptr,
+                                                 std::vector<MeshSimplifier::Lod>* lods = nullptr);
 
         static void setPositionAttribName(const std::string& name);
         static void setNormalAttribName(const std::string& name);
         static void setTexcoordAttribName(const std::string& name);
         static void setTangentAttribName(const std::string& name);
 
+        // Threads used to parse large files, 0 (the default) means one per core.
+        // Small files are always parsed on the calling thread.
+        static void setThreadCount(unsigned int threads);
+        static unsigned int getThreadCount();
+
+        // Prefix of the mesh cache files, like "cache/". Empty (the default) disables the cache.
+        // Cached meshes are memory mapped instead of parsed, see MeshCache.
+        static void setCachePath(const std::string& path);
+
+        // Reorders indexed meshes for the vertex cache and overdraw, see MeshOptimizer. Off by default.
+        static void setOptimize(bool enabled);
+
+        // Packs positions, normals, tangents and texcoords into smaller types, see MeshQuantizer. Off by default.
+        // Positions are then relative to the box, MeshQuantizer::getDequantization(box) gives the constants to undo it.
+        static void setQuantize(bool enabled, bool highPrecisionNormals = true);
+
+        // Draws indexed meshes as triangle strips joined by primitive restart, when that takes fewer
+        // indexes than a triangle list. Off by default. Meshes stay triangle lists on GLES2 and
+        // wherever MeshIndexed::isPrimitiveRestartSupported() is false.
+        // Indexes are 16 bit whenever they fit, meshes with more vertexes are split in sub-meshes
+        // when that is smaller, see MeshIndexed::setSubMeshes.
+        static void setTriangleStrips(bool enabled);
+
+        // Levels of detail built when the loaders are asked for them, including the full detail one,
+        // and the fraction of the triangles every level keeps from the one before. 4 and 0.5 by default.
+        static void setLodLevels(unsigned int levels, float ratio = 0.5f);
+
     private:
         OBJLoader();
         ~OBJLoader();
@@ -25,6 +57,14 @@ class OBJLoader {
         static std::string normalAttribName;
         static std::string texcoordAttribName;
         static std::string tangentAttribName;
+        static unsigned int threadCount;
+        static std::string cachePath;
+        static bool optimize;
+        static bool quantize;
+        static bool highPrecisionNormals;
+        static bool triangleStrips;
+        static unsigned int lodLevels;
+        static float lodRatio;
 };
 
 #endif //OBJLOADER_HPP
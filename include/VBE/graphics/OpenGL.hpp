@@ -8,3 +8,8 @@
 #else
 #include <GL/glew.h>
 #endif
+
+// Call counting wrappers around the GL entry points, see GLStats
+#ifdef VBE_GL_STATS
+#include <VBE/graphics/GLStats.hpp>
+#endif
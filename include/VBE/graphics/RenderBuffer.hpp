@@ -8,6 +8,9 @@ class RenderBuffer {
     public:
         RenderBuffer();
         RenderBuffer(vec2ui size, TextureFormat::Format format);
+#ifndef VBE_GLES2
+        RenderBuffer(vec2ui size, TextureFormat::Format format, unsigned int samples); //multisampled
+#endif
         RenderBuffer(RenderBuffer&& rhs);
         RenderBuffer& operator=(RenderBuffer&& rhs);
         ~RenderBuffer();
@@ -15,12 +18,14 @@ class RenderBuffer {
 
         void resize(vec2ui size);
         vec2ui getSize() const;
+        unsigned int getSamples() const; //0 if not multisampled
         void bind() const;
         GLuint getHandle() const;
     private:
         vec2ui size = vec2ui(0);
         TextureFormat::Format format = TextureFormat::RGB;
         GLuint handle = 0;
+        unsigned int samples = 0;
 };
 
 #endif // RENDERBUFFER_HPP
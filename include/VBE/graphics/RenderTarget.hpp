@@ -1,22 +1,96 @@
 #ifndef RENDERTARGET_HPP
 #define RENDERTARGET_HPP
 
+#include <functional>
+
 #include <VBE/graphics/RenderTargetBase.hpp>
 
 class RenderTarget : public RenderTargetBase {
     public:
+#ifndef VBE_GLES2
+        ///
+        /// \brief Called with the pixels of a finished readback.
+        ///
+        /// The pixels pointer is only valid during the call. Rows are tightly packed, bottom row first.
+        ///
+        typedef std::function<void(const void* pixels, vec2ui size)> ReadbackCallback;
+#endif
+
+
         RenderTarget();
         RenderTarget(unsigned int width, unsigned int height);
         ~RenderTarget();
 
         void setTexture(RenderTargetBase::Attachment a, Texture2D* tex);
         void setBuffer(RenderTargetBase::Attachment a, RenderBuffer* buff);
+#ifndef VBE_GLES2
+        void setTexture(RenderTargetBase::Attachment a, Texture2DMultisample* tex);
+
+        ///
+        /// \brief Copies the contents of this target into another one, resolving multisampled attachments
+        ///
+        /// Both targets must have the same size. Color is copied from COLOR0 into the draw buffers of
+        /// the destination. Pass nullptr to resolve into the screen.
+        ///
+        /// \param mask Any combination of GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT and GL_STENCIL_BUFFER_BIT
+        ///
+        void resolveTo(const RenderTarget* other, GLbitfield mask = GL_COLOR_BUFFER_BIT) const;
+        void resolveTo(const RenderTarget& other, GLbitfield mask = GL_COLOR_BUFFER_BIT) const {
+            resolveTo(&other, mask);
+        }
+#endif
 
         Texture2D* getTexture(RenderTargetBase::Attachment a) const;
 
+#ifndef VBE_GLES2
+        ///
+        /// \brief Starts copying a region of an attachment into a pixel buffer without waiting for the GPU
+        ///
+        /// The copy goes through a recycled pixel pack buffer guarded by a fence. The callback is run
+        /// from pollReadbacks() once the GPU is done, usually one or two frames later.
+        ///
+        /// \param offset Lower-left corner of the region
+        /// \param regionSize Size of the region
+        /// \param sourceFormat Format of the returned pixels. Use DEPTH_COMPONENT for depth attachments.
+        /// \param sourceType Data type of the returned pixels
+        ///
+        void readbackAsync(RenderTargetBase::Attachment a, vec2ui offset, vec2ui regionSize, ReadbackCallback callback,
+                           TextureFormat::Format sourceFormat = TextureFormat::RGBA,
+                           TextureFormat::SourceType sourceType = TextureFormat::UNSIGNED_BYTE) const;
+
+        ///
+        /// \brief Runs the callbacks of the finished readbacks. Never blocks unless wait is true.
+        ///
+        /// \param wait If true, waits for every pending readback to finish
+        ///
+        static void pollReadbacks(bool wait = false);
+
+        ///
+        /// \brief Returns the number of readbacks the GPU has not finished yet
+        ///
+        static unsigned int getPendingReadbacks();
+#endif
+
         RenderTarget(RenderTarget&& rhs);
         RenderTarget& operator=(RenderTarget&& rhs);
         friend void swap(RenderTarget& a, RenderTarget& b);
+#ifndef VBE_GLES2
+    private:
+        struct Readback {
+                GLuint buffer = 0;
+                unsigned int capacity = 0; //in bytes
+                unsigned int bytes = 0;
+                vec2ui size = vec2ui(0);
+                GLsync fence = 0;
+                ReadbackCallback callback;
+        };
+
+        static unsigned int getReadbackPixelSize(TextureFormat::Format format, TextureFormat::SourceType type);
+
+        //pending readbacks are in the front, free buffers in the back
+        static std::vector<Readback> readbacks;
+        static unsigned int pendingReadbacks;
+#endif
 };
 
 #endif // RENDERTARGET_HPP
@@ -9,6 +9,7 @@
 #include <VBE/graphics/OpenGL.hpp>
 #include <VBE/graphics/Texture2D.hpp>
 #include <VBE/graphics/Texture2DArray.hpp>
+#include <VBE/graphics/Texture2DMultisample.hpp>
 #include <VBE/graphics/RenderBuffer.hpp>
 #include <VBE/math.hpp>
 #include <VBE/utils/NonCopyable.hpp>
@@ -39,7 +40,7 @@ class RenderTargetBase : public NonCopyable {
 #endif
         };
 
-        inline bool isColorAttachment(Attachment a) {
+        inline bool isColorAttachment(Attachment a) const {
 #ifdef VBE_GLES2
             return a == COLOR0;
 #else
@@ -47,6 +48,23 @@ class RenderTargetBase : public NonCopyable {
 #endif
         }
 
+        ///
+        /// \brief What happens to the contents of an attachment when the target is bound
+        ///
+        enum LoadAction {
+            LOAD = 0, ///< Keep the previous contents
+            CLEAR, ///< Clear to the target's clear value
+            DONT_CARE ///< The previous contents are undefined, the pass overwrites them
+        };
+
+        ///
+        /// \brief What happens to the contents of an attachment when another target is bound
+        ///
+        enum StoreAction {
+            STORE = 0, ///< Keep the contents
+            DISCARD ///< The contents are not needed anymore
+        };
+
         static void bind(const RenderTargetBase& renderTarget) {
             bind(&renderTarget);
         }
@@ -54,6 +72,38 @@ class RenderTargetBase : public NonCopyable {
         static void bind(const RenderTargetBase* renderTarget);
         static const RenderTargetBase* getCurrent();
 
+        ///
+        /// \brief Sets the action run on an attachment every time this target becomes the current one. Defaults to LOAD.
+        ///
+        /// DONT_CARE and DISCARD let tile-based GPUs skip copying the attachment between tile memory
+        /// and main memory. They map to glInvalidateFramebuffer (glDiscardFramebufferEXT in GLES2).
+        ///
+        void setLoadAction(Attachment a, LoadAction action);
+
+        ///
+        /// \brief Sets the action run on an attachment every time this target stops being the current one. Defaults to STORE.
+        ///
+        void setStoreAction(Attachment a, StoreAction action);
+
+        LoadAction getLoadAction(Attachment a) const;
+        StoreAction getStoreAction(Attachment a) const;
+
+        ///
+        /// \brief Sets the value color attachments are cleared to by the CLEAR load action
+        ///
+        void setClearColor(vec4f color);
+
+        ///
+        /// \brief Sets the value depth attachments are cleared to by the CLEAR load action
+        ///
+        void setClearDepth(float depth);
+
+        ///
+        /// \brief Sets the value stencil attachments are cleared to by the CLEAR load action
+        ///
+        void setClearStencil(int stencil);
+
+        GLuint getHandle() const;
         vec2ui getSize() const;
         unsigned int getNumLayers() const;
 
@@ -62,8 +112,13 @@ class RenderTargetBase : public NonCopyable {
         RenderTargetBase(unsigned int width, unsigned int height, unsigned int numLayers);
         virtual ~RenderTargetBase();
 
+        static void bindFramebuffer(const RenderTargetBase* target, bool runActions);
+        static void invalidate(const std::vector<GLenum>& attachments);
+
         void ensureValid() const;
         void valid() const; //validate this framebuffer pls
+        void load() const;
+        void store() const;
         void enableAttachment(RenderTargetBase::Attachment a);
         void disableAttachment(RenderTargetBase::Attachment a);
 
@@ -72,6 +127,7 @@ class RenderTargetBase : public NonCopyable {
                     RenderBufferEntry = 0,
 #ifndef VBE_GLES2
                     Texture2DArrayEntry,
+                    Texture2DMultisampleEntry,
 #endif
                     Texture2DEntry
                 };
@@ -83,6 +139,8 @@ class RenderTargetBase : public NonCopyable {
 #ifndef VBE_GLES2
                 RenderTargetEntry(Texture2DArray* texture) :
                     type(Texture2DArrayEntry), texture2DArray(texture) {}
+                RenderTargetEntry(Texture2DMultisample* texture) :
+                    type(Texture2DMultisampleEntry), texture2DMultisample(texture) {}
 #endif
                 ~RenderTargetEntry() {}
 
@@ -95,6 +153,7 @@ class RenderTargetBase : public NonCopyable {
                 Texture2D* texture2D;
 #ifndef VBE_GLES2
                 Texture2DArray* texture2DArray;
+                Texture2DMultisample* texture2DMultisample;
 #endif
         };
 
@@ -107,6 +166,11 @@ class RenderTargetBase : public NonCopyable {
         std::vector<Attachment> drawAttachments;
         std::set<Attachment> allAttachments;
         mutable std::map<Attachment, RenderTargetEntry> entries;
+        std::map<Attachment, LoadAction> loadActions;
+        std::map<Attachment, StoreAction> storeActions;
+        vec4f clearColor = vec4f(0.0f);
+        float clearDepth = 1.0f;
+        int clearStencil = 0;
 };
 
 
@@ -0,0 +1,109 @@
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+#include <unordered_map>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+// Sampler objects are not supported in GLES2
+#ifndef VBE_GLES2
+
+///
+/// \brief Sampler represents a GL sampler object, the state used to sample a texture
+///
+class Sampler : public NonCopyable {
+    public:
+        ///
+        /// \brief The sampling state. Defaults match the ones VBE sets on new textures.
+        ///
+        class State {
+            public:
+                ///
+                /// \brief Filter and wrap constructor
+                ///
+                State(GLenum minFilter = GL_LINEAR, GLenum magFilter = GL_LINEAR, GLenum wrap = GL_CLAMP_TO_EDGE) :
+                    minFilter(minFilter), magFilter(magFilter), wrapS(wrap), wrapT(wrap), wrapR(wrap) {}
+
+                bool operator == (const State& s) const;
+                bool operator != (const State& s) const;
+
+                ///
+                /// \brief Returns a hash of the whole state
+                ///
+                std::size_t hash() const;
+
+                GLenum minFilter = GL_LINEAR; ///< GL_TEXTURE_MIN_FILTER
+                GLenum magFilter = GL_LINEAR; ///< GL_TEXTURE_MAG_FILTER
+                GLenum wrapS = GL_CLAMP_TO_EDGE; ///< GL_TEXTURE_WRAP_S
+                GLenum wrapT = GL_CLAMP_TO_EDGE; ///< GL_TEXTURE_WRAP_T
+                GLenum wrapR = GL_CLAMP_TO_EDGE; ///< GL_TEXTURE_WRAP_R
+                GLenum compareMode = GL_NONE; ///< GL_TEXTURE_COMPARE_MODE
+                GLenum compareFunc = GL_LEQUAL; ///< GL_TEXTURE_COMPARE_FUNC
+                float minLod = -1000.0f; ///< GL_TEXTURE_MIN_LOD
+                float maxLod = 1000.0f; ///< GL_TEXTURE_MAX_LOD
+                float lodBias = 0.0f; ///< GL_TEXTURE_LOD_BIAS
+        };
+
+        ///
+        /// \brief Returns the sampler for the given state, creating it if needed.
+        ///
+        /// Samplers are shared: asking twice for the same state returns the same object.
+        /// The returned sampler stays valid until Sampler::clearCache() is called.
+        ///
+        static const Sampler* get(const State& state);
+
+        ///
+        /// \brief Destroys all the samplers created through Sampler::get()
+        ///
+        static void clearCache();
+
+        ///
+        /// \brief Binds a sampler to a texture slot. Pass nullptr to use the texture's own parameters.
+        ///
+        static void bind(const Sampler* sampler, unsigned int slot);
+
+        ///
+        /// \brief Returns the OpenGL handle of this sampler
+        ///
+        GLuint getHandle() const;
+
+        ///
+        /// \brief Returns the state of this sampler
+        ///
+        const State& getState() const;
+
+    private:
+        struct StateHash {
+                std::size_t operator()(const State& s) const { return s.hash(); }
+        };
+
+        Sampler(const State& state);
+        ~Sampler();
+
+        GLuint handle = 0;
+        const State state;
+
+        static std::unordered_map<State, Sampler*, StateHash> cache;
+        static std::vector<GLuint> current;
+};
+///
+/// \class Sampler Sampler.hpp <VBE/graphics/Sampler.hpp>
+/// \ingroup Graphics
+///
+/// Sampler objects override the filtering, wrapping and comparison parameters of whatever
+/// texture is bound to the same slot, so the same texture can be sampled in different ways
+/// without duplicating it nor calling Texture::setFilter or Texture::setWrap between draws.
+/// Pass the sampler along with the texture when setting a sampler uniform:
+/// ~~~{.cpp}
+/// const Sampler* nearest = Sampler::get(Sampler::State(GL_NEAREST, GL_NEAREST, GL_REPEAT));
+/// program.uniform("tex")->set(texture, *nearest);
+/// ~~~
+///
+/// \see Uniform
+///
+
+#endif // VBE_GLES2
+#endif // SAMPLER_HPP
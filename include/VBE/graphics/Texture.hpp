@@ -1,8 +1,12 @@
 #ifndef Texture_HPP
 #define Texture_HPP
 
+#include <utility>
+#include <vector>
+
 #include <VBE/config.hpp>
 #include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Sampler.hpp>
 #include <VBE/graphics/TextureFormat.hpp>
 #include <VBE/utils/NonCopyable.hpp>
 
@@ -20,6 +24,7 @@ class Texture : public NonCopyable {
             Type3D, //< GL_TEXTURE_3D
             TypeCubemap, //< GL_TEXTURE_CUBEMAP
             TypeCubemapArray, //< GL_TEXTURE_CUBE_MAP_ARRAY
+            Type2DMultisample, //< GL_TEXTURE_2D_MULTISAMPLE
             TypeCount
         };
 
@@ -44,11 +49,34 @@ class Texture : public NonCopyable {
         ///
         Type getType() const;
 
+        ///
+        /// \brief Returns the number of texels in the base level of this texture
+        ///
+        virtual unsigned int getTexelCount() const = 0;
+
+        ///
+        /// \brief Returns the estimated amount of GPU memory used by this texture, in bytes
+        ///
+        /// The estimate is computed from the format, the size and wether mipmaps have been
+        /// generated. It does not account for driver padding or compression.
+        ///
+        unsigned long long getEstimatedMemory() const;
+
+        ///
+        /// \brief Returns wether mipmap levels have been generated for this texture
+        ///
+        bool hasMipmaps() const;
+
 #ifndef VBE_GLES2
         ///
         /// \brief Sets the comparison function and mode
         ///
         void setComparison(GLenum func, GLenum mode = GL_COMPARE_REF_TO_TEXTURE);
+
+        ///
+        /// \brief Sets the last mip level that is generated and sampled
+        ///
+        void setMaxLevel(unsigned int level);
 #endif
 
         ///
@@ -82,6 +110,43 @@ class Texture : public NonCopyable {
         ///
         static unsigned int getMaxSlots();
 
+        ///
+        /// \brief Returns the number of glBindTexture calls issued so far
+        ///
+        /// Binds skipped because the texture was already bound are not counted.
+        ///
+        static unsigned long long getBindCount();
+
+#ifndef VBE_GLES2
+        ///
+        /// \brief Returns wether ARB_bindless_texture is available
+        ///
+        static bool isBindlessSupported();
+
+        ///
+        /// \brief Returns a resident bindless handle for this texture, creating it if needed
+        ///
+        /// Once a bindless handle exists the texture parameters and storage can no longer
+        /// change, so set them up (and generate mipmaps) before calling this.
+        ///
+        GLuint64 getBindlessHandle() const;
+
+        ///
+        /// \brief Returns a resident bindless handle for this texture sampled with the given sampler
+        ///
+        /// Handles are shared by samplers with the same state, so they stay valid after
+        /// Sampler::clearCache().
+        ///
+        /// \see Texture::getBindlessHandle()
+        ///
+        GLuint64 getBindlessHandle(const Sampler& sampler) const;
+
+        ///
+        /// \brief Returns wether any bindless handle has been created for this texture
+        ///
+        bool isBindless() const;
+#endif
+
         ///
         /// \brief Swap operator for the Texture class
         ///
@@ -92,12 +157,22 @@ class Texture : public NonCopyable {
         static void bind(Type type, const Texture* tex, unsigned int slot);
         static GLenum typeToGL(Type t);
     private:
+        void setParameter(GLenum pname, GLint value);
         GLuint handle = 0;
         TextureFormat::Format format = TextureFormat::RGB;
         Type type = Type2D;
+        bool mipmaps = false;
+        bool cached = false; //managed by TextureCache
+#ifndef VBE_GLES2
+        mutable GLuint64 bindlessHandle = 0; //resident handle without a sampler
+        mutable std::vector<std::pair<Sampler::State, GLuint64>> samplerBindlessHandles; //sampler state -> resident handle
+#endif
+
+        friend class TextureCache;
 
         static std::vector<std::vector<GLuint>> current;
         static unsigned int currentUnit;
+        static unsigned long long bindCount;
         static int maxSlots;
 };
 
@@ -108,5 +183,9 @@ class Texture : public NonCopyable {
 /// This base class provides common functionality that is available for all textures, such as setting
 /// the wrapping/filtering/comparing modes.
 ///
+/// When ARB_bindless_texture is available, getBindlessHandle() returns a 64-bit handle that
+/// shaders can sample from without binding the texture to any slot. Put the handles in a
+/// TextureHandleTable to reference many textures from a single batch.
+///
 
 #endif // Texture_HPP
@@ -58,11 +58,32 @@ class Texture2D : public Texture {
                      TextureFormat::Format sourceFormat = TextureFormat::RGBA,
                      TextureFormat::SourceType sourceType = TextureFormat::UNSIGNED_BYTE);
 
+        ///
+        /// \brief Sets the content of a region of the texture, leaving the rest untouched
+        ///
+        /// The pixels pointer must hold enough data to fill the region, otherwise the behaviour is undefined
+        ///
+        /// \param offset The lower-left corner of the region
+        /// \param regionSize The size of the region
+        /// \param sourceFormat The format of the pixels pointer
+        /// \param sourceType The data type of the pixels pointer
+        ///
+        void setSubData(const void* pixels,
+                        vec2ui offset,
+                        vec2ui regionSize,
+                        TextureFormat::Format sourceFormat = TextureFormat::RGBA,
+                        TextureFormat::SourceType sourceType = TextureFormat::UNSIGNED_BYTE);
+
         ///
         /// \brief Returns the texture size
         ///
         vec2ui getSize() const;
 
+        ///
+        /// \brief Returns the number of texels in the base level of this texture
+        ///
+        unsigned int getTexelCount() const override;
+
         ///
         /// \brief Bind a texture to any given slot
         ///
@@ -61,11 +61,33 @@ class Texture2DArray : public Texture {
                 TextureFormat::Format sourceFormat = TextureFormat::RGBA,
                 TextureFormat::SourceType sourceType = TextureFormat::UNSIGNED_BYTE);
 
+        ///
+        /// \brief Sets the content of a region of the texture, leaving the rest untouched
+        ///
+        /// The pixels pointer must hold enough data to fill the region, otherwise the behaviour is undefined
+        ///
+        /// \param offset The corner of the region. offset.z is the first slice.
+        /// \param regionSize The size of the region. regionSize.z is the number of slices.
+        /// \param sourceFormat The format of the pixels pointer
+        /// \param sourceType The data type of the pixels pointer
+        ///
+        void setSubData(
+                const void* pixels,
+                vec3ui offset,
+                vec3ui regionSize,
+                TextureFormat::Format sourceFormat = TextureFormat::RGBA,
+                TextureFormat::SourceType sourceType = TextureFormat::UNSIGNED_BYTE);
+
         ///
         /// \brief Returns the texture size
         ///
         vec3ui getSize() const;
 
+        ///
+        /// \brief Returns the number of texels in the base level of this texture
+        ///
+        unsigned int getTexelCount() const override;
+
         ///
         /// \brief Bind a texture to any given slot
         ///
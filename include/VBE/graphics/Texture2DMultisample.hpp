@@ -0,0 +1,95 @@
+#ifndef TEXTURE2DMULTISAMPLE_HPP
+#define TEXTURE2DMULTISAMPLE_HPP
+
+#include <VBE/graphics/Texture.hpp>
+
+// Multisample textures are not supported in GLES2
+#ifndef VBE_GLES2
+
+///
+/// \brief Texture2DMultisample represents a GL 2D Multisample Texture
+///
+class Texture2DMultisample : public Texture {
+    public:
+        ///
+        /// \brief Default constructor. Generates an invalid texture with no pixels.
+        ///
+        /// This constructor will generate a texture of size 0. This texture is not
+        /// meant for use in rendering.
+        ///
+        Texture2DMultisample();
+
+        ///
+        /// \brief Size, Format and Samples constructor.
+        ///
+        /// Will create an empty texture with the specified size, format and number of samples per texel.
+        /// The storage is immutable, and multisample textures can't be filtered nor given data directly:
+        /// render to them through a RenderTarget and resolve it with RenderTarget::resolveTo.
+        ///
+        /// \param format Must be sized.
+        ///
+        /// \see TextureFormat::Format
+        ///
+        Texture2DMultisample(vec2ui size,
+                             unsigned int samples,
+                             TextureFormat::Format format = TextureFormat::RGBA8);
+
+        ///
+        /// \brief Returns the texture size
+        ///
+        vec2ui getSize() const;
+
+        ///
+        /// \brief Returns the number of samples per texel
+        ///
+        unsigned int getSamples() const;
+
+        ///
+        /// \brief Returns the number of samples in this texture
+        ///
+        unsigned int getTexelCount() const override;
+
+        ///
+        /// \brief Bind a texture to any given slot
+        ///
+        /// Binding this texture will replace whatever texture was previously assigned for this slot
+        ///
+        static void bind(const Texture2DMultisample* tex, unsigned int slot) {
+            Texture::bind(Texture::Type2DMultisample, tex, slot);
+        }
+
+        ///
+        /// \brief Returns the maximum number of samples supported for textures of a format
+        ///
+        /// Depth and stencil formats, and integer formats, may support fewer samples than
+        /// other color formats.
+        ///
+        static unsigned int getMaxSamples(TextureFormat::Format format);
+
+        ///
+        /// \brief Move constructor
+        ///
+        Texture2DMultisample(Texture2DMultisample&& rhs);
+
+        ///
+        /// \brief Move operator=
+        ///
+        Texture2DMultisample& operator=(Texture2DMultisample&& rhs);
+
+        ///
+        /// \brief Swap operator for the Texture2DMultisample class
+        ///
+        friend void swap(Texture2DMultisample& a, Texture2DMultisample& b);
+
+    private:
+        vec2ui size = vec2ui(0);
+        unsigned int samples = 0;
+};
+///
+/// \class Texture2DMultisample Texture2DMultisample.hpp <VBE/graphics/Texture2DMultisample.hpp>
+/// \ingroup Graphics
+///
+
+#endif // VBE_GLES2
+
+#endif // TEXTURE2DMULTISAMPLE_HPP
@@ -53,6 +53,11 @@ class Texture3D : public Texture {
         ///
         vec3ui getSize() const;
 
+        ///
+        /// \brief Returns the number of texels in the base level of this texture
+        ///
+        unsigned int getTexelCount() const override;
+
         ///
         /// \brief Bind a texture to any given slot
         ///
@@ -0,0 +1,201 @@
+#ifndef TEXTUREATLAS_HPP
+#define TEXTUREATLAS_HPP
+
+#include <map>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/Texture2D.hpp>
+#include <VBE/graphics/Texture2DArray.hpp>
+#include <VBE/math.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+class Image;
+
+///
+/// \brief TextureAtlas packs many small images into a few shared texture pages
+///
+class TextureAtlas : public NonCopyable {
+    public:
+        ///
+        /// \brief The kind of texture used to store the pages
+        ///
+        enum PageType {
+            Pages2D = 0, ///< One Texture2D per page
+#ifndef VBE_GLES2
+            PagesArray ///< One Texture2DArray, one slice per page
+#endif
+        };
+
+        ///
+        /// \brief Where an image ended up inside the atlas
+        ///
+        struct Region {
+                unsigned int page = 0; ///< Page index (or array slice)
+                vec2ui position = vec2ui(0); ///< Lower-left corner in texels, gutters excluded
+                vec2ui size = vec2ui(0); ///< Size in texels, gutters excluded
+                vec2f uvMin = vec2f(0.0f); ///< Texture coordinates of the lower-left corner
+                vec2f uvMax = vec2f(0.0f); ///< Texture coordinates of the upper-right corner
+        };
+
+        ///
+        /// \brief Constructor
+        ///
+        /// \param pageSize Size of every page in texels
+        /// \param padding Width of the gutter around every image, filled by extruding its borders.
+        ///        Mip levels 0 to log2(padding) do not bleed between images, see getMipLevelCount().
+        /// \param type The kind of texture backing the pages
+        /// \param format Internal format of the pages
+        ///
+        TextureAtlas(vec2ui pageSize,
+                     unsigned int padding = 2,
+                     PageType type = Pages2D,
+                     TextureFormat::Format format = TextureFormat::RGBA);
+
+        ///
+        /// \brief Destructor
+        ///
+        ~TextureAtlas();
+
+        ///
+        /// \brief Packs an image into the atlas and returns its id
+        ///
+        unsigned int insert(const Image& img);
+
+        ///
+        /// \brief Packs 8-bit pixel data with 1 to 4 channels into the atlas and returns its id
+        ///
+        unsigned int insert(const void* pixels, vec2ui size, unsigned int channels);
+
+        ///
+        /// \brief Removes an image from the atlas.
+        ///
+        /// Its space is only reused once its page is empty or after calling repack().
+        ///
+        void remove(unsigned int id);
+
+        ///
+        /// \brief Returns wether the id belongs to an image in the atlas
+        ///
+        bool contains(unsigned int id) const;
+
+        ///
+        /// \brief Returns the region of an image. Regions change after repack().
+        ///
+        const Region& getRegion(unsigned int id) const;
+
+        ///
+        /// \brief Packs all images again from scratch, reclaiming the space of removed ones
+        ///
+        /// All regions may change and empty trailing pages are released.
+        ///
+        void repack();
+
+        ///
+        /// \brief Regenerates the mipmaps of the pages modified since the last call
+        ///
+        void generateMipmaps();
+
+        ///
+        /// \brief Returns the number of mip levels that do not bleed between images
+        ///
+        /// That is floor(log2(padding)) + 1, or 1 without padding. Images are placed on a grid
+        /// of 2^(count - 1) texels so no texel of those levels is shared by two of them. Deeper
+        /// levels are not generated, except on GLES2 where they can't be left out.
+        ///
+        unsigned int getMipLevelCount() const;
+
+        ///
+        /// \brief Returns the number of pages in use
+        ///
+        unsigned int getPageCount() const;
+
+        ///
+        /// \brief Returns the size of every page
+        ///
+        vec2ui getPageSize() const;
+
+        ///
+        /// \brief Returns the fraction of the page area covered by images, gutters included
+        ///
+        float getOccupancy() const;
+
+        ///
+        /// \brief Returns a page. Only valid with the Pages2D page type.
+        ///
+        const Texture2D& getPage(unsigned int page) const;
+
+#ifndef VBE_GLES2
+        ///
+        /// \brief Returns the texture holding all pages. Only valid with the PagesArray page type.
+        ///
+        const Texture2DArray& getPageArray() const;
+#endif
+
+    private:
+        struct SkylineNode {
+                SkylineNode(unsigned int x, unsigned int y, unsigned int width) : x(x), y(y), width(width) {}
+                unsigned int x;
+                unsigned int y;
+                unsigned int width;
+        };
+
+        struct Page {
+                std::vector<SkylineNode> skyline;
+                unsigned int entryCount = 0;
+                bool dirty = false;
+        };
+
+        struct Entry {
+                Region region;
+                vec2ui paddedSize = vec2ui(0);
+                std::vector<unsigned char> pixels; //RGBA, gutters included
+        };
+
+        void resetPage(Page& p) const;
+        bool fit(const Page& p, unsigned int index, vec2ui size, unsigned int& y) const;
+        bool findPosition(const Page& p, vec2ui size, unsigned int& index, vec2ui& position) const;
+        void addSkylineLevel(Page& p, unsigned int index, vec2ui position, vec2ui size) const;
+        bool place(Entry& e);
+        bool addPage();
+        void upload(const Entry& e);
+
+        const vec2ui pageSize;
+        const unsigned int padding;
+        const unsigned int mipLevelCount;
+        const PageType type;
+        const TextureFormat::Format format;
+        unsigned int nextId = 1;
+        std::map<unsigned int, Entry> entries;
+        std::vector<Page> pages;
+        std::vector<Texture2D*> textures;
+#ifndef VBE_GLES2
+        Texture2DArray* array = nullptr;
+#endif
+};
+///
+/// \class TextureAtlas TextureAtlas.hpp <VBE/graphics/TextureAtlas.hpp>
+/// \ingroup Graphics
+///
+/// Sprites that share a page can be drawn without changing textures between them. Images
+/// are placed with a skyline bottom-left packer and uploaded with glTexSubImage2D, each one
+/// surrounded by a gutter of extruded border texels so filtering does not bleed between
+/// neighbours. The gutter halves with every mip level, so only the levels where it is still a
+/// texel wide are kept: two with the default padding of 2, three with a padding of 4. The atlas
+/// keeps a copy of every image in client memory, which allows repacking and growing a
+/// PagesArray atlas without reading back from the GPU.
+///
+/// ~~~{.cpp}
+/// TextureAtlas atlas(vec2ui(1024));
+/// unsigned int icon = atlas.insert(Image::load(Storage::openAsset("icon.png")));
+/// const TextureAtlas::Region& r = atlas.getRegion(icon);
+/// program.uniform("tex")->set(atlas.getPage(r.page));
+/// program.uniform("uvMin")->set(r.uvMin);
+/// program.uniform("uvMax")->set(r.uvMax);
+/// ~~~
+///
+/// Images are stored as RGBA. Images with fewer channels are expanded the same way OpenGL
+/// expands them when sampling (missing color channels are 0, missing alpha is 1).
+///
+
+#endif // TEXTUREATLAS_HPP
@@ -0,0 +1,165 @@
+#ifndef TEXTURECACHE_HPP
+#define TEXTURECACHE_HPP
+
+#include <functional>
+#include <list>
+#include <map>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/Texture2D.hpp>
+
+///
+/// \brief TextureCache keeps the estimated GPU memory used by textures under a budget
+///
+class TextureCache {
+    public:
+        ///
+        /// \brief Function used to restore the full contents of an evicted texture.
+        ///
+        /// It must fill the whole texture, usually through Texture2D::setData.
+        ///
+        typedef std::function<void(Texture2D& tex)> Loader;
+
+        ///
+        /// \brief Starts managing a texture.
+        ///
+        /// The texture may be evicted whenever the budget is exceeded, and it
+        /// will be restored with the given loader the next time it is bound.
+        /// The texture must not be used as a RenderTarget attachment.
+        ///
+        static void add(Texture2D* tex, Loader loader);
+
+        ///
+        /// \brief Stops managing a texture. If it was evicted, it is restored first.
+        ///
+        static void release(Texture2D* tex);
+
+        ///
+        /// \brief Returns wether the texture is managed by the cache
+        ///
+        static bool contains(const Texture* tex);
+
+        ///
+        /// \brief Returns wether the texture is currently evicted
+        ///
+        /// Texture2D::getSize() keeps returning the full size of an evicted texture,
+        /// even though only its low mip level is allocated.
+        ///
+        static bool isEvicted(const Texture* tex);
+
+        ///
+        /// \brief Sets the memory budget in bytes. Zero means unlimited.
+        ///
+        /// Least recently bound textures are evicted right away until
+        /// the estimated usage fits the new budget.
+        ///
+        static void setBudget(unsigned long long bytes);
+
+        ///
+        /// \brief Returns the memory budget in bytes
+        ///
+        static unsigned long long getBudget();
+
+        ///
+        /// \brief Returns the estimated memory used by all managed textures, in bytes
+        ///
+        static unsigned long long getUsage();
+
+        ///
+        /// \brief Sets the mip level evicted textures are shrunk to. Defaults to 4.
+        ///
+        /// Evicted textures keep the contents of that mip level, generated on eviction
+        /// when the texture has no mipmaps. Integer textures, and every texture on GLES2,
+        /// can't be read back and are cleared to zero instead.
+        ///
+        static void setEvictionLevel(unsigned int level);
+
+        ///
+        /// \brief Returns the mip level evicted textures are shrunk to
+        ///
+        static unsigned int getEvictionLevel();
+
+        ///
+        /// \brief Evicts least recently bound textures until usage fits the budget
+        ///
+        static void trim();
+
+        ///
+        /// \brief Returns the number of binds of a resident managed texture
+        ///
+        static unsigned long long getHits();
+
+        ///
+        /// \brief Returns the number of binds that needed to reload an evicted texture
+        ///
+        static unsigned long long getMisses();
+
+        ///
+        /// \brief Returns the number of evictions
+        ///
+        static unsigned long long getEvictions();
+
+        ///
+        /// \brief Resets the hit, miss and eviction counters
+        ///
+        static void resetCounters();
+
+    private:
+        TextureCache();
+
+        struct Entry {
+                Entry(Texture2D* tex, Loader loader) : tex(tex), loader(loader) {}
+                Texture2D* tex;
+                Loader loader;
+                unsigned long long memory = 0;
+                bool evicted = false;
+#ifndef VBE_GLES2
+                GLint maxLevel = 1000; // GL_TEXTURE_MAX_LEVEL before eviction
+#else
+                GLint minFilter = GL_LINEAR; // GL_TEXTURE_MIN_FILTER before eviction
+#endif
+        };
+
+        static void touch(const Texture* tex);
+        static void remove(const Texture* tex);
+        static void swapEntries(Texture* a, Texture* b);
+        static void evict(Entry& e);
+        static void reload(Entry& e);
+        static unsigned long long evictedMemory(const Texture2D* tex);
+
+        //most recently bound textures first
+        static std::list<Entry> entries;
+        static std::map<const Texture*, std::list<Entry>::iterator> lookup;
+        static unsigned long long budget;
+        static unsigned long long usage;
+        static unsigned int evictionLevel;
+        static unsigned long long hits;
+        static unsigned long long misses;
+        static unsigned long long evictions;
+        static bool updating;
+
+        friend class Texture;
+        friend void swap(Texture& a, Texture& b);
+};
+///
+/// \class TextureCache TextureCache.hpp <VBE/graphics/TextureCache.hpp>
+/// \ingroup Graphics
+///
+/// Every time a managed texture is bound (through Texture2D::bind or Uniform::set) it
+/// becomes the most recently used one. When the estimated memory of all managed textures
+/// goes over the budget, the least recently bound ones are shrunk down to a low mip level,
+/// which frees most of their memory while keeping their handle valid. Binding an evicted
+/// texture calls its Loader to restore it before it is used. Anything sampling it without
+/// binding it again, like a texture unit it was left bound to, sees a blurry version of it
+/// until then. Example:
+/// ~~~{.cpp}
+/// Texture2D* tex = new Texture2D(Texture2D::load(Storage::openAsset("rock.png")));
+/// TextureCache::add(tex, [](Texture2D& t) {
+///     Image img = Image::load(Storage::openAsset("rock.png"));
+///     t.setData(img.getData(), img.getGlFormat());
+/// });
+/// TextureCache::setBudget(64 << 20); // 64 MiB
+/// ~~~
+///
+
+#endif // TEXTURECACHE_HPP
@@ -77,6 +77,11 @@ class TextureCubemap : public Texture {
         ///
         unsigned int getSize() const;
 
+        ///
+        /// \brief Returns the number of texels in the base level of this texture
+        ///
+        unsigned int getTexelCount() const override;
+
         ///
         /// \brief Bind a texture to any given slot
         ///
@@ -72,6 +72,11 @@ class TextureCubemapArray : public Texture {
 		///
 		unsigned int getSlices() const;
 
+		///
+		/// \brief Returns the number of texels in the base level of this texture
+		///
+		unsigned int getTexelCount() const override;
+
 		///
 		/// \brief Bind a texture to any given slot
 		///
@@ -265,6 +265,113 @@ class TextureFormat {
             }
         }
 
+        ///
+        /// \brief Returns the estimated size in bytes of a single texel of the given format.
+        ///
+        /// Unsized formats are assumed to use 8 bits per channel. The actual
+        /// size used by the driver may be bigger due to padding.
+        ///
+        inline static unsigned int getPixelSize(Format f) {
+            switch(f) {
+#ifdef VBE_GLES2
+                case ALPHA:
+                case LUMINANCE:
+                    return 1;
+                case LUMINANCE_ALPHA:
+                    return 2;
+#else
+                case R8:
+                case R8_SNORM:
+                case R8I:
+                case R8UI:
+                case RED:
+                case RED_INTEGER:
+                case STENCIL:
+                case STENCIL8:
+                    return 1;
+                case R16:
+                case R16_SNORM:
+                case R16F:
+                case R16I:
+                case R16UI:
+                case RG8:
+                case RG8_SNORM:
+                case RG8I:
+                case RG8UI:
+                case RG:
+                case RG_INTEGER:
+                case RGB4:
+                case RGB5:
+                case RGBA2:
+                    return 2;
+                case RGB8:
+                case RGB8_SNORM:
+                case RGB8I:
+                case RGB8UI:
+                case SRGB8:
+                case BGR:
+                case BGR_INTEGER:
+                case RGB_INTEGER:
+                case DEPTH_COMPONENT24:
+                    return 3;
+                case R32F:
+                case R32I:
+                case R32UI:
+                case RG16:
+                case RG16_SNORM:
+                case RG16F:
+                case RG16I:
+                case RG16UI:
+                case RGB10:
+                case RGBA8:
+                case RGBA8_SNORM:
+                case RGBA8I:
+                case RGBA8UI:
+                case SRGBA8:
+                case BGRA:
+                case BGRA_INTEGER:
+                case RGBA_INTEGER:
+                case DEPTH_COMPONENT:
+                case DEPTH_STENCIL:
+                case DEPTH_COMPONENT32:
+                case DEPTH_COMPONENT32F:
+                case DEPTH24_STENCIL8:
+                    return 4;
+                case RGB12:
+                case RGBA12:
+                    return 5;
+                case RGB16_SNORM:
+                case RGB16F:
+                case RGB16I:
+                case RGB16UI:
+                    return 6;
+                case RG32F:
+                case RG32I:
+                case RG32UI:
+                case RGBA16:
+                case RGBA16F:
+                case RGBA16I:
+                case RGBA16UI:
+                case DEPTH32F_STENCIL8:
+                    return 8;
+                case RGB32F:
+                case RGB32I:
+                case RGB32UI:
+                    return 12;
+                case RGBA32F:
+                case RGBA32I:
+                case RGBA32UI:
+                    return 16;
+#endif
+                case RGB:
+                    return 3;
+                case RGBA:
+                    return 4;
+                default:
+                    return 4;
+            }
+        }
+
 #ifndef VBE_GLES2
 
         ///
@@ -301,6 +408,42 @@ class TextureFormat {
             return false;
         }
 
+        ///
+        /// \brief Returns wether the given format stores unnormalized integers
+        ///
+        inline static bool isInteger(Format f) {
+            switch(f) {
+                case R8I:
+                case R8UI:
+                case R16I:
+                case R16UI:
+                case R32I:
+                case R32UI:
+                case RG8I:
+                case RG8UI:
+                case RG16I:
+                case RG16UI:
+                case RG32I:
+                case RG32UI:
+                case RGB8I:
+                case RGB8UI:
+                case RGB16I:
+                case RGB16UI:
+                case RGB32I:
+                case RGB32UI:
+                case RGBA8I:
+                case RGBA8UI:
+                case RGBA16I:
+                case RGBA16UI:
+                case RGBA32I:
+                case RGBA32UI:
+                    return true;
+                default:
+                    return false;
+            }
+            return false;
+        }
+
         ///
         /// \brief Returns wether the given format is a base format or not
         ///
@@ -0,0 +1,114 @@
+#ifndef TEXTUREHANDLETABLE_HPP
+#define TEXTUREHANDLETABLE_HPP
+
+#include <map>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+// Bindless textures are not supported in GLES2
+#ifndef VBE_GLES2
+
+class Texture;
+class Sampler;
+
+///
+/// \brief TextureHandleTable is a shader storage buffer of bindless texture handles
+///
+class TextureHandleTable : public NonCopyable {
+    public:
+        ///
+        /// \brief Default constructor
+        ///
+        TextureHandleTable();
+
+        ///
+        /// \brief Destructor
+        ///
+        ~TextureHandleTable();
+
+        ///
+        /// \brief Adds a texture to the table and returns its index.
+        ///
+        /// Adding a texture that is already on the table returns the existing index.
+        ///
+        unsigned int add(const Texture& tex);
+
+        ///
+        /// \brief Adds a texture sampled with the given sampler to the table and returns its index.
+        ///
+        unsigned int add(const Texture& tex, const Sampler& sampler);
+
+        ///
+        /// \brief Replaces the texture at the given index
+        ///
+        void set(unsigned int index, const Texture& tex);
+
+        ///
+        /// \brief Replaces the texture at the given index, sampled with the given sampler
+        ///
+        void set(unsigned int index, const Texture& tex, const Sampler& sampler);
+
+        ///
+        /// \brief Removes all textures from the table. The handles stay resident.
+        ///
+        void clear();
+
+        ///
+        /// \brief Returns the number of entries in the table
+        ///
+        unsigned int size() const;
+
+        ///
+        /// \brief Uploads the table if it changed and binds it to the given shader storage binding point
+        ///
+        void bind(unsigned int bindingPoint) const;
+
+        ///
+        /// \brief Returns the OpenGL handle of the storage buffer
+        ///
+        GLuint getHandle() const;
+
+    private:
+        unsigned int add(GLuint64 handle);
+        void set(unsigned int index, GLuint64 handle);
+
+        GLuint buffer = 0;
+        mutable unsigned int bufferSize = 0; //in handles
+        mutable bool dirty = false;
+        std::vector<GLuint64> handles;
+        std::map<GLuint64, unsigned int> indices;
+};
+///
+/// \class TextureHandleTable TextureHandleTable.hpp <VBE/graphics/TextureHandleTable.hpp>
+/// \ingroup Graphics
+///
+/// Requires ARB_bindless_texture (see Texture::isBindlessSupported()). Each entry is the
+/// resident 64-bit handle of a texture, so a shader can pick any of them by index without
+/// the textures being bound to a slot. Combined with MeshBatched, the per-draw `draw_index`
+/// attribute (or a per-draw material index) selects the texture of each draw in the batch:
+/// ~~~{.cpp}
+/// TextureHandleTable table;
+/// unsigned int rock = table.add(rockTexture);
+/// unsigned int grass = table.add(grassTexture);
+/// ...
+/// table.bind(0);
+/// MeshBatched::startBatch();
+/// ...
+/// MeshBatched::endBatch();
+/// ~~~
+/// On the shader side the table is a std430 storage buffer of `uvec2`:
+/// ~~~{.glsl}
+/// #extension GL_ARB_bindless_texture : require
+/// layout(std430, binding = 0) readonly buffer TextureTable { uvec2 textures[]; };
+/// ...
+/// color = texture(sampler2D(textures[index]), uv);
+/// ~~~
+///
+/// \see Texture::getBindlessHandle()
+///
+
+#endif // VBE_GLES2
+#endif // TEXTUREHANDLETABLE_HPP
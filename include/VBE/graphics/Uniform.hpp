@@ -12,7 +12,9 @@ class Texture3D;
 class Texture2DArray;
 class TextureCubemap;
 class TextureCubemapArray;
+class Texture2DMultisample;
 class Texture;
+class Sampler;
 
 ///
 /// \brief The Uniform class represents an OpenGL ShaderProgram Uniform
@@ -243,6 +245,56 @@ class Uniform : public NonCopyable {
         ///
         void set(const TextureCubemapArray& val);
 
+        ///
+        /// \brief Set contents of the uniform
+        /// \param val Cannot be nullptr
+        ///
+        /// Uniform must be an 2D multisample sampler
+        ///
+        void set(const Texture2DMultisample* val);
+
+        ///
+        /// \brief Set contents of the uniform
+        ///
+        /// Uniform must be an 2D multisample sampler
+        ///
+        void set(const Texture2DMultisample& val);
+
+        ///
+        /// \brief Set contents of the uniform, sampling the texture with the given sampler
+        ///
+        /// Uniform must be an 2D sampler or a 2D shadow sampler
+        ///
+        void set(const Texture2D& val, const Sampler& sampler);
+
+        ///
+        /// \brief Set contents of the uniform, sampling the texture with the given sampler
+        ///
+        /// Uniform must be an 3D sampler
+        ///
+        void set(const Texture3D& val, const Sampler& sampler);
+
+        ///
+        /// \brief Set contents of the uniform, sampling the texture with the given sampler
+        ///
+        /// Uniform must be an 2D array sampler or a 2D array shadow sampler
+        ///
+        void set(const Texture2DArray& val, const Sampler& sampler);
+
+        ///
+        /// \brief Set contents of the uniform, sampling the texture with the given sampler
+        ///
+        /// Uniform must be an Cubemap sampler
+        ///
+        void set(const TextureCubemap& val, const Sampler& sampler);
+
+        ///
+        /// \brief Set contents of the uniform, sampling the texture with the given sampler
+        ///
+        /// Uniform must be an Cubemap array sampler
+        ///
+        void set(const TextureCubemapArray& val, const Sampler& sampler);
+
 #endif
 
         ///
@@ -23,7 +23,8 @@ namespace Vertex {
                 Float         = GL_FLOAT,
                 Fixed         = GL_FIXED,
 #ifndef VBE_GLES2
-                Double        = GL_DOUBLE
+                Double        = GL_DOUBLE,
+                HalfFloat     = GL_HALF_FLOAT
 #endif
             };
             inline bool isIntegerType(Type t) {
@@ -32,6 +33,7 @@ namespace Vertex {
                     case GL_FIXED:
 #ifndef VBE_GLES2
                     case GL_DOUBLE:
+                    case GL_HALF_FLOAT:
 #endif
                         return false;
                     default:
@@ -4,9 +4,11 @@
 ///
 #include <VBE/system/Clock.hpp>
 #include <VBE/system/ContextSettings.hpp>
+#include <VBE/system/FramePacer.hpp>
 #include <VBE/system/Keyboard.hpp>
 #include <VBE/system/Log.hpp>
 #include <VBE/system/Mouse.hpp>
+#include <VBE/system/Profiler.hpp>
 #include <VBE/system/Gamepad.hpp>
 #include <VBE/system/Storage.hpp>
 #include <VBE/system/Window.hpp>
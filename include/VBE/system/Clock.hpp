@@ -9,18 +9,24 @@ class Clock {
 
         ///
         /// \brief Gets the value of the clock in seconds.
-        /// The returned value increases by 1 every second. The origin
-        /// of the clock (the moment when it has the value 0) is unspecified.
+        /// The returned value increases by 1 every second. The clock starts
+        /// at 0 the first time any of its getters is called, so the float
+        /// keeps millisecond precision for the first two hours of the run.
         ///
         static float getSeconds();
         static long long getMicroseconds();
+        static long long getNanoseconds();
 
         ///
         /// \brief Sleeps for the specified amount of seconds.
         /// \param seconds The number of seconds to sleep
         ///
+        /// The thread sleeps for most of the interval and busy-waits the last
+        /// fraction of a millisecond, so it wakes up close to the requested time.
+        ///
         static void sleepSeconds(float seconds);
         static void sleepMicroseconds(long long useconds);
+        static void sleepNanoseconds(long long nseconds);
 };
 ///
 /// \class Clock Clock.hpp <VBE/system/Clock.hpp>
@@ -29,5 +35,8 @@ class Clock {
 /// With this class you can query the elapsed time since the application started
 /// and a you can also sleep the current thread for any amount of time.
 ///
+/// The clock is monotonic and backed by the highest resolution counter of the
+/// platform.
+///
 
 #endif // CLOCK_HPP
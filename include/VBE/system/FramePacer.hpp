@@ -0,0 +1,149 @@
+#ifndef FRAMEPACER_HPP
+#define FRAMEPACER_HPP
+
+#include <vector>
+
+#include <VBE/utils/NonCopyable.hpp>
+
+class Window;
+
+///
+/// \brief FramePacer limits the frame rate and measures how evenly frames are delivered
+///
+class FramePacer : public NonCopyable {
+    public:
+        ///
+        /// \brief Frame timings over the last getHistorySize() frames, in milliseconds
+        ///
+        struct Stats {
+                unsigned int frames = 0; ///< Number of frames in the history
+                float average = 0.0f; ///< Average time between frames
+                float min = 0.0f; ///< Shortest time between frames
+                float max = 0.0f; ///< Longest time between frames
+                float p50 = 0.0f; ///< Median time between frames
+                float p95 = 0.0f; ///< 95th percentile of the time between frames
+                float p99 = 0.0f; ///< 99th percentile of the time between frames
+                float work = 0.0f; ///< Average time spent between waking up and presenting
+                float sleep = 0.0f; ///< Average time spent sleeping in wait()
+                float swap = 0.0f; ///< Average time spent in Window::swapBuffers()
+                unsigned long long missedDeadlines = 0; ///< Frames presented after their deadline since the last reset()
+        };
+
+        ///
+        /// \brief Constructor
+        ///
+        /// \param targetFrameRate Frames per second to aim for. Zero disables pacing.
+        /// \param historySize Number of frames kept for the statistics
+        ///
+        FramePacer(float targetFrameRate = 60.0f, unsigned int historySize = 240);
+
+        ///
+        /// \brief Sets the frames per second to aim for. Zero disables pacing.
+        ///
+        void setTargetFrameRate(float fps);
+
+        ///
+        /// \brief Returns the frames per second the pacer aims for
+        ///
+        float getTargetFrameRate() const;
+
+        ///
+        /// \brief Sleeps until the next frame should start. Call at the start of every frame.
+        ///
+        /// The pacer predicts how long the frame is going to take from the cost of the
+        /// previous ones and wakes up just in time for it to finish on its deadline, so the
+        /// frame is built with input as recent as possible.
+        ///
+        void wait();
+
+        ///
+        /// \brief Presents the frame through the window, timing the swap, and ends the frame
+        ///
+        void swapBuffers(const Window& window);
+
+        ///
+        /// \brief Ends the frame. Only needed when the buffers are not swapped through swapBuffers().
+        ///
+        void endFrame();
+
+        ///
+        /// \brief Returns the statistics over the frame history
+        ///
+        Stats getStats() const;
+
+        ///
+        /// \brief Returns the given percentile (0 to 100) of the time between frames, in milliseconds
+        ///
+        float getPercentile(float percentile) const;
+
+        ///
+        /// \brief Returns a histogram of the time between frames.
+        ///
+        /// \param bucketWidth Width of every bucket, in milliseconds
+        /// \param buckets Number of buckets. The last one also counts all the longer frames.
+        ///
+        std::vector<unsigned int> getHistogram(float bucketWidth, unsigned int buckets) const;
+
+        ///
+        /// \brief Returns the predicted cost of the next frame, in milliseconds
+        ///
+        float getPredictedCost() const;
+
+        ///
+        /// \brief Returns the number of frames kept for the statistics
+        ///
+        unsigned int getHistorySize() const;
+
+        ///
+        /// \brief Clears the statistics and the missed deadline count
+        ///
+        void reset();
+
+    private:
+        struct Frame {
+                long long interval = 0;
+                long long work = 0;
+                long long sleep = 0;
+                long long swap = 0;
+        };
+
+        const unsigned int historySize;
+        std::vector<Frame> history;
+        unsigned int historyNext = 0;
+        long long period = 0;
+        long long deadline = 0;
+        long long lastPresent = 0;
+        long long frameStart = 0;
+        long long sleepTime = 0;
+        long long swapTime = 0;
+        long long costMean = 0;
+        long long costDeviation = 0;
+        unsigned long long missedDeadlines = 0;
+};
+///
+/// \class FramePacer FramePacer.hpp <VBE/system/FramePacer.hpp>
+/// \ingroup System
+///
+/// Without VSync the main loop renders as fast as it can, burning a whole core and
+/// presenting frames at uneven intervals. The pacer sleeps the thread so frames are
+/// presented at a steady rate:
+///
+/// ~~~{.cpp}
+/// FramePacer pacer(60.0f);
+/// while(!window.isClosing()) {
+///     pacer.wait();
+///     window.update();
+///     render();
+///     pacer.swapBuffers(window);
+/// }
+/// FramePacer::Stats s = pacer.getStats();
+/// Log::message() << "p99 " << s.p99 << "ms, missed " << s.missedDeadlines << Log::Flush;
+/// ~~~
+///
+/// The frame cost prediction is a running average plus twice the running deviation of
+/// the time between waking up and presenting. A frame that is presented after its
+/// deadline counts as a missed deadline. After a long stall the deadlines restart from
+/// the current time instead of rushing to catch up.
+///
+
+#endif // FRAMEPACER_HPP
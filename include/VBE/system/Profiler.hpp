@@ -0,0 +1,164 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <VBE/config.hpp>
+
+// The profiler only exists when VBE_PROFILER is defined. Otherwise the zones
+// expand to nothing and leave no trace in the binary.
+#ifdef VBE_PROFILER
+
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <VBE/utils/NonCopyable.hpp>
+
+#define VBE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VBE_PROFILE_CONCAT(a, b) VBE_PROFILE_CONCAT_IMPL(a, b)
+#define VBE_PROFILE_ZONE(name) Profiler::Zone VBE_PROFILE_CONCAT(vbeProfileZone, __LINE__)(name)
+#define VBE_PROFILE_THREAD(name) Profiler::setThreadName(name)
+
+///
+/// \brief Profiler records how long the CPU spends in named zones of code
+///
+class Profiler {
+    public:
+        ///
+        /// \brief Times the enclosing scope. Use through VBE_PROFILE_ZONE.
+        ///
+        class Zone : public NonCopyable {
+            public:
+                Zone(const char* name) {Profiler::begin(name);}
+                ~Zone() {Profiler::end();}
+        };
+
+        ///
+        /// \brief Aggregated timings of every zone with the same name, in milliseconds
+        ///
+        struct ZoneStats {
+                std::string name; ///< Name of the zone
+                unsigned long long calls = 0; ///< Number of times it was entered
+                double total = 0.0; ///< Total time, including nested zones
+                double self = 0.0; ///< Total time, excluding nested zones
+                double min = 0.0; ///< Shortest time
+                double avg = 0.0; ///< Average time
+                double max = 0.0; ///< Longest time
+        };
+
+        ///
+        /// \brief Opens a zone on the calling thread. The name must outlive the profiler, a string literal is best.
+        ///
+        static void begin(const char* name);
+
+        ///
+        /// \brief Closes the innermost open zone of the calling thread
+        ///
+        static void end();
+
+        ///
+        /// \brief Names the calling thread in the exported traces
+        ///
+        static void setThreadName(const char* name);
+
+        ///
+        /// \brief Sets how many zones every thread keeps. Only affects threads that record their first zone afterwards.
+        ///
+        /// Defaults to 65536. Older zones are overwritten once a thread buffer is full.
+        ///
+        static void setThreadCapacity(unsigned int zones);
+
+        ///
+        /// \brief Returns the timings of every recorded zone of every thread, sorted by name
+        ///
+        static std::vector<ZoneStats> getSummary();
+
+        ///
+        /// \brief Writes the summary as a table, one zone per line
+        ///
+        static void writeSummary(std::ostream& out);
+
+        ///
+        /// \brief Writes all the recorded zones in the Chrome trace event format
+        ///
+        /// Open the result with chrome://tracing or Perfetto. Scopes measured by the
+        /// GpuProfiler are exported too, on their own track.
+        ///
+        static void writeChromeTrace(std::ostream& out);
+
+        ///
+        /// \brief Forgets all the zones recorded so far
+        ///
+        static void clear();
+
+    private:
+        Profiler();
+
+        struct Event {
+                const char* name;
+                long long begin;
+                long long end;
+                long long self;
+                unsigned int depth;
+        };
+
+        struct Open {
+                const char* name;
+                long long begin;
+                long long children;
+        };
+
+        struct ThreadBuffer {
+                ThreadBuffer(unsigned int id, unsigned int capacity) : id(id), events(capacity) {}
+                const unsigned int id;
+                std::string name;
+                std::vector<Event> events; // Ring, only written by its thread
+                std::vector<Open> open; // Only touched by its thread
+                std::atomic<unsigned long long> count{0}; // Events ever written
+                std::atomic<unsigned long long> start{0}; // First event not cleared
+        };
+
+        static ThreadBuffer* getThreadBuffer();
+        static void collect(ThreadBuffer& buffer, std::vector<Event>& out);
+
+        static std::atomic<unsigned int> capacity;
+        static std::mutex threadsMutex; // Guards the list, never taken while recording
+        static std::vector<ThreadBuffer*> threads;
+        static thread_local ThreadBuffer* threadBuffer;
+};
+///
+/// \class Profiler Profiler.hpp <VBE/system/Profiler.hpp>
+/// \ingroup System
+///
+/// Define VBE_PROFILER when building both VBE and the application to enable it.
+/// Zones are recorded into a buffer owned by each thread, without locks, so they are
+/// cheap enough for hot paths. VBE itself marks a few of them, like
+/// MeshBatched::endBatch(), ShaderProgram::use(), Texture::bind(), the OBJLoader and
+/// Image::load().
+///
+/// ~~~{.cpp}
+/// void World::update(float deltaTime) {
+///     VBE_PROFILE_ZONE("World::update");
+///     {
+///         VBE_PROFILE_ZONE("physics");
+///         ...
+///     }
+/// }
+///
+/// std::ofstream trace("trace.json");
+/// Profiler::writeChromeTrace(trace);
+/// ~~~
+///
+/// Summaries and traces can be taken while other threads keep recording. Zones that
+/// are overwritten while being read are skipped.
+///
+
+#else
+
+#define VBE_PROFILE_ZONE(name)
+#define VBE_PROFILE_THREAD(name)
+
+#endif // VBE_PROFILER
+
+#endif // PROFILER_HPP
@@ -0,0 +1,281 @@
+#include <algorithm>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/FrameGraph.hpp>
+#include <VBE/graphics/GpuProfiler.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/system/Log.hpp>
+
+FrameGraph::Resource FrameGraph::Builder::create(vec2ui size, TextureFormat::Format format) {
+    VBE_ASSERT(size.x != 0 && size.y != 0, "Transient texture size can't be zero");
+    ResourceNode r;
+    r.size = size;
+    r.format = format;
+    graph.resources.push_back(r);
+    return graph.resources.size() - 1;
+}
+
+void FrameGraph::Builder::read(Resource r) {
+    VBE_ASSERT(r < graph.resources.size(), "Invalid frame graph resource " << r);
+    graph.passes[pass].reads.push_back(r);
+}
+
+void FrameGraph::Builder::write(Resource r, RenderTargetBase::Attachment a) {
+    VBE_ASSERT(r < graph.resources.size(), "Invalid frame graph resource " << r);
+    PassNode& p = graph.passes[pass];
+#ifdef VBE_DEBUG
+    for(const std::pair<RenderTargetBase::Attachment, Resource>& w : p.writes)
+        VBE_ASSERT(w.first != a, "Pass " << p.name << " writes twice to the same attachment");
+#endif
+    p.writes.push_back(std::pair<RenderTargetBase::Attachment, Resource>(a, r));
+    graph.resources[r].producers.push_back(pass);
+}
+
+void FrameGraph::Builder::setSideEffects() {
+    graph.passes[pass].sideEffects = true;
+}
+
+FrameGraph::FrameGraph() {
+}
+
+FrameGraph::~FrameGraph() {
+    clearPool();
+}
+
+void FrameGraph::addPass(const std::string& name, Setup setup, Execute execute) {
+    PassNode p;
+    p.name = name;
+    p.execute = execute;
+    passes.push_back(p);
+    Builder builder(*this, passes.size() - 1);
+    setup(builder);
+    // Nothing to cull against when the pass renders straight to the screen
+    if(passes.back().writes.empty()) passes.back().sideEffects = true;
+    compiled = false;
+}
+
+FrameGraph::Resource FrameGraph::import(Texture2D* tex) {
+    VBE_ASSERT(tex != nullptr, "Imported texture cannot be nullptr");
+    ResourceNode r;
+    r.size = tex->getSize();
+    r.format = tex->getFormat();
+    r.texture = tex;
+    r.imported = true;
+    resources.push_back(r);
+    compiled = false;
+    return resources.size() - 1;
+}
+
+void FrameGraph::compile() {
+    // Reference counts: passes count their writes, resources count their readers.
+    // Imported resources are read from outside the graph, so they are always referenced.
+    for(ResourceNode& r : resources) {
+        r.refCount = r.imported ? 1 : 0;
+        r.firstUse = -1;
+        r.lastUse = -1;
+    }
+    for(PassNode& p : passes) {
+        p.refCount = p.writes.size();
+        for(Resource r : p.reads) resources[r].refCount++;
+    }
+
+    // Cull: unreferenced resources release their producers, which release what they read
+    std::vector<Resource> unreferenced;
+    for(Resource r = 0; r < resources.size(); ++r)
+        if(resources[r].refCount == 0) unreferenced.push_back(r);
+    while(!unreferenced.empty()) {
+        Resource r = unreferenced.back();
+        unreferenced.pop_back();
+        for(unsigned int producer : resources[r].producers) {
+            PassNode& p = passes[producer];
+            if(p.sideEffects || p.refCount == 0) continue;
+            if(--p.refCount > 0) continue;
+            for(Resource read : p.reads)
+                if(--resources[read].refCount == 0) unreferenced.push_back(read);
+        }
+    }
+
+    // Lifetimes of the transient resources used by the remaining passes
+    for(unsigned int i = 0; i < passes.size(); ++i) {
+        PassNode& p = passes[i];
+        p.culled = (p.refCount == 0 && !p.sideEffects);
+        if(p.culled) continue;
+        std::vector<Resource> used = p.reads;
+        for(const std::pair<RenderTargetBase::Attachment, Resource>& w : p.writes) used.push_back(w.second);
+        for(Resource r : used) {
+            ResourceNode& n = resources[r];
+            if(n.firstUse == -1) n.firstUse = i;
+            n.lastUse = i;
+        }
+    }
+#ifdef VBE_DEBUG
+    for(unsigned int i = 0; i < passes.size(); ++i)
+        for(Resource r : passes[i].reads)
+            VBE_ASSERT(passes[i].culled || resources[r].imported || resources[r].firstUse < int(i),
+                       "Pass " << passes[i].name << " reads a transient texture that no earlier pass writes");
+#endif
+    compiled = true;
+}
+
+void FrameGraph::execute() {
+    if(!compiled) compile();
+    const RenderTargetBase* previous = RenderTargetBase::getCurrent();
+
+    for(unsigned int i = 0; i < passes.size(); ++i) {
+        const PassNode& p = passes[i];
+        if(p.culled) continue;
+
+        for(const std::pair<RenderTargetBase::Attachment, Resource>& w : p.writes) {
+            ResourceNode& r = resources[w.second];
+            if(!r.imported && r.firstUse == int(i))
+                r.texture = acquire(r.size, r.format);
+        }
+
+        if(p.writes.empty())
+            RenderTargetBase::bind(nullptr);
+        else
+            RenderTargetBase::bind(getTarget(p));
+
+#ifndef VBE_GLES2
+        {
+            GpuProfiler::Scope scope(p.name);
+            p.execute(*this);
+        }
+#else
+        p.execute(*this);
+#endif
+
+#ifndef VBE_GLES2
+        // The contents of transient attachments nobody reads later don't need to reach memory
+        std::vector<GLenum> invalidate;
+        for(const std::pair<RenderTargetBase::Attachment, Resource>& w : p.writes) {
+            const ResourceNode& r = resources[w.second];
+            if(!r.imported && r.lastUse == int(i)) invalidate.push_back(w.first);
+        }
+        if(!invalidate.empty())
+            GL_ASSERT(glInvalidateFramebuffer(GL_FRAMEBUFFER, invalidate.size(), &invalidate[0]));
+#endif
+
+        // Give back the textures whose lifetime ends here, later passes can alias them
+        std::vector<Resource> used = p.reads;
+        for(const std::pair<RenderTargetBase::Attachment, Resource>& w : p.writes) used.push_back(w.second);
+        for(Resource id : used) {
+            ResourceNode& r = resources[id];
+            if(r.imported || r.lastUse != int(i) || r.texture == nullptr) continue;
+            release(r.texture);
+            r.texture = nullptr;
+        }
+    }
+
+    ++frame;
+    trimPool();
+    RenderTargetBase::bind(previous);
+}
+
+void FrameGraph::reset() {
+    passes.clear();
+    resources.clear();
+    compiled = false;
+}
+
+Texture2D* FrameGraph::getTexture(Resource r) const {
+    VBE_ASSERT(r < resources.size(), "Invalid frame graph resource " << r);
+    VBE_ASSERT(resources[r].texture != nullptr, "Frame graph resource " << r << " is not alive at this point");
+    return resources[r].texture;
+}
+
+bool FrameGraph::isCulled(const std::string& name) const {
+    for(const PassNode& p : passes)
+        if(p.name == name) return p.culled;
+    VBE_ASSERT(false, "No pass named " << name);
+    return false;
+}
+
+void FrameGraph::setMaxIdleFrames(unsigned int frames) {
+    maxIdleFrames = frames;
+}
+
+void FrameGraph::clearPool() {
+    for(std::pair<const TargetKey, RenderTarget*>& t : targets) delete t.second;
+    targets.clear();
+    for(PooledTexture& t : pool) {
+        VBE_ASSERT(!t.inUse, "Can't clear the frame graph pool while executing");
+        delete t.texture;
+    }
+    pool.clear();
+}
+
+unsigned int FrameGraph::getPoolSize() const {
+    return pool.size();
+}
+
+unsigned long long FrameGraph::getPoolMemory() const {
+    unsigned long long bytes = 0;
+    for(const PooledTexture& t : pool) bytes += t.texture->getEstimatedMemory();
+    return bytes;
+}
+
+Texture2D* FrameGraph::acquire(vec2ui size, TextureFormat::Format format) {
+    for(PooledTexture& t : pool) {
+        if(t.inUse || t.format != format || t.texture->getSize() != size) continue;
+        t.inUse = true;
+        t.lastFrame = frame;
+        return t.texture;
+    }
+    PooledTexture t;
+    t.texture = new Texture2D(size, format);
+    t.format = format;
+    t.lastFrame = frame;
+    t.inUse = true;
+    pool.push_back(t);
+    return t.texture;
+}
+
+void FrameGraph::release(Texture2D* tex) {
+    for(PooledTexture& t : pool)
+        if(t.texture == tex) t.inUse = false;
+}
+
+RenderTarget* FrameGraph::getTarget(const PassNode& pass) {
+    TargetKey key;
+    for(const std::pair<RenderTargetBase::Attachment, Resource>& w : pass.writes)
+        key.push_back(TargetKey::value_type(w.first, resources[w.second].texture));
+    std::sort(key.begin(), key.end());
+
+    std::map<TargetKey, RenderTarget*>::iterator it = targets.find(key);
+    if(it != targets.end()) return it->second;
+
+    vec2ui size = key[0].second->getSize();
+    RenderTarget* target = new RenderTarget(size.x, size.y);
+    for(const TargetKey::value_type& a : key) {
+        VBE_ASSERT(a.second->getSize() == size, "All the attachments of pass " << pass.name << " must have the same size");
+        target->setTexture(a.first, a.second);
+    }
+    targets.insert(std::pair<TargetKey, RenderTarget*>(key, target));
+    return target;
+}
+
+void FrameGraph::trimPool() {
+    std::vector<PooledTexture>::iterator last = std::partition(pool.begin(), pool.end(), [this](const PooledTexture& t) {
+        return t.inUse || frame - t.lastFrame <= maxIdleFrames;
+    });
+    if(last == pool.end()) return;
+
+    // Drop the framebuffers that use any of the freed textures
+    for(std::vector<PooledTexture>::iterator t = last; t != pool.end(); ++t) {
+        std::map<TargetKey, RenderTarget*>::iterator it = targets.begin();
+        while(it != targets.end()) {
+            bool uses = false;
+            for(const TargetKey::value_type& a : it->first) uses = uses || a.second == t->texture;
+            if(uses) {
+                if(RenderTargetBase::getCurrent() == it->second) RenderTargetBase::bind(nullptr);
+                delete it->second;
+                targets.erase(it++);
+            }
+            else
+                ++it;
+        }
+        delete t->texture;
+    }
+    pool.erase(last, pool.end());
+}
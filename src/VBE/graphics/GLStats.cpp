@@ -0,0 +1,453 @@
+// This file calls the real GL entry points
+#define VBE_GL_STATS_IMPL
+
+#include <ostream>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/GLStats.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+
+#ifdef VBE_GL_STATS
+
+namespace {
+    unsigned int componentCount(GLenum format) {
+        switch(format) {
+            case GL_ALPHA:
+            case GL_LUMINANCE:
+            case GL_DEPTH_COMPONENT:
+#ifndef VBE_GLES2
+            case GL_RED:
+            case GL_RED_INTEGER:
+            case GL_STENCIL_INDEX:
+#endif
+                return 1;
+            case GL_LUMINANCE_ALPHA:
+#ifndef VBE_GLES2
+            case GL_RG:
+            case GL_RG_INTEGER:
+            case GL_DEPTH_STENCIL:
+#endif
+                return 2;
+            case GL_RGB:
+#ifndef VBE_GLES2
+            case GL_BGR:
+            case GL_RGB_INTEGER:
+#endif
+                return 3;
+            default:
+                return 4;
+        }
+    }
+
+    // Size of a whole pixel with the given client format and type
+    unsigned int pixelSize(GLenum format, GLenum type) {
+        switch(type) {
+            case GL_UNSIGNED_SHORT_5_6_5:
+            case GL_UNSIGNED_SHORT_4_4_4_4:
+            case GL_UNSIGNED_SHORT_5_5_5_1:
+                return 2;
+#ifndef VBE_GLES2
+            case GL_UNSIGNED_INT_24_8:
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+            case GL_UNSIGNED_INT_10F_11F_11F_REV:
+            case GL_UNSIGNED_INT_5_9_9_9_REV:
+                return 4;
+            case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+                return 8;
+            case GL_HALF_FLOAT:
+#endif
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+                return 2*componentCount(format);
+            case GL_INT:
+            case GL_UNSIGNED_INT:
+            case GL_FLOAT:
+                return 4*componentCount(format);
+            default:
+                return componentCount(format);
+        }
+    }
+}
+
+// static
+GLStats::FrameStats GLStats::current;
+GLStats::FrameStats GLStats::last;
+bool GLStats::programKnown = false;
+GLuint GLStats::program = 0;
+GLenum GLStats::activeUnit = GL_TEXTURE0;
+std::map<GLenum, std::map<GLenum, GLuint>> GLStats::textures;
+std::map<GLenum, GLuint> GLStats::buffers;
+std::map<GLenum, GLuint> GLStats::framebuffers;
+std::map<GLenum, GLuint> GLStats::vertexArrays;
+
+// static
+void GLStats::newFrame() {
+    last = current;
+    current = FrameStats();
+}
+
+// static
+const GLStats::FrameStats& GLStats::getFrameStats() {
+    return last;
+}
+
+// static
+const GLStats::FrameStats& GLStats::getCurrentStats() {
+    return current;
+}
+
+// static
+void GLStats::writeFrameStats(std::ostream& out) {
+    out << "calls: " << last.calls << "\n"
+        << "draw calls: " << last.drawCalls << " (" << last.vertices << " vertices)\n"
+        << "buffer uploads: " << last.bufferUploads << " (" << last.bufferBytes << " bytes)\n"
+        << "texture uploads: " << last.textureUploads << " (" << last.textureBytes << " bytes)\n"
+        << "uniform uploads: " << last.uniformUploads << "\n"
+        << "program binds: " << last.programBinds << " (" << last.redundantProgramBinds << " redundant)\n"
+        << "texture binds: " << last.textureBinds << " (" << last.redundantTextureBinds << " redundant)\n"
+        << "vertex array binds: " << last.vertexArrayBinds << " (" << last.redundantVertexArrayBinds << " redundant)\n"
+        << "buffer binds: " << last.bufferBinds << " (" << last.redundantBufferBinds << " redundant)\n"
+        << "framebuffer binds: " << last.framebufferBinds << " (" << last.redundantFramebufferBinds << " redundant)\n";
+}
+
+// static
+void GLStats::resetState() {
+    programKnown = false;
+    activeUnit = GL_TEXTURE0;
+    textures.clear();
+    buffers.clear();
+    framebuffers.clear();
+    vertexArrays.clear();
+}
+
+// static
+bool GLStats::bind(std::map<GLenum, GLuint>& bindings, GLenum target, GLuint value) {
+    std::map<GLenum, GLuint>::iterator it = bindings.find(target);
+    if(it != bindings.end() && it->second == value) return true;
+    bindings[target] = value;
+    return false;
+}
+
+// static
+void GLStats::unbind(std::map<GLenum, GLuint>& bindings, GLsizei n, const GLuint* names) {
+    // Deleting a bound object resets its binding to zero
+    for(std::pair<const GLenum, GLuint>& b : bindings)
+        for(GLsizei i = 0; i < n; ++i)
+            if(b.second == names[i]) b.second = 0;
+}
+
+// static
+void GLStats::textureUpload(GLsizei texels, GLenum format, GLenum type, const GLvoid* pixels) {
+    // With a pixel unpack buffer bound the pointer is an offset, and may be zero
+#ifndef VBE_GLES2
+    std::map<GLenum, GLuint>::const_iterator unpack = buffers.find(GL_PIXEL_UNPACK_BUFFER);
+    if(pixels == nullptr && (unpack == buffers.end() || unpack->second == 0)) return;
+#else
+    if(pixels == nullptr) return;
+#endif
+    current.textureUploads++;
+    current.textureBytes += (unsigned long long) texels*pixelSize(format, type);
+}
+
+// static
+void GLStats::drawArrays(GLenum mode, GLint first, GLsizei count) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += count;
+    glDrawArrays(mode, first, count);
+}
+
+// static
+void GLStats::drawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += count;
+    glDrawElements(mode, count, type, indices);
+}
+
+// static
+void GLStats::bufferData(GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) {
+    current.calls++;
+    if(data != nullptr) {
+        current.bufferUploads++;
+        current.bufferBytes += size;
+    }
+    glBufferData(target, size, data, usage);
+}
+
+// static
+void GLStats::bufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) {
+    current.calls++;
+    current.bufferUploads++;
+    current.bufferBytes += size;
+    glBufferSubData(target, offset, size, data);
+}
+
+// static
+void GLStats::texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+    current.calls++;
+    textureUpload(width*height, format, type, pixels);
+    glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+// static
+void GLStats::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid* pixels) {
+    current.calls++;
+    textureUpload(width*height, format, type, pixels);
+    glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+}
+
+// static
+void GLStats::useProgram(GLuint p) {
+    current.calls++;
+    current.programBinds++;
+    if(programKnown && program == p) current.redundantProgramBinds++;
+    programKnown = true;
+    program = p;
+    glUseProgram(p);
+}
+
+// static
+void GLStats::deleteProgram(GLuint p) {
+    // A program in use stays bound until another one is used, so the binding is kept
+    current.calls++;
+    glDeleteProgram(p);
+}
+
+// static
+void GLStats::activeTexture(GLenum unit) {
+    current.calls++;
+    activeUnit = unit;
+    glActiveTexture(unit);
+}
+
+// static
+void GLStats::bindTexture(GLenum target, GLuint texture) {
+    current.calls++;
+    current.textureBinds++;
+    if(bind(textures[activeUnit], target, texture)) current.redundantTextureBinds++;
+    glBindTexture(target, texture);
+}
+
+// static
+void GLStats::deleteTextures(GLsizei n, const GLuint* names) {
+    current.calls++;
+    for(std::pair<const GLenum, std::map<GLenum, GLuint>>& unit : textures)
+        unbind(unit.second, n, names);
+    glDeleteTextures(n, names);
+}
+
+// static
+void GLStats::bindBuffer(GLenum target, GLuint buffer) {
+    current.calls++;
+    current.bufferBinds++;
+    if(bind(buffers, target, buffer)) current.redundantBufferBinds++;
+    glBindBuffer(target, buffer);
+}
+
+// static
+void GLStats::deleteBuffers(GLsizei n, const GLuint* names) {
+    current.calls++;
+    unbind(buffers, n, names);
+    glDeleteBuffers(n, names);
+}
+
+// static
+void GLStats::bindFramebuffer(GLenum target, GLuint framebuffer) {
+    current.calls++;
+    current.framebufferBinds++;
+#ifndef VBE_GLES2
+    if(target == GL_FRAMEBUFFER) {
+        // Sets both the draw and the read framebuffer
+        bool draw = bind(framebuffers, GL_DRAW_FRAMEBUFFER, framebuffer);
+        bool read = bind(framebuffers, GL_READ_FRAMEBUFFER, framebuffer);
+        if(draw && read) current.redundantFramebufferBinds++;
+    }
+    else
+#endif
+    if(bind(framebuffers, target, framebuffer)) current.redundantFramebufferBinds++;
+    glBindFramebuffer(target, framebuffer);
+}
+
+// static
+void GLStats::deleteFramebuffers(GLsizei n, const GLuint* names) {
+    current.calls++;
+    unbind(framebuffers, n, names);
+    glDeleteFramebuffers(n, names);
+}
+
+// static
+void GLStats::uniform1i(GLint location, GLint v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform1i(location, v);
+}
+
+// static
+void GLStats::uniform1f(GLint location, GLfloat v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform1f(location, v);
+}
+
+// static
+void GLStats::uniform1iv(GLint location, GLsizei count, const GLint* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform1iv(location, count, v);
+}
+
+// static
+void GLStats::uniform2iv(GLint location, GLsizei count, const GLint* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform2iv(location, count, v);
+}
+
+// static
+void GLStats::uniform3iv(GLint location, GLsizei count, const GLint* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform3iv(location, count, v);
+}
+
+// static
+void GLStats::uniform4iv(GLint location, GLsizei count, const GLint* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform4iv(location, count, v);
+}
+
+// static
+void GLStats::uniform1fv(GLint location, GLsizei count, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform1fv(location, count, v);
+}
+
+// static
+void GLStats::uniform2fv(GLint location, GLsizei count, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform2fv(location, count, v);
+}
+
+// static
+void GLStats::uniform3fv(GLint location, GLsizei count, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform3fv(location, count, v);
+}
+
+// static
+void GLStats::uniform4fv(GLint location, GLsizei count, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniform4fv(location, count, v);
+}
+
+// static
+void GLStats::uniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniformMatrix3fv(location, count, transpose, v);
+}
+
+// static
+void GLStats::uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* v) {
+    current.calls++;
+    current.uniformUploads++;
+    glUniformMatrix4fv(location, count, transpose, v);
+}
+
+#ifndef VBE_GLES2
+// static
+void GLStats::drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += (unsigned long long) count*instances;
+    glDrawArraysInstanced(mode, first, count, instances);
+}
+
+// static
+void GLStats::drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instances) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += (unsigned long long) count*instances;
+    glDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+// static
+void GLStats::drawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLint baseVertex) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += count;
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+// static
+void GLStats::drawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const GLvoid* indices, GLsizei instances, GLint baseVertex) {
+    current.calls++;
+    current.drawCalls++;
+    current.vertices += (unsigned long long) count*instances;
+    glDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+}
+
+// static
+void GLStats::multiDrawArraysIndirect(GLenum mode, const GLvoid* indirect, GLsizei drawCount, GLsizei stride) {
+    // The vertex counts live in a GPU buffer, so they are not counted
+    current.calls++;
+    current.drawCalls += drawCount;
+    glMultiDrawArraysIndirect(mode, indirect, drawCount, stride);
+}
+
+// static
+void GLStats::multiDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid* indirect, GLsizei drawCount, GLsizei stride) {
+    current.calls++;
+    current.drawCalls += drawCount;
+    glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+}
+
+// static
+void GLStats::texImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const GLvoid* pixels) {
+    current.calls++;
+    textureUpload(width*height*depth, format, type, pixels);
+    glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+}
+
+// static
+void GLStats::texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const GLvoid* pixels) {
+    current.calls++;
+    textureUpload(width*height*depth, format, type, pixels);
+    glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+// static
+void GLStats::bindVertexArray(GLuint array) {
+    current.calls++;
+    current.vertexArrayBinds++;
+    if(bind(vertexArrays, GL_VERTEX_ARRAY, array))
+        current.redundantVertexArrayBinds++;
+    else
+        buffers.erase(GL_ELEMENT_ARRAY_BUFFER); // Part of the vertex array state
+    glBindVertexArray(array);
+}
+
+// static
+void GLStats::deleteVertexArrays(GLsizei n, const GLuint* names) {
+    current.calls++;
+    unbind(vertexArrays, n, names);
+    buffers.erase(GL_ELEMENT_ARRAY_BUFFER);
+    glDeleteVertexArrays(n, names);
+}
+
+// static
+void GLStats::bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    // Also binds the buffer to the generic binding point of the target
+    current.calls++;
+    buffers[target] = buffer;
+    glBindBufferBase(target, index, buffer);
+}
+#endif
+
+#endif // VBE_GL_STATS
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/GpuProfiler.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/system/Clock.hpp>
+#include <VBE/system/Log.hpp>
+
+// Timer queries are not supported in GLES2
+#ifndef VBE_GLES2
+
+// static
+bool GpuProfiler::enabled = false;
+unsigned int GpuProfiler::maxLatency = 4;
+unsigned int GpuProfiler::maxEvents = 1024;
+unsigned long long GpuProfiler::frameIndex = 0;
+long long GpuProfiler::clockOffset = 0;
+std::vector<GLuint> GpuProfiler::freeQueries;
+std::vector<unsigned int> GpuProfiler::open;
+GpuProfiler::Frame GpuProfiler::recording;
+std::deque<GpuProfiler::Frame> GpuProfiler::inFlight;
+std::vector<GpuProfiler::Stats> GpuProfiler::stats;
+std::map<std::string, unsigned int> GpuProfiler::statsIndex;
+std::deque<GpuProfiler::Event> GpuProfiler::events;
+
+// static
+bool GpuProfiler::isSupported() {
+    return GLEW_ARB_timer_query;
+}
+
+// static
+void GpuProfiler::setEnabled(bool e) {
+    if(e == enabled) return;
+    if(e) {
+        VBE_ASSERT(isSupported(), "ARB_timer_query is not supported");
+        calibrate();
+    }
+    else {
+        discard(recording);
+        for(Frame& f : inFlight) discard(f);
+        inFlight.clear();
+        open.clear();
+    }
+    enabled = e;
+}
+
+// static
+bool GpuProfiler::isEnabled() {
+    return enabled;
+}
+
+// static
+void GpuProfiler::begin(const std::string& name) {
+    if(!enabled) return;
+    std::map<std::string, unsigned int>::iterator it = statsIndex.find(name);
+    if(it == statsIndex.end()) {
+        Stats s;
+        s.name = name;
+        stats.push_back(s);
+        it = statsIndex.insert(std::pair<std::string, unsigned int>(name, stats.size() - 1)).first;
+    }
+    Measure m;
+    m.name = it->second;
+    m.depth = open.size();
+    m.begin = acquireQuery();
+    GL_ASSERT(glQueryCounter(m.begin, GL_TIMESTAMP));
+    recording.last = m.begin;
+    open.push_back(recording.measures.size());
+    recording.measures.push_back(m);
+}
+
+// static
+void GpuProfiler::end() {
+    if(!enabled) return;
+    VBE_ASSERT(!open.empty(), "GpuProfiler::end called without a matching begin");
+    Measure& m = recording.measures[open.back()];
+    open.pop_back();
+    m.end = acquireQuery();
+    GL_ASSERT(glQueryCounter(m.end, GL_TIMESTAMP));
+    recording.last = m.end;
+}
+
+// static
+void GpuProfiler::newFrame() {
+    if(!enabled) return;
+    VBE_ASSERT(open.empty(), "GpuProfiler::newFrame called with " << open.size() << " scopes still open");
+    if(!recording.measures.empty()) {
+        inFlight.push_back(Frame());
+        std::swap(inFlight.back(), recording);
+    }
+    recording.index = ++frameIndex;
+
+    while(!inFlight.empty()) {
+        GLuint available = GL_FALSE;
+        // Too far behind: wait for the oldest frame so the query pool can't grow forever
+        if(inFlight.size() <= maxLatency)
+            GL_ASSERT(glGetQueryObjectuiv(inFlight.front().last, GL_QUERY_RESULT_AVAILABLE, &available));
+        if(available == GL_FALSE && inFlight.size() <= maxLatency) break;
+        collect(inFlight.front());
+        inFlight.pop_front();
+    }
+}
+
+// static
+void GpuProfiler::setMaxLatency(unsigned int frames) {
+    maxLatency = frames;
+}
+
+// static
+unsigned int GpuProfiler::getMaxLatency() {
+    return maxLatency;
+}
+
+// static
+void GpuProfiler::setMaxEvents(unsigned int e) {
+    maxEvents = e;
+    while(events.size() > maxEvents) events.pop_front();
+}
+
+// static
+std::vector<GpuProfiler::Stats> GpuProfiler::getStats() {
+    std::vector<Stats> result;
+    for(const std::pair<const std::string, unsigned int>& s : statsIndex)
+        if(stats[s.second].count > 0) result.push_back(stats[s.second]);
+    return result;
+}
+
+// static
+const GpuProfiler::Stats& GpuProfiler::getStats(const std::string& name) {
+    std::map<std::string, unsigned int>::const_iterator it = statsIndex.find(name);
+    VBE_ASSERT(it != statsIndex.end() && stats[it->second].count > 0, "No GPU timings for scope " << name);
+    return stats[it->second];
+}
+
+// static
+const std::deque<GpuProfiler::Event>& GpuProfiler::getEvents() {
+    return events;
+}
+
+// static
+void GpuProfiler::writeStats(std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(40) << "scope" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "last"
+        << std::setw(10) << "min" << std::setw(10) << "avg" << std::setw(10) << "max" << " (ms)\n";
+    for(const Stats& s : getStats()) {
+        out << std::left << std::setw(40) << (std::string(s.depth*2, ' ') + s.name) << std::right
+            << std::setw(10) << s.count << std::setw(10) << s.last
+            << std::setw(10) << s.min << std::setw(10) << s.avg << std::setw(10) << s.max << "\n";
+    }
+    out.flags(flags);
+}
+
+// static
+void GpuProfiler::reset() {
+    // Measures in flight keep their indices, so the names are kept
+    for(Stats& s : stats) {
+        std::string name = s.name;
+        s = Stats();
+        s.name = name;
+    }
+    events.clear();
+    if(enabled) calibrate();
+}
+
+// static
+void GpuProfiler::clear() {
+    setEnabled(false);
+    if(!freeQueries.empty())
+        GL_ASSERT(glDeleteQueries(freeQueries.size(), &freeQueries[0]));
+    freeQueries.clear();
+}
+
+// static
+GLuint GpuProfiler::acquireQuery() {
+    GLuint q = 0;
+    if(freeQueries.empty()) {
+        GL_ASSERT(glGenQueries(1, &q));
+        return q;
+    }
+    q = freeQueries.back();
+    freeQueries.pop_back();
+    return q;
+}
+
+// static
+void GpuProfiler::collect(Frame& frame) {
+    for(const Measure& m : frame.measures) {
+        GLuint64 begin = 0, end = 0;
+        GL_ASSERT(glGetQueryObjectui64v(m.begin, GL_QUERY_RESULT, &begin));
+        GL_ASSERT(glGetQueryObjectui64v(m.end, GL_QUERY_RESULT, &end));
+        freeQueries.push_back(m.begin);
+        freeQueries.push_back(m.end);
+
+        double ms = double(end - begin)/1000000.0;
+        Stats& s = stats[m.name];
+        s.depth = m.depth;
+        s.last = ms;
+        s.min = (s.count == 0 ? ms : std::min(s.min, ms));
+        s.max = (s.count == 0 ? ms : std::max(s.max, ms));
+        s.avg += (ms - s.avg)/double(++s.count);
+
+        if(maxEvents == 0) continue;
+        Event e;
+        e.name = s.name;
+        e.depth = m.depth;
+        e.frame = frame.index;
+        e.begin = (long long) (begin/1000) + clockOffset;
+        e.end = (long long) (end/1000) + clockOffset;
+        events.push_back(e);
+        if(events.size() > maxEvents) events.pop_front();
+    }
+    frame.measures.clear();
+}
+
+// static
+void GpuProfiler::discard(Frame& frame) {
+    for(const Measure& m : frame.measures) {
+        freeQueries.push_back(m.begin);
+        if(m.end != 0) freeQueries.push_back(m.end);
+    }
+    frame.measures.clear();
+}
+
+// static
+void GpuProfiler::calibrate() {
+    // Querying GL_TIMESTAMP directly returns the GPU time without waiting for pending commands
+    GLint64 gpu = 0;
+    GL_ASSERT(glGetInteger64v(GL_TIMESTAMP, &gpu));
+    clockOffset = Clock::getMicroseconds() - gpu/1000;
+}
+
+#endif // VBE_GLES2
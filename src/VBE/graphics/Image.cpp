@@ -1,5 +1,6 @@
 #include <VBE/graphics/Image.hpp>
 #include <VBE/dependencies/stb_image/stb_image.hpp>
+#include <VBE/system/Profiler.hpp>
 
 Image::Image() {
 }
@@ -60,6 +61,7 @@ static const STBI::stbi_io_callbacks stb_callbacks = {
 
 // static
 Image Image::load(std::unique_ptr<std::istream> in) {
+    VBE_PROFILE_ZONE("Image::load");
     int sizeX, sizeY, channels;
     unsigned char* ptr = STBI::stbi_load_from_callbacks(&stb_callbacks, in.get(), &sizeX, &sizeY, &channels, 0);
     VBE_ASSERT(ptr && sizeX && sizeY, "Failed to load image. Reason : " << STBI::stbi_failure_reason());
@@ -1,6 +1,8 @@
+#include <VBE/graphics/GpuProfiler.hpp>
 #include <VBE/graphics/MeshBatched.hpp>
 #include <algorithm>
 #include <VBE/system/Log.hpp>
+#include <VBE/system/Profiler.hpp>
 #include "ShaderBinding.hpp"
 
 bool MeshBatched::batching = false;
@@ -102,6 +104,10 @@ void MeshBatched::endBatch() {
     VBE_ASSERT(batching, "Cannot end a batch that wasn't started.");
     batching = false;
     if(commands.size() == 0) return;
+    VBE_PROFILE_ZONE("MeshBatched::endBatch");
+#ifndef VBE_GLES2
+    GpuProfiler::Scope scope("MeshBatched::endBatch");
+#endif
     uploadPerDrawData(commands.size());
     uploadIndirectCommands();
 
@@ -0,0 +1,396 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <VBE/graphics/Mesh.hpp>
+#include <VBE/graphics/MeshCache.hpp>
+#include <VBE/system/Log.hpp>
+#include <VBE/utils/NonCopyable.hpp>
+
+namespace {
+    const char magic[4] = {'V', 'B', 'E', 'M'};
+    const std::uint32_t version = 2;
+    const std::uint64_t alignment = 64;
+
+    // Followed by the attributes, each one a FileAttribute and its name,
+    // then the vertex, index and sub-mesh blobs at their offsets
+    struct FileHeader {
+            char magic[4];
+            std::uint32_t version;
+            std::uint64_t sourceHash;
+            float boxMin[3];
+            float boxMax[3];
+            std::uint32_t attributeCount;
+            std::uint32_t vertexSize;
+            std::uint32_t vertexCount;
+            std::uint32_t indexFormat; // 0 when the mesh has no indices
+            std::uint32_t indexCount;
+            std::uint32_t primitiveType;
+            std::uint32_t primitiveRestart;
+            std::uint32_t subMeshCount;
+            std::uint64_t vertexOffset;
+            std::uint64_t indexOffset;
+            std::uint64_t subMeshOffset;
+    };
+
+    struct FileSubMesh {
+            std::uint32_t offset;
+            std::uint32_t count;
+            std::uint32_t baseVertex;
+    };
+
+    struct FileAttribute {
+            std::uint32_t type;
+            std::uint32_t size;
+            std::uint32_t conversion;
+            std::uint32_t divisor;
+            std::uint32_t nameLength;
+    };
+
+    inline std::uint64_t align(std::uint64_t offset) {
+        return (offset + alignment - 1)/alignment*alignment;
+    }
+
+    inline unsigned int getIndexSize(std::uint32_t indexFormat) {
+        switch(indexFormat) {
+            case MeshIndexed::UNSIGNED_SHORT: return sizeof(GLushort);
+            case MeshIndexed::UNSIGNED_INT: return sizeof(GLuint);
+            default: return 0;
+        }
+    }
+
+    // Every index of [offset, offset + count) plus baseVertex must name one of the vertices.
+    // With primitive restart the largest value of the type is the restart index instead.
+    template<typename T>
+    bool areIndicesInRange(const char* indexData, std::uint32_t offset, std::uint32_t count, std::uint64_t baseVertex,
+                           std::uint64_t vertexCount, bool primitiveRestart) {
+        // Only the largest index matters. Adding one wraps restart indices around to zero,
+        // so a plain maximum skips them, and blocks of a fixed size get vectorized.
+        const T shift = primitiveRestart ? 1 : 0;
+        const char* data = indexData + std::uint64_t(offset)*sizeof(T);
+        T maxIndex = 0;
+        std::uint32_t i = 0;
+        for(; i + 64 <= count; i += 64) {
+            T block[64];
+            std::memcpy(block, data + std::uint64_t(i)*sizeof(T), sizeof(block));
+            for(unsigned int j = 0; j < 64; ++j)
+                maxIndex = std::max(maxIndex, T(block[j] + shift));
+        }
+        for(; i < count; ++i) {
+            T index;
+            std::memcpy(&index, data + std::uint64_t(i)*sizeof(T), sizeof(T));
+            maxIndex = std::max(maxIndex, T(index + shift));
+        }
+        // Zero means there were only restart indices
+        return count == 0 || (shift != 0 && maxIndex == 0) || baseVertex + maxIndex - shift < vertexCount;
+    }
+
+    bool areIndicesInRange(const char* indexData, std::uint32_t indexFormat, std::uint32_t offset, std::uint32_t count,
+                           std::uint64_t baseVertex, std::uint64_t vertexCount, bool primitiveRestart) {
+        if(indexFormat == MeshIndexed::UNSIGNED_SHORT)
+            return areIndicesInRange<GLushort>(indexData, offset, count, baseVertex, vertexCount, primitiveRestart);
+        return areIndicesInRange<GLuint>(indexData, offset, count, baseVertex, vertexCount, primitiveRestart);
+    }
+
+    inline bool isValidType(std::uint32_t type) {
+        switch(type) {
+            case Vertex::Attribute::Byte:
+            case Vertex::Attribute::UnsignedByte:
+            case Vertex::Attribute::Short:
+            case Vertex::Attribute::UnsignedShort:
+            case Vertex::Attribute::Int:
+            case Vertex::Attribute::UnsignedInt:
+            case Vertex::Attribute::Float:
+            case Vertex::Attribute::Fixed:
+#ifndef VBE_GLES2
+            case Vertex::Attribute::Double:
+            case Vertex::Attribute::HalfFloat:
+#endif
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    inline bool isValidPrimitiveType(std::uint32_t type) {
+        switch(type) {
+            case Mesh::TRIANGLES:
+            case Mesh::TRIANGLE_STRIP:
+            case Mesh::TRIANGLE_FAN:
+            case Mesh::LINES:
+            case Mesh::LINE_STRIP:
+            case Mesh::LINE_LOOP:
+            case Mesh::POINTS:
+#ifndef VBE_GLES2
+            case Mesh::PATCHES:
+#endif
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Unique per process and per call, so concurrent writers never share a temporary file
+    std::string getTemporaryName(const std::string& filename) {
+        static std::atomic<unsigned int> counter(0);
+#ifdef _WIN32
+        unsigned long pid = GetCurrentProcessId();
+#else
+        unsigned long pid = getpid();
+#endif
+        std::ostringstream name;
+        name << filename << "." << pid << "." << counter++ << ".tmp";
+        return name.str();
+    }
+
+    // Replaces the destination in one step. Windows' rename fails when it exists.
+    bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+        return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        return std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+    }
+
+    // A read-only view of a whole file. Pages are only read when touched, so
+    // the driver copies the blobs straight from the page cache.
+    class MappedFile : public NonCopyable {
+        public:
+            explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+                std::ifstream file(filename.c_str(), std::ios::binary);
+                if(!file) return;
+                file.seekg(0, std::ios::end);
+                buffer.resize((std::size_t) file.tellg());
+                file.seekg(0, std::ios::beg);
+                file.read(buffer.data(), buffer.size());
+                if(!file) return;
+                data = buffer.data();
+                size = buffer.size();
+#else
+                int fd = open(filename.c_str(), O_RDONLY);
+                if(fd < 0) return;
+                struct stat info;
+                if(fstat(fd, &info) == 0 && info.st_size > 0) {
+                    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if(mapping != MAP_FAILED) {
+                        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                        data = (const char*) mapping;
+                        size = info.st_size;
+                    }
+                }
+                close(fd);
+#endif
+            }
+
+            ~MappedFile() {
+#ifndef _WIN32
+                if(data != nullptr) munmap((void*) data, size);
+#endif
+            }
+
+            const char* data = nullptr;
+            std::size_t size = 0;
+
+#ifdef _WIN32
+        private:
+            std::vector<char> buffer;
+#endif
+    };
+}
+
+// static
+unsigned long long MeshCache::hash(const void* data, std::size_t size, unsigned long long seed) {
+    // Eight bytes per step, so hashing is a small part of loading even a large source
+    const unsigned char* p = (const unsigned char*) data;
+    std::uint64_t h = seed ^ 0xCBF29CE484222325ULL ^ (size*0x9E3779B97F4A7C15ULL);
+    for(; size >= 8; p += 8, size -= 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p, 8);
+        h = (h ^ word)*0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+    }
+    for(; size > 0; ++p, --size)
+        h = (h ^ *p)*0x100000001B3ULL;
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    return h ^ (h >> 32);
+}
+
+// static
+bool MeshCache::write(const std::string& filename, unsigned long long sourceHash, const Vertex::Format& format, const AABB& box,
+                      const void* vertexData, unsigned int vertexCount,
+                      const void* indexData, unsigned int indexCount, MeshIndexed::IndexFormat indexFormat,
+                      Mesh::PrimitiveType primitiveType, bool primitiveRestart, const std::vector<MeshIndexed::SubMesh>& subMeshes) {
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+    VBE_ASSERT(indexData != nullptr || indexCount == 0, "Index data cannot be nullptr");
+    VBE_ASSERT(indexData != nullptr || subMeshes.empty(), "Only meshes with indices have sub-meshes");
+
+    std::string attributes;
+    for(unsigned int i = 0; i < format.elementCount(); ++i) {
+        const Vertex::Attribute& a = format.element(i);
+        FileAttribute fa = {std::uint32_t(a.type), a.size, std::uint32_t(a.conv), a.divisor, std::uint32_t(a.name.size())};
+        attributes.append((const char*) &fa, sizeof(fa));
+        attributes.append(a.name);
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.sourceHash = sourceHash;
+    vec3f boxMin = box.getMin(), boxMax = box.getMax();
+    for(int i = 0; i < 3; ++i) {
+        header.boxMin[i] = boxMin[i];
+        header.boxMax[i] = boxMax[i];
+    }
+    header.attributeCount = format.elementCount();
+    header.vertexSize = format.vertexSize();
+    header.vertexCount = vertexCount;
+    header.indexFormat = (indexData == nullptr ? 0 : indexFormat);
+    header.indexCount = indexCount;
+    header.primitiveType = primitiveType;
+    header.primitiveRestart = primitiveRestart;
+    header.subMeshCount = subMeshes.size();
+    header.vertexOffset = align(sizeof(header) + attributes.size());
+    std::uint64_t vertexBytes = std::uint64_t(header.vertexSize)*vertexCount;
+    std::uint64_t indexBytes = std::uint64_t(getIndexSize(header.indexFormat))*indexCount;
+    header.indexOffset = align(header.vertexOffset + vertexBytes);
+    header.subMeshOffset = align(header.indexOffset + indexBytes);
+    std::vector<FileSubMesh> fileSubMeshes;
+    for(const MeshIndexed::SubMesh& s : subMeshes) {
+        FileSubMesh fs = {s.offset, s.count, s.baseVertex};
+        fileSubMeshes.push_back(fs);
+    }
+
+    const char padding[alignment] = {};
+    std::string temporary = getTemporaryName(filename);
+    std::ofstream out(temporary.c_str(), std::ios::binary);
+    if(!out) {
+        VBE_DLOG("* Could not write mesh cache " << filename);
+        return false;
+    }
+    out.write((const char*) &header, sizeof(header));
+    out.write(attributes.data(), attributes.size());
+    out.write(padding, header.vertexOffset - sizeof(header) - attributes.size());
+    out.write((const char*) vertexData, vertexBytes);
+    out.write(padding, header.indexOffset - header.vertexOffset - vertexBytes);
+    out.write((const char*) indexData, indexBytes);
+    out.write(padding, header.subMeshOffset - header.indexOffset - indexBytes);
+    out.write((const char*) fileSubMeshes.data(), fileSubMeshes.size()*sizeof(FileSubMesh));
+    out.close();
+
+    bool written = !out.fail() && replaceFile(temporary, filename);
+    if(!written) {
+        std::remove(temporary.c_str());
+        VBE_DLOG("* Could not write mesh cache " << filename);
+        return false;
+    }
+    return true;
+}
+
+// static
+MeshSeparate* MeshCache::load(const std::string& filename, unsigned long long sourceHash, Mesh::BufferType bufferType, AABB* box) {
+    MappedFile file(filename);
+    if(file.data == nullptr || file.size < sizeof(FileHeader)) return nullptr;
+
+    FileHeader header;
+    std::memcpy(&header, file.data, sizeof(header));
+    if(std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version) {
+        VBE_DLOG("* Mesh cache " << filename << " has an unknown format");
+        return nullptr;
+    }
+    if(header.sourceHash != sourceHash) {
+        VBE_DLOG("* Mesh cache " << filename << " is stale");
+        return nullptr;
+    }
+
+    // Everything read below is checked against the file size, a broken file is just a miss
+    std::uint64_t vertexBytes = std::uint64_t(header.vertexSize)*header.vertexCount;
+    std::uint64_t indexBytes = std::uint64_t(getIndexSize(header.indexFormat))*header.indexCount;
+    std::uint64_t subMeshBytes = std::uint64_t(sizeof(FileSubMesh))*header.subMeshCount;
+    bool valid = (header.indexFormat == 0 || getIndexSize(header.indexFormat) != 0) &&
+                 isValidPrimitiveType(header.primitiveType) &&
+                 header.vertexOffset <= file.size && vertexBytes <= file.size - header.vertexOffset &&
+                 header.indexOffset <= file.size && indexBytes <= file.size - header.indexOffset &&
+                 header.subMeshOffset <= file.size && subMeshBytes <= file.size - header.subMeshOffset;
+#ifdef VBE_GLES2
+    // Neither sub-meshes nor primitive restart can be drawn
+    valid = valid && header.subMeshCount == 0 && header.primitiveRestart == 0;
+#else
+    valid = valid && (header.primitiveRestart == 0 || MeshIndexed::isPrimitiveRestartSupported());
+#endif
+    valid = valid && (header.indexFormat != 0 || (header.subMeshCount == 0 && header.primitiveRestart == 0));
+
+    // Indices past the vertices would make the GPU read outside the vertex buffer
+    const char* indexData = file.data + header.indexOffset;
+    std::vector<MeshIndexed::SubMesh> subMeshes;
+    for(unsigned int i = 0; valid && i < header.subMeshCount; ++i) {
+        FileSubMesh fs;
+        std::memcpy(&fs, file.data + header.subMeshOffset + i*sizeof(fs), sizeof(fs));
+        valid = fs.offset <= header.indexCount && fs.count <= header.indexCount - fs.offset && fs.baseVertex < header.vertexCount &&
+                areIndicesInRange(indexData, header.indexFormat, fs.offset, fs.count, fs.baseVertex, header.vertexCount, header.primitiveRestart != 0);
+        MeshIndexed::SubMesh s = {fs.offset, fs.count, fs.baseVertex};
+        subMeshes.push_back(s);
+    }
+    if(valid && header.indexFormat != 0 && header.subMeshCount == 0)
+        valid = areIndicesInRange(indexData, header.indexFormat, 0, header.indexCount, 0, header.vertexCount, header.primitiveRestart != 0);
+
+    std::vector<Vertex::Attribute> elements;
+    std::uint64_t offset = sizeof(header);
+    for(unsigned int i = 0; valid && i < header.attributeCount; ++i) {
+        FileAttribute fa;
+        valid = offset + sizeof(fa) <= header.vertexOffset;
+        if(!valid) break;
+        std::memcpy(&fa, file.data + offset, sizeof(fa));
+        offset += sizeof(fa);
+        valid = fa.nameLength <= header.vertexOffset - offset && isValidType(fa.type) &&
+                fa.size >= 1 && fa.size <= 4 && fa.conversion <= Vertex::Attribute::ConvertToInt;
+        if(!valid) break;
+        elements.push_back(Vertex::Attribute(std::string(file.data + offset, fa.nameLength), Vertex::Attribute::Type(fa.type),
+                                             fa.size, Vertex::Attribute::Conversion(fa.conversion), fa.divisor));
+        offset += fa.nameLength;
+    }
+    Vertex::Format format(elements);
+    if(!valid || format.vertexSize() != header.vertexSize) {
+        VBE_DLOG("* Mesh cache " << filename << " is broken");
+        return nullptr;
+    }
+
+    MeshSeparate* mesh = nullptr;
+    if(header.indexFormat != 0) {
+        MeshIndexed* indexed = new MeshIndexed(format, bufferType, MeshIndexed::IndexFormat(header.indexFormat));
+        indexed->setVertexData(file.data + header.vertexOffset, header.vertexCount);
+        indexed->setIndexData(file.data + header.indexOffset, header.indexCount);
+#ifndef VBE_GLES2
+        indexed->setSubMeshes(subMeshes);
+        indexed->setPrimitiveRestart(header.primitiveRestart != 0);
+#endif
+        mesh = indexed;
+    }
+    else {
+        mesh = new Mesh(format, bufferType);
+        mesh->setVertexData(file.data + header.vertexOffset, header.vertexCount);
+    }
+    mesh->setPrimitiveType(Mesh::PrimitiveType(header.primitiveType));
+    if(box != nullptr)
+        *box = AABB(vec3f(header.boxMin[0], header.boxMin[1], header.boxMin[2]),
+                    vec3f(header.boxMax[0], header.boxMax[1], header.boxMax[2]));
+    return mesh;
+}
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <VBE/geometry/Collision.hpp>
+#include <VBE/graphics/MeshClusterizer.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    inline vec3f getPosition(const char* vertexData, unsigned int vertexSize, unsigned int positionOffset, unsigned int vertex) {
+        vec3f p;
+        std::memcpy(&p, vertexData + std::size_t(vertex)*vertexSize + positionOffset, sizeof(p));
+        return p;
+    }
+
+    // Ritter's sphere: starts from the two extreme points furthest apart along
+    // an axis and grows to take in the points that are left outside
+    Sphere getBoundingSphere(const std::vector<vec3f>& points) {
+        unsigned int extremes[6] = {0, 0, 0, 0, 0, 0};
+        for(unsigned int i = 0; i < points.size(); ++i) {
+            for(int axis = 0; axis < 3; ++axis) {
+                if(points[i][axis] < points[extremes[axis*2]][axis]) extremes[axis*2] = i;
+                if(points[i][axis] > points[extremes[axis*2 + 1]][axis]) extremes[axis*2 + 1] = i;
+            }
+        }
+        int widest = 0;
+        for(int axis = 1; axis < 3; ++axis)
+            if(glm::distance(points[extremes[axis*2]], points[extremes[axis*2 + 1]]) >
+               glm::distance(points[extremes[widest*2]], points[extremes[widest*2 + 1]]))
+                widest = axis;
+        vec3f a = points[extremes[widest*2]], b = points[extremes[widest*2 + 1]];
+        Sphere s((a + b)*0.5f, glm::distance(a, b)*0.5f);
+        for(const vec3f& p : points) {
+            float d = glm::distance(p, s.center);
+            if(d > s.radius) {
+                float radius = (s.radius + d)*0.5f;
+                s.center += (p - s.center)*((radius - s.radius)/d);
+                s.radius = radius;
+            }
+        }
+        return s;
+    }
+}
+
+// static
+std::vector<MeshClusterizer::Cluster> MeshClusterizer::build(std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexCount,
+                                                             unsigned int vertexSize, unsigned int positionOffset, unsigned int maxTriangles) {
+    VBE_ASSERT(indices.size()%3 == 0, "Index count must be a multiple of 3");
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+    VBE_ASSERT(maxTriangles > 0, "Clusters must hold at least one triangle");
+    const char* data = (const char*) vertexData;
+    unsigned int triangleCount = indices.size()/3;
+
+    std::vector<vec3f> centroids(triangleCount), normals(triangleCount);
+    for(unsigned int t = 0; t < triangleCount; ++t) {
+        vec3f p[3];
+        for(unsigned int j = 0; j < 3; ++j) {
+            VBE_ASSERT(indices[t*3 + j] < vertexCount, "Index " << indices[t*3 + j] << " is out of range, there are " << vertexCount << " vertices");
+            p[j] = getPosition(data, vertexSize, positionOffset, indices[t*3 + j]);
+        }
+        centroids[t] = (p[0] + p[1] + p[2])/3.0f;
+        vec3f n = glm::cross(p[1] - p[0], p[2] - p[0]);
+        float length = glm::length(n);
+        normals[t] = length > 0.0f ? n/length : vec3f(0.0f);
+    }
+
+    // The triangles around every vertex
+    std::vector<unsigned int> offsets(vertexCount + 1, 0), adjacency(indices.size());
+    for(unsigned int index : indices) ++offsets[index + 1];
+    for(unsigned int v = 0; v < vertexCount; ++v) offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for(unsigned int i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = i/3;
+
+    // Stamps hold the number of the cluster that last took or looked at a vertex or triangle
+    std::vector<unsigned int> vertexStamps(vertexCount, 0), triangleStamps(triangleCount, 0);
+    // Triangles not in a cluster yet around every vertex
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for(unsigned int v = 0; v < vertexCount; ++v) liveTriangles[v] = offsets[v + 1] - offsets[v];
+    auto countLive = [&](unsigned int t) {
+        return liveTriangles[indices[t*3]] + liveTriangles[indices[t*3 + 1]] + liveTriangles[indices[t*3 + 2]];
+    };
+    std::vector<bool> used(triangleCount, false);
+    std::vector<unsigned int> members, candidates, result;
+    std::vector<vec3f> points;
+    std::vector<Cluster> clusters;
+    result.reserve(indices.size());
+    unsigned int next = 0;
+    while(true) {
+        // Start next to the last cluster, where the fewest triangles are left around,
+        // so the corners it left behind are taken before they become clusters of their own
+        unsigned int added = triangleCount;
+        unsigned int bestLive = std::numeric_limits<unsigned int>::max();
+        for(unsigned int t : candidates) {
+            if(used[t]) continue;
+            unsigned int live = countLive(t);
+            if(live < bestLive) {
+                added = t;
+                bestLive = live;
+            }
+        }
+        if(added == triangleCount) {
+            while(next < triangleCount && used[next]) ++next;
+            if(next == triangleCount) break;
+            added = next;
+        }
+        unsigned int stamp = clusters.size() + 1;
+        members.clear();
+        candidates.clear();
+        vec3f centroidSum(0.0f), normalSum(0.0f);
+        float radius = 0.0f;
+        while(true) {
+            used[added] = true;
+            members.push_back(added);
+            centroidSum += centroids[added];
+            normalSum += normals[added];
+            for(unsigned int j = 0; j < 3; ++j) {
+                unsigned int v = indices[added*3 + j];
+                vertexStamps[v] = stamp;
+                --liveTriangles[v];
+                for(unsigned int k = offsets[v]; k < offsets[v + 1]; ++k) {
+                    unsigned int t = adjacency[k];
+                    if(used[t] || triangleStamps[t] == stamp) continue;
+                    triangleStamps[t] = stamp;
+                    candidates.push_back(t);
+                }
+            }
+            if(members.size() == maxTriangles) break;
+
+            // Take the neighbour that adds the fewest vertices, then the closest one facing the
+            // same way as the rest, so clusters stay round and cones narrow. Triangles with few
+            // others left around them go first, or they end up as clusters of a few triangles.
+            vec3f center = centroidSum/float(members.size());
+            float normalLength = glm::length(normalSum);
+            vec3f axis = normalLength > 0.0f ? normalSum/normalLength : vec3f(0.0f);
+            for(unsigned int j = 0; j < 3; ++j)
+                radius = std::max(radius, glm::distance(center, getPosition(data, vertexSize, positionOffset, indices[added*3 + j])));
+            unsigned int best = triangleCount;
+            unsigned int bestExtra = 4;
+            float bestScore = std::numeric_limits<float>::max();
+            for(unsigned int i = 0; i < candidates.size();) {
+                unsigned int t = candidates[i];
+                if(used[t]) {
+                    candidates[i] = candidates.back();
+                    candidates.pop_back();
+                    continue;
+                }
+                ++i;
+                unsigned int extra = 0;
+                for(unsigned int j = 0; j < 3; ++j)
+                    if(vertexStamps[indices[t*3 + j]] != stamp) ++extra;
+                if(extra > bestExtra) continue;
+                unsigned int live = countLive(t);
+                float score = glm::distance(center, centroids[t])*(2.0f - glm::dot(axis, normals[t]))*(1.0f + 0.1f*live);
+                if(extra < bestExtra || score < bestScore) {
+                    best = t;
+                    bestExtra = extra;
+                    bestScore = score;
+                }
+            }
+
+            // Islands close to the cluster join it, as long as they come next
+            if(best == triangleCount) {
+                while(next < triangleCount && used[next]) ++next;
+                if(next == triangleCount || glm::distance(center, centroids[next]) > radius*2.0f) break;
+                best = next;
+            }
+            added = best;
+        }
+
+        // Keep the order they came in, which was probably tuned for the vertex cache
+        std::sort(members.begin(), members.end());
+        Cluster c;
+        c.offset = result.size();
+        c.count = members.size()*3;
+        points.clear();
+        for(unsigned int t : members) {
+            for(unsigned int j = 0; j < 3; ++j) {
+                unsigned int v = indices[t*3 + j];
+                result.push_back(v);
+                if(vertexStamps[v] == stamp) {
+                    vertexStamps[v] = 0;
+                    points.push_back(getPosition(data, vertexSize, positionOffset, v));
+                }
+            }
+        }
+        c.bounds = getBoundingSphere(points);
+        c.coneApex = c.bounds.center;
+
+        // The cone holds every normal. Past 84 degrees the apex gets too far
+        // to be useful, and the cluster faces too many ways to be culled anyway.
+        float normalLength = glm::length(normalSum);
+        if(normalLength > 0.0f) {
+            vec3f axis = normalSum/normalLength;
+            float minDot = 1.0f;
+            for(unsigned int t : members)
+                if(normals[t] != vec3f(0.0f)) minDot = std::min(minDot, glm::dot(axis, normals[t]));
+            if(minDot > 0.1f) {
+                float maxT = 0.0f;
+                for(unsigned int t : members) {
+                    if(normals[t] == vec3f(0.0f)) continue;
+                    vec3f p = getPosition(data, vertexSize, positionOffset, indices[t*3]);
+                    maxT = std::max(maxT, glm::dot(c.bounds.center - p, normals[t])/glm::dot(axis, normals[t]));
+                }
+                c.coneApex = c.bounds.center - axis*maxT;
+                c.coneAxis = axis;
+                c.coneCutoff = std::sqrt(1.0f - minDot*minDot);
+            }
+        }
+        clusters.push_back(c);
+    }
+    indices.swap(result);
+    return clusters;
+}
+
+// static
+void MeshClusterizer::unindex(const std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexSize, std::vector<char>& result) {
+    VBE_ASSERT(vertexData != nullptr || indices.empty(), "Vertex data cannot be nullptr");
+    result.resize(indices.size()*std::size_t(vertexSize));
+    for(unsigned int i = 0; i < indices.size(); ++i)
+        std::memcpy(&result[i*std::size_t(vertexSize)], (const char*) vertexData + indices[i]*std::size_t(vertexSize), vertexSize);
+}
+
+// static
+bool MeshClusterizer::isBackfacing(const Cluster& cluster, const vec3f& cameraPosition) {
+    if(cluster.coneCutoff >= 1.0f) return false;
+    vec3f view = cluster.coneApex - cameraPosition;
+    float length = glm::length(view);
+    return length > 0.0f && glm::dot(view, cluster.coneAxis) >= cluster.coneCutoff*length;
+}
+
+// static
+bool MeshClusterizer::isVisible(const Cluster& cluster, const Frustum& frustum, const vec3f& cameraPosition) {
+    return !isBackfacing(cluster, cameraPosition) && Collision::intersects(frustum, cluster.bounds);
+}
+
+// static
+void MeshClusterizer::cull(const std::vector<Cluster>& clusters, const Frustum& frustum, const vec3f& cameraPosition, std::vector<Range>& ranges) {
+    ranges.clear();
+    for(const Cluster& c : clusters) {
+        if(!isVisible(c, frustum, cameraPosition)) continue;
+        if(!ranges.empty() && ranges.back().offset + ranges.back().count == c.offset)
+            ranges.back().count += c.count;
+        else
+            ranges.push_back(c);
+    }
+}
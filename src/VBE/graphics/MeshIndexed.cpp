@@ -1,8 +1,12 @@
+#include <algorithm>
+
 #include <VBE/graphics/MeshIndexed.hpp>
 #include <VBE/graphics/ShaderBinding.hpp>
 #include <VBE/graphics/ShaderProgram.hpp>
 #include <VBE/system/Log.hpp>
 
+const unsigned int MeshIndexed::restartIndex;
+
 MeshIndexed::MeshIndexed() : MeshSeparate() {
 }
 
@@ -43,19 +47,7 @@ void MeshIndexed::draw(const ShaderProgram& program, unsigned int offset, unsign
     VBE_ASSERT(program.getHandle() != 0, "program cannot be null");
 
     setupShaderBinding(program);
-
-    switch(indexFormat) {
-        case UNSIGNED_INT:
-            {
-                GL_ASSERT(glDrawElements(getPrimitiveType(), length, indexFormat, (void*)(offset*sizeof(unsigned int))));
-                break;
-            }
-        case UNSIGNED_SHORT:
-            {
-                GL_ASSERT(glDrawElements(getPrimitiveType(), length, indexFormat, (void*)(offset*sizeof(unsigned short))));
-                break;
-            }
-    }
+    drawElements(offset, length, false, 0);
 }
 
 void MeshIndexed::drawInstanced(const ShaderProgram& program, unsigned int instanceCount) const {
@@ -67,21 +59,49 @@ void MeshIndexed::drawInstanced(const ShaderProgram& program, unsigned int insta
     VBE_ASSERT(program.getHandle() != 0, "program cannot be null");
 
     setupShaderBinding(program);
+    drawElements(offset, length, true, instanceCount);
+}
 
-    switch(indexFormat) {
-        case UNSIGNED_INT:
-            {
-                GL_ASSERT(glDrawElementsInstanced(getPrimitiveType(), length, indexFormat, (void*)(offset*sizeof(unsigned int)), instanceCount));
-                break;
-            }
-        case UNSIGNED_SHORT:
-            {
-                GL_ASSERT(glDrawElementsInstanced(getPrimitiveType(), length, indexFormat, (void*)(offset*sizeof(unsigned short)), instanceCount));
-                break;
-            }
+void MeshIndexed::drawElements(unsigned int offset, unsigned int length, bool instanced, unsigned int instanceCount) const {
+    VBE_ASSERT(std::size_t(offset) + length <= getIndexCount(), "offset plus length must be smaller or equal to index count");
+#ifdef VBE_DEBUG
+    // The binding holds the index buffer, unless GL state was changed behind its back
+    GLint boundIndexBuffer = 0;
+    GL_ASSERT(glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &boundIndexBuffer));
+    VBE_ASSERT(GLuint(boundIndexBuffer) == indexBuffer, "The index buffer of the mesh is not bound. Was the vertex array "
+               "or the element array buffer changed without going through the mesh?");
+#endif
+#ifndef VBE_GLES2
+    if(primitiveRestart) GL_ASSERT(glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX));
+    if(!subMeshes.empty()) {
+        // Every sub-mesh draws the part of [offset, offset + length) that falls inside it
+        for(const SubMesh& s : subMeshes) {
+            unsigned int begin = std::max(offset, s.offset);
+            unsigned int end = std::min(offset + length, s.offset + s.count);
+            if(begin >= end) continue;
+            void* start = (void*)(std::size_t(begin)*getIndexSize());
+            if(instanced)
+                GL_ASSERT(glDrawElementsInstancedBaseVertex(getPrimitiveType(), end - begin, indexFormat, start, instanceCount, s.baseVertex));
+            else
+                GL_ASSERT(glDrawElementsBaseVertex(getPrimitiveType(), end - begin, indexFormat, start, s.baseVertex));
+        }
+        if(primitiveRestart) GL_ASSERT(glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX));
+        return;
     }
+#endif
+    void* start = (void*)(std::size_t(offset)*getIndexSize());
+    if(instanced)
+        GL_ASSERT(glDrawElementsInstanced(getPrimitiveType(), length, indexFormat, start, instanceCount));
+    else
+        GL_ASSERT(glDrawElements(getPrimitiveType(), length, indexFormat, start));
+#ifndef VBE_GLES2
+    if(primitiveRestart) GL_ASSERT(glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX));
+#endif
 }
 
+unsigned int MeshIndexed::getIndexSize() const {
+    return indexFormat == UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+}
 
 GLuint MeshIndexed::getIndexBuffer() const {
     return indexBuffer;
@@ -91,6 +111,10 @@ unsigned int MeshIndexed::getIndexCount() const {
     return indexCount;
 }
 
+MeshIndexed::IndexFormat MeshIndexed::getIndexFormat() const {
+    return indexFormat;
+}
+
 void MeshIndexed::setIndexData(const void* indexData, unsigned int newIndexCount) {
     VBE_ASSERT(getVertexBuffer() != 0, "Cannot use empty mesh");
 
@@ -98,25 +122,68 @@ void MeshIndexed::setIndexData(const void* indexData, unsigned int newIndexCount
     ShaderBinding::bind(nullptr);
     indexCount = newIndexCount;
     GL_ASSERT(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer));
-    switch(indexFormat) {
-        case UNSIGNED_INT:
-            {
-                GL_ASSERT(glBufferData(GL_ELEMENT_ARRAY_BUFFER, newIndexCount * sizeof(unsigned int), indexData, getBufferType()));
-                break;
-            }
-        case UNSIGNED_SHORT:
-            {
-                GL_ASSERT(glBufferData(GL_ELEMENT_ARRAY_BUFFER, newIndexCount * sizeof(unsigned short), indexData, getBufferType()));
-                break;
-            }
-    }
+    GL_ASSERT(glBufferData(GL_ELEMENT_ARRAY_BUFFER, std::size_t(newIndexCount) * getIndexSize(), indexData, getBufferType()));
     GL_ASSERT(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
 }
 
+void MeshIndexed::setIndexData(const std::vector<unsigned int>& indices) {
+    std::vector<GLushort> compacted;
+    if(compactIndices(indices, compacted)) {
+        indexFormat = UNSIGNED_SHORT;
+        setIndexData(compacted.data(), compacted.size());
+    }
+    else {
+        indexFormat = UNSIGNED_INT;
+        setIndexData(indices.data(), indices.size());
+    }
+}
+
+#ifndef VBE_GLES2
+const std::vector<MeshIndexed::SubMesh>& MeshIndexed::getSubMeshes() const {
+    return subMeshes;
+}
+
+void MeshIndexed::setSubMeshes(const std::vector<SubMesh>& newSubMeshes) {
+    subMeshes = newSubMeshes;
+}
+
+bool MeshIndexed::getPrimitiveRestart() const {
+    return primitiveRestart;
+}
+
+void MeshIndexed::setPrimitiveRestart(bool enabled) {
+    VBE_ASSERT(!enabled || isPrimitiveRestartSupported(), "Fixed index primitive restart needs GL 4.3 or ARB_ES3_compatibility");
+    primitiveRestart = enabled;
+}
+#endif
+
+// static
+bool MeshIndexed::isPrimitiveRestartSupported() {
+#ifndef VBE_GLES2
+    return GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+#else
+    return false;
+#endif
+}
+
+// static
+bool MeshIndexed::compactIndices(const std::vector<unsigned int>& indices, std::vector<GLushort>& result) {
+    // 0xFFFF is left out, it is the restart index of UNSIGNED_SHORT
+    result.clear();
+    for(unsigned int index : indices)
+        if(index >= 0xFFFF && index != restartIndex) return false;
+    result.resize(indices.size());
+    for(std::size_t i = 0; i < indices.size(); ++i)
+        result[i] = GLushort(indices[i]);
+    return true;
+}
+
 void swap(MeshIndexed& a, MeshIndexed& b) {
     using std::swap;
     swap(static_cast<MeshSeparate&>(a), static_cast<MeshSeparate&>(b));
     swap(a.indexCount, b.indexCount);
     swap(a.indexBuffer, b.indexBuffer);
     swap(a.indexFormat, b.indexFormat);
+    swap(a.subMeshes, b.subMeshes);
+    swap(a.primitiveRestart, b.primitiveRestart);
 }
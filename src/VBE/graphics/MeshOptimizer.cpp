@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <cstring>
+
+#include <VBE/graphics/MeshOptimizer.hpp>
+#include <VBE/math.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    // A FIFO cache that holds the last size vertices that missed. Stamps count
+    // misses, so a vertex is cached while fewer than size misses came after it.
+    class FifoCache {
+        public:
+            FifoCache(unsigned int vertexCount, unsigned int size)
+                : stamps(vertexCount, 0), size(size), time(size + 1) {
+            }
+
+            // Returns whether the vertex missed
+            bool access(unsigned int vertex) {
+                if(time - stamps[vertex] <= size) return false;
+                stamps[vertex] = time++;
+                return true;
+            }
+
+            void flush() {
+                time += size + 1;
+            }
+
+        private:
+            std::vector<unsigned int> stamps;
+            unsigned int size;
+            unsigned int time;
+    };
+
+    inline vec3f getPosition(const char* vertexData, unsigned int vertexSize, unsigned int positionOffset, unsigned int vertex) {
+        vec3f p;
+        std::memcpy(&p, vertexData + std::size_t(vertex)*vertexSize + positionOffset, sizeof(p));
+        return p;
+    }
+
+    void checkIndices(const std::vector<unsigned int>& indices, unsigned int vertexCount) {
+        VBE_ASSERT(indices.size()%3 == 0, "Index count must be a multiple of 3");
+#ifdef VBE_DEBUG
+        for(unsigned int index : indices)
+            VBE_ASSERT(index < vertexCount, "Index " << index << " is out of range, there are " << vertexCount << " vertices");
+#else
+        (void) indices;
+        (void) vertexCount;
+#endif
+    }
+}
+
+// static
+MeshOptimizer::Statistics MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+    checkIndices(indices, vertexCount);
+    Statistics s;
+    FifoCache cache(vertexCount, cacheSize);
+    for(unsigned int index : indices)
+        if(cache.access(index)) ++s.transformed;
+    if(!indices.empty()) s.acmr = float(s.transformed)/(indices.size()/3);
+    if(vertexCount > 0) s.atvr = float(s.transformed)/vertexCount;
+    return s;
+}
+
+// static
+void MeshOptimizer::optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+    checkIndices(indices, vertexCount);
+    unsigned int triangleCount = indices.size()/3;
+
+    // Triangles around every vertex, and how many of them are still to be emitted
+    std::vector<unsigned int> live(vertexCount, 0);
+    for(unsigned int index : indices) ++live[index];
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for(unsigned int v = 0; v < vertexCount; ++v) offsets[v+1] = offsets[v] + live[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for(unsigned int i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = i/3;
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    unsigned int time = cacheSize + 1;
+    unsigned int next = 0;
+
+    // Tipsify: fan out every triangle around a vertex, then move to the candidate
+    // that will still be cached after its remaining triangles are emitted
+    int fan = (vertexCount > 0 ? 0 : -1);
+    while(fan >= 0) {
+        candidates.clear();
+        for(unsigned int k = offsets[fan]; k < offsets[fan+1]; ++k) {
+            unsigned int t = adjacency[k];
+            if(emitted[t]) continue;
+            emitted[t] = true;
+            for(unsigned int j = 0; j < 3; ++j) {
+                unsigned int v = indices[t*3 + j];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if(time - cacheTime[v] > cacheSize) cacheTime[v] = time++;
+            }
+        }
+
+        fan = -1;
+        int best = -1;
+        for(unsigned int v : candidates) {
+            if(live[v] == 0) continue;
+            int priority = 0;
+            if(time - cacheTime[v] + 2*live[v] <= cacheSize) priority = time - cacheTime[v];
+            if(priority > best) {
+                best = priority;
+                fan = v;
+            }
+        }
+        // Dead end: the most recently used vertex with triangles left, or else the next one in order
+        while(fan < 0 && !deadEnd.empty()) {
+            unsigned int v = deadEnd.back();
+            deadEnd.pop_back();
+            if(live[v] > 0) fan = v;
+        }
+        for(; fan < 0 && next < vertexCount; ++next)
+            if(live[next] > 0) fan = next;
+    }
+    indices.swap(result);
+}
+
+// static
+void MeshOptimizer::optimizeOverdraw(std::vector<unsigned int>& indices, const void* vertexData, unsigned int vertexCount, unsigned int vertexSize,
+                                     unsigned int positionOffset, float threshold, unsigned int cacheSize) {
+    checkIndices(indices, vertexCount);
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+    VBE_ASSERT(positionOffset + sizeof(vec3f) <= vertexSize, "Positions must be inside the vertices");
+    unsigned int triangleCount = indices.size()/3;
+    if(triangleCount == 0) return;
+
+    // Hard boundaries are triangles that miss all three vertices, the cache is cold there anyway
+    std::vector<unsigned int> hard;
+    FifoCache cache(vertexCount, cacheSize);
+    for(unsigned int t = 0; t < triangleCount; ++t) {
+        unsigned int misses = cache.access(indices[t*3]) + cache.access(indices[t*3 + 1]) + cache.access(indices[t*3 + 2]);
+        if(t == 0 || misses == 3) hard.push_back(t);
+    }
+    hard.push_back(triangleCount);
+
+    // Soft boundaries split the hard clusters wherever the part so far is
+    // close enough to the cache efficiency of the whole cluster
+    std::vector<unsigned int> clusters;
+    for(unsigned int c = 0; c + 1 < hard.size(); ++c) {
+        unsigned int begin = hard[c], end = hard[c+1];
+        cache.flush();
+        unsigned int misses = 0;
+        for(unsigned int i = begin*3; i < end*3; ++i)
+            misses += cache.access(indices[i]);
+        float limit = float(misses)/(end - begin)*threshold;
+
+        cache.flush();
+        misses = 0;
+        unsigned int start = begin;
+        clusters.push_back(begin);
+        for(unsigned int t = begin; t < end; ++t) {
+            for(unsigned int j = 0; j < 3; ++j)
+                misses += cache.access(indices[t*3 + j]);
+            if(t + 1 < end && float(misses)/(t + 1 - start) <= limit) {
+                clusters.push_back(t + 1);
+                cache.flush();
+                misses = 0;
+                start = t + 1;
+            }
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    const char* data = (const char*) vertexData;
+    vec3f meshCenter(0.0f);
+    for(unsigned int index : indices)
+        meshCenter += getPosition(data, vertexSize, positionOffset, index);
+    meshCenter /= float(indices.size());
+
+    // Clusters are sorted by how far out along their average normal they are
+    struct Cluster {
+            unsigned int begin, end;
+            float sortKey;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size() - 1);
+    for(unsigned int c = 0; c + 1 < clusters.size(); ++c) {
+        vec3f center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for(unsigned int t = clusters[c]; t < clusters[c+1]; ++t) {
+            vec3f a = getPosition(data, vertexSize, positionOffset, indices[t*3]);
+            vec3f b = getPosition(data, vertexSize, positionOffset, indices[t*3 + 1]);
+            vec3f d = getPosition(data, vertexSize, positionOffset, indices[t*3 + 2]);
+            vec3f n = glm::cross(b - a, d - a);
+            float triangleArea = glm::length(n);
+            center += (a + b + d)*(triangleArea/3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        float length = glm::length(normal);
+        Cluster cluster;
+        cluster.begin = clusters[c];
+        cluster.end = clusters[c+1];
+        cluster.sortKey = (area > 0.0f && length > 0.0f ? glm::dot(center/area - meshCenter, normal/length) : 0.0f);
+        sorted.push_back(cluster);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for(const Cluster& c : sorted)
+        result.insert(result.end(), indices.begin() + c.begin*3, indices.begin() + c.end*3);
+    indices.swap(result);
+}
+
+// static
+unsigned int MeshOptimizer::optimizeVertexFetch(void* vertexData, unsigned int vertexCount, unsigned int vertexSize, std::vector<unsigned int>& indices) {
+    checkIndices(indices, vertexCount);
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+    std::vector<unsigned int> remap(vertexCount, ~0u);
+    unsigned int count = 0;
+    for(unsigned int& index : indices) {
+        if(remap[index] == ~0u) remap[index] = count++;
+        index = remap[index];
+    }
+
+    char* data = (char*) vertexData;
+    std::vector<char> original(data, data + std::size_t(vertexCount)*vertexSize);
+    for(unsigned int v = 0; v < vertexCount; ++v)
+        if(remap[v] != ~0u)
+            std::memcpy(data + std::size_t(remap[v])*vertexSize, &original[std::size_t(v)*vertexSize], vertexSize);
+    return count;
+}
+
+// static
+unsigned int MeshOptimizer::optimize(void* vertexData, unsigned int vertexCount, unsigned int vertexSize, std::vector<unsigned int>& indices,
+                                     unsigned int positionOffset) {
+    optimizeVertexCache(indices, vertexCount);
+    optimizeOverdraw(indices, vertexData, vertexCount, vertexSize, positionOffset);
+    return optimizeVertexFetch(vertexData, vertexCount, vertexSize, indices);
+}
+
+// static
+std::vector<MeshIndexed::SubMesh> MeshOptimizer::splitIndices(std::vector<unsigned int>& indices, unsigned int vertexCount,
+                                                              std::vector<unsigned int>& vertexRemap, unsigned int maxVertices) {
+    checkIndices(indices, vertexCount);
+    VBE_ASSERT(maxVertices >= 3, "Sub-meshes need room for at least one triangle");
+    std::vector<MeshIndexed::SubMesh> subMeshes;
+    vertexRemap.clear();
+    if(indices.empty()) return subMeshes;
+
+    // Where every vertex was last placed, and in which sub-mesh
+    std::vector<unsigned int> owner(vertexCount, ~0u);
+    std::vector<unsigned int> local(vertexCount, 0);
+    MeshIndexed::SubMesh current = {0, 0, 0};
+    for(unsigned int i = 0; i < indices.size(); i += 3) {
+        unsigned int added = 0;
+        for(unsigned int j = 0; j < 3; ++j) {
+            unsigned int v = indices[i + j];
+            // Repeated vertices within the triangle only count once
+            if(owner[v] != subMeshes.size() && (j == 0 || v != indices[i]) && (j < 2 || v != indices[i + 1])) ++added;
+        }
+        if(vertexRemap.size() - current.baseVertex + added > maxVertices) {
+            subMeshes.push_back(current);
+            current.offset = i;
+            current.count = 0;
+            current.baseVertex = vertexRemap.size();
+        }
+        for(unsigned int j = 0; j < 3; ++j) {
+            unsigned int v = indices[i + j];
+            if(owner[v] != subMeshes.size()) {
+                owner[v] = subMeshes.size();
+                local[v] = vertexRemap.size() - current.baseVertex;
+                vertexRemap.push_back(v);
+            }
+            indices[i + j] = local[v];
+        }
+        current.count += 3;
+    }
+    subMeshes.push_back(current);
+    return subMeshes;
+}
+
+// static
+void MeshOptimizer::stripify(std::vector<unsigned int>& indices, unsigned int vertexCount) {
+    checkIndices(indices, vertexCount);
+    unsigned int triangleCount = indices.size()/3;
+
+    // Triangles around every vertex
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for(unsigned int index : indices) ++offsets[index + 1];
+    for(unsigned int v = 0; v < vertexCount; ++v) offsets[v+1] += offsets[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+    for(unsigned int i = 0; i < indices.size(); ++i) adjacency[cursor[indices[i]]++] = i/3;
+
+    std::vector<bool> emitted(triangleCount, false);
+    // Finds a triangle left with the directed edge a -> b, returns its third vertex
+    auto findTriangle = [&](unsigned int a, unsigned int b, unsigned int& triangle) -> unsigned int {
+        for(unsigned int k = offsets[b]; k < offsets[b+1]; ++k) {
+            unsigned int t = adjacency[k];
+            if(emitted[t]) continue;
+            for(unsigned int j = 0; j < 3; ++j) {
+                if(indices[t*3 + j] == a && indices[t*3 + (j+1)%3] == b) {
+                    triangle = t;
+                    return indices[t*3 + (j+2)%3];
+                }
+            }
+        }
+        triangle = ~0u;
+        return 0;
+    };
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    unsigned int triangle;
+    for(unsigned int start = 0; start < triangleCount; ++start) {
+        if(emitted[start]) continue;
+        emitted[start] = true;
+
+        // The second triangle of a strip winds the other way, so it needs the edge c -> b.
+        // Start from the rotation that has one, if any.
+        const unsigned int* t = &indices[start*3];
+        unsigned int rotation = 0;
+        for(unsigned int r = 0; r < 3; ++r) {
+            findTriangle(t[(r+2)%3], t[(r+1)%3], triangle);
+            if(triangle != ~0u) {
+                rotation = r;
+                break;
+            }
+        }
+        if(!result.empty()) result.push_back(MeshIndexed::restartIndex);
+        for(unsigned int j = 0; j < 3; ++j)
+            result.push_back(t[(rotation + j)%3]);
+
+        for(unsigned int n = 1; ; ++n) {
+            unsigned int a = result[result.size() - 2], b = result[result.size() - 1];
+            unsigned int next = (n%2 == 1 ? findTriangle(b, a, triangle) : findTriangle(a, b, triangle));
+            if(triangle == ~0u) break;
+            emitted[triangle] = true;
+            result.push_back(next);
+        }
+    }
+    indices.swap(result);
+}
@@ -0,0 +1,210 @@
+#include <cmath>
+#include <cstring>
+
+#include <VBE/graphics/MeshQuantizer.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    enum Role {
+        Copy,
+        Position,
+        Direction,
+        Texcoord
+    };
+
+    Role getRole(const Vertex::Attribute& a, const MeshQuantizer::Options& options) {
+        Role role = Copy;
+        if(!options.position.empty() && a.name == options.position) role = Position;
+        else if(!options.normal.empty() && a.name == options.normal) role = Direction;
+        else if(!options.tangent.empty() && a.name == options.tangent) role = Direction;
+#ifndef VBE_GLES2
+        else if(!options.texcoord.empty() && a.name == options.texcoord) role = Texcoord;
+#endif
+        VBE_ASSERT(role == Copy || (a.type == Vertex::Attribute::Float && (a.size == 3 || role == Texcoord)),
+                   "Attribute " << a.name << " must be three floats to be quantized");
+        return role;
+    }
+
+    unsigned int getAttributeSize(const Vertex::Format& format, unsigned int i) {
+        return (i + 1 < format.elementCount() ? format.offset(i + 1) : format.vertexSize()) - format.offset(i);
+    }
+
+    template<typename T>
+    inline T toNormalized(float v, float max) {
+        return T(std::floor(glm::clamp(v, -1.0f, 1.0f)*max + 0.5f));
+    }
+}
+
+mat4f MeshQuantizer::Dequantization::getTransform() const {
+    mat4f m(1.0f);
+    m[0][0] = scale.x;
+    m[1][1] = scale.y;
+    m[2][2] = scale.z;
+    m[3] = vec4f(offset, 1.0f);
+    return m;
+}
+
+// static
+Vertex::Format MeshQuantizer::getQuantizedFormat(const Vertex::Format& format, const Options& options) {
+    std::vector<Vertex::Attribute> elements;
+    for(unsigned int i = 0; i < format.elementCount(); ++i) {
+        const Vertex::Attribute& a = format.element(i);
+        switch(getRole(a, options)) {
+            case Position:
+                elements.push_back(Vertex::Attribute(a.name, Vertex::Attribute::UnsignedShort, 4, Vertex::Attribute::ConvertToFloatNormalized, a.divisor));
+                break;
+            case Direction:
+                elements.push_back(Vertex::Attribute(a.name, options.highPrecisionNormals ? Vertex::Attribute::Short : Vertex::Attribute::Byte, 2,
+                                                     Vertex::Attribute::ConvertToFloatNormalized, a.divisor));
+                break;
+#ifndef VBE_GLES2
+            case Texcoord:
+                elements.push_back(Vertex::Attribute(a.name, Vertex::Attribute::HalfFloat, a.size, Vertex::Attribute::ConvertToFloat, a.divisor));
+                break;
+#endif
+            default:
+                elements.push_back(a);
+                break;
+        }
+    }
+    return Vertex::Format(elements);
+}
+
+// static
+MeshQuantizer::Dequantization MeshQuantizer::getDequantization(const AABB& box) {
+    Dequantization d;
+    vec3f boxMin = box.getMin(), boxMax = box.getMax();
+    // Empty boxes and flat axes keep a zero scale, every position maps to the offset
+    for(int i = 0; i < 3; ++i) {
+        if(boxMax[i] >= boxMin[i]) {
+            d.offset[i] = boxMin[i];
+            d.scale[i] = boxMax[i] - boxMin[i];
+        }
+    }
+    return d;
+}
+
+// static
+Vertex::Format MeshQuantizer::quantize(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                                       const AABB& box, const Options& options, std::vector<char>& result) {
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+    Vertex::Format quantized = getQuantizedFormat(format, options);
+    std::vector<Role> roles;
+    for(unsigned int i = 0; i < format.elementCount(); ++i)
+        roles.push_back(getRole(format.element(i), options));
+    Dequantization d = getDequantization(box);
+    vec3f inverseScale(0.0f);
+    for(int i = 0; i < 3; ++i)
+        if(d.scale[i] > 0.0f) inverseScale[i] = 1.0f/d.scale[i];
+
+    result.resize(std::size_t(vertexCount)*quantized.vertexSize());
+    for(unsigned int v = 0; v < vertexCount; ++v) {
+        const char* source = (const char*) vertexData + std::size_t(v)*format.vertexSize();
+        char* target = &result[std::size_t(v)*quantized.vertexSize()];
+        for(unsigned int i = 0; i < format.elementCount(); ++i) {
+            const char* s = source + format.offset(i);
+            char* t = target + quantized.offset(i);
+            switch(roles[i]) {
+                case Position: {
+                    vec3f p;
+                    std::memcpy(&p, s, sizeof(p));
+                    p = glm::clamp((p - d.offset)*inverseScale, 0.0f, 1.0f);
+                    GLushort q[4] = {toNormalized<GLushort>(p.x, 65535.0f), toNormalized<GLushort>(p.y, 65535.0f),
+                                     toNormalized<GLushort>(p.z, 65535.0f), 65535};
+                    std::memcpy(t, q, sizeof(q));
+                    break;
+                }
+                case Direction: {
+                    vec3f n;
+                    std::memcpy(&n, s, sizeof(n));
+                    vec2f e = encodeOctahedral(n);
+                    if(options.highPrecisionNormals) {
+                        GLshort q[2] = {toNormalized<GLshort>(e.x, 32767.0f), toNormalized<GLshort>(e.y, 32767.0f)};
+                        std::memcpy(t, q, sizeof(q));
+                    }
+                    else {
+                        GLbyte q[2] = {toNormalized<GLbyte>(e.x, 127.0f), toNormalized<GLbyte>(e.y, 127.0f)};
+                        std::memcpy(t, q, sizeof(q));
+                    }
+                    break;
+                }
+                case Texcoord: {
+                    for(unsigned int c = 0; c < format.element(i).size; ++c) {
+                        float f;
+                        std::memcpy(&f, s + c*sizeof(float), sizeof(float));
+                        GLushort h = floatToHalf(f);
+                        std::memcpy(t + c*sizeof(GLushort), &h, sizeof(h));
+                    }
+                    break;
+                }
+                default:
+                    std::memcpy(t, s, getAttributeSize(format, i));
+                    break;
+            }
+        }
+    }
+    return quantized;
+}
+
+// static
+vec2f MeshQuantizer::encodeOctahedral(const vec3f& v) {
+    float length = std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z);
+    if(!(length > 0.0f)) return vec2f(0.0f);
+    vec2f e = vec2f(v.x, v.y)/length;
+    if(v.z < 0.0f)
+        e = (1.0f - glm::abs(vec2f(e.y, e.x)))*vec2f(e.x >= 0.0f ? 1.0f : -1.0f, e.y >= 0.0f ? 1.0f : -1.0f);
+    return e;
+}
+
+// static
+vec3f MeshQuantizer::decodeOctahedral(const vec2f& e) {
+    vec3f v(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+    if(v.z < 0.0f) {
+        vec2f folded = (1.0f - glm::abs(vec2f(v.y, v.x)))*vec2f(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+        v.x = folded.x;
+        v.y = folded.y;
+    }
+    return glm::normalize(v);
+}
+
+// static
+GLushort MeshQuantizer::floatToHalf(float f) {
+    unsigned int x;
+    std::memcpy(&x, &f, sizeof(x));
+    unsigned int sign = (x >> 16) & 0x8000;
+    unsigned int bits = x & 0x7FFFFFFF;
+    if(bits > 0x7F800000) return sign | 0x7E00; // nan
+    if(bits >= 0x47800000) return sign | 0x7C00; // inf, or too large
+    if(bits < 0x38800000) {
+        // Subnormal: 2^-24 steps
+        if(bits < 0x33000000) return sign;
+        unsigned int shift = 126 - (bits >> 23);
+        unsigned int mantissa = (bits & 0x7FFFFF) | 0x800000;
+        unsigned int h = mantissa >> shift;
+        unsigned int rest = mantissa & ((1u << shift) - 1);
+        unsigned int half = 1u << (shift - 1);
+        if(rest > half || (rest == half && (h & 1))) ++h;
+        return sign | h;
+    }
+    // Rebias the exponent, a carry out of the mantissa rounds up to the next one (or inf)
+    unsigned int h = (bits - 0x38000000) >> 13;
+    unsigned int rest = bits & 0x1FFF;
+    if(rest > 0x1000 || (rest == 0x1000 && (h & 1))) ++h;
+    return sign | h;
+}
+
+// static
+float MeshQuantizer::halfToFloat(GLushort h) {
+    unsigned int sign = (unsigned int) (h & 0x8000) << 16;
+    unsigned int exponent = (h >> 10) & 0x1F;
+    unsigned int mantissa = h & 0x3FF;
+    float f;
+    if(exponent == 0) {
+        f = std::ldexp(float(mantissa), -24);
+        if(sign) f = -f;
+        return f;
+    }
+    unsigned int x = sign | (exponent == 31 ? 0x7F800000 | (mantissa << 13) : ((exponent + 112) << 23) | (mantissa << 13));
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
@@ -0,0 +1,435 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include <VBE/graphics/MeshSimplifier.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    // Sum of weighted squared distances to a set of planes. Doubles, since
+    // it adds up the planes of every triangle that collapsed into a vertex.
+    struct Quadric {
+            double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+            double b0 = 0.0, b1 = 0.0, b2 = 0.0, c = 0.0;
+            double weight = 0.0;
+
+            void addPlane(const vec3f& n, float d, float w) {
+                a00 += w*n.x*n.x; a01 += w*n.x*n.y; a02 += w*n.x*n.z;
+                a11 += w*n.y*n.y; a12 += w*n.y*n.z; a22 += w*n.z*n.z;
+                b0 += w*d*n.x; b1 += w*d*n.y; b2 += w*d*n.z;
+                c += w*d*d;
+                weight += w;
+            }
+
+            void add(const Quadric& q) {
+                a00 += q.a00; a01 += q.a01; a02 += q.a02;
+                a11 += q.a11; a12 += q.a12; a22 += q.a22;
+                b0 += q.b0; b1 += q.b1; b2 += q.b2;
+                c += q.c;
+                weight += q.weight;
+            }
+
+            double evaluate(const vec3f& p) const {
+                double x = p.x, y = p.y, z = p.z;
+                double e = a00*x*x + a11*y*y + a22*z*z + 2.0*(a01*x*y + a02*x*z + a12*y*z) + 2.0*(b0*x + b1*y + b2*z) + c;
+                return std::max(e, 0.0);
+            }
+    };
+
+    struct AttributeCost {
+            unsigned int offset;
+            unsigned int size;
+            double weight;
+    };
+
+    struct Edge {
+            std::uint64_t key;
+            bool forward;
+
+            bool operator<(const Edge& e) const {
+                return key < e.key;
+            }
+    };
+
+    struct Collapse {
+            unsigned int from, to;
+            unsigned int triangles; // on the edge, 1 on borders and 2 elsewhere
+            double cost;
+            double positionCost;
+    };
+
+    // Collapses edges in passes. Every pass collapses the cheapest edges whose
+    // surroundings were not touched by an earlier collapse of the same pass,
+    // so everything measured at the start of the pass still holds.
+    class Simplifier {
+        public:
+            Simplifier(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount, const MeshSimplifier::Options& options)
+                : data((const char*) vertexData), vertexSize(format.vertexSize()), lockBorder(options.lockBorder),
+                  positionIds(vertexCount), remap(vertexCount) {
+                unsigned int positionOffset = ~0u;
+                for(unsigned int i = 0; i < format.elementCount(); ++i) {
+                    const Vertex::Attribute& a = format.element(i);
+                    if(a.name == options.position) {
+                        VBE_ASSERT(a.type == Vertex::Attribute::Float && a.size == 3, "Position " << a.name << " must be three floats");
+                        positionOffset = format.offset(i);
+                    }
+                    else if(!options.normal.empty() && a.name == options.normal) {
+                        VBE_ASSERT(a.type == Vertex::Attribute::Float && a.size == 3, "Normal " << a.name << " must be three floats");
+                        attributes.push_back({format.offset(i), 3, options.normalWeight});
+                    }
+                    else if(!options.texcoord.empty() && a.name == options.texcoord) {
+                        VBE_ASSERT(a.type == Vertex::Attribute::Float && a.size == 2, "Texcoord " << a.name << " must be two floats");
+                        attributes.push_back({format.offset(i), 2, options.texcoordWeight});
+                    }
+                }
+                VBE_ASSERT(positionOffset != ~0u, "Vertex format has no position attribute " << options.position);
+
+                // Vertices with the same position are the same point of the surface
+                std::vector<unsigned int> order(vertexCount);
+                std::vector<vec3f> vertexPositions(vertexCount);
+                for(unsigned int v = 0; v < vertexCount; ++v) {
+                    order[v] = v;
+                    std::memcpy(&vertexPositions[v], data + std::size_t(v)*vertexSize + positionOffset, sizeof(vec3f));
+                    remap[v] = v;
+                }
+                std::sort(order.begin(), order.end(), [&vertexPositions](unsigned int a, unsigned int b) {
+                    return std::memcmp(&vertexPositions[a], &vertexPositions[b], sizeof(vec3f)) < 0;
+                });
+                for(unsigned int i = 0; i < vertexCount; ++i) {
+                    unsigned int v = order[i];
+                    if(i == 0 || std::memcmp(&vertexPositions[v], &vertexPositions[order[i-1]], sizeof(vec3f)) != 0)
+                        positions.push_back(vertexPositions[v]);
+                    positionIds[v] = positions.size() - 1;
+                }
+                quadrics.resize(positions.size());
+                border.resize(positions.size());
+                locked.resize(positions.size());
+                touched.resize(positions.size());
+                offsets.resize(positions.size() + 1);
+            }
+
+            float run(const std::vector<unsigned int>& indices, std::vector<unsigned int>& result, unsigned int targetIndexCount, float maxError) {
+                triangles.clear();
+                AABB box;
+                for(unsigned int i = 0; i < indices.size(); i += 3) {
+                    if(!isDegenerate(&indices[i])) triangles.insert(triangles.end(), &indices[i], &indices[i] + 3);
+                    for(unsigned int j = 0; j < 3; ++j) box.extend(positions[positionIds[indices[i + j]]]);
+                }
+                // Attribute costs are relative to the size of the mesh, so weights do not depend on its scale
+                float radius = (indices.empty() ? 0.0f : box.getRadius());
+                for(AttributeCost& a : attributes)
+                    a.weight *= double(radius)*radius;
+
+                for(unsigned int t = 0; t < triangles.size()/3; ++t) {
+                    vec3f p[3];
+                    getPositions(t, p);
+                    vec3f n = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    float length = glm::length(n);
+                    if(length <= 0.0f) continue;
+                    n /= length;
+                    for(unsigned int j = 0; j < 3; ++j)
+                        quadrics[positionIds[triangles[t*3 + j]]].addPlane(n, -glm::dot(n, p[0]), length*0.5f);
+                }
+                // Borders get a plane through them, perpendicular to their triangle, so they keep their outline
+                classify();
+                for(unsigned int t = 0; t < triangles.size()/3; ++t) {
+                    vec3f p[3];
+                    getPositions(t, p);
+                    vec3f n = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    for(unsigned int j = 0; j < 3; ++j) {
+                        unsigned int a = positionIds[triangles[t*3 + j]], b = positionIds[triangles[t*3 + (j+1)%3]];
+                        if(!isBorderEdge(a, b)) continue;
+                        vec3f e = p[(j+1)%3] - p[j];
+                        vec3f m = glm::cross(e, n);
+                        float length = glm::length(m);
+                        if(length <= 0.0f) continue;
+                        m /= length;
+                        float w = glm::dot(e, e);
+                        quadrics[a].addPlane(m, -glm::dot(m, p[j]), w);
+                        quadrics[b].addPlane(m, -glm::dot(m, p[j]), w);
+                    }
+                }
+
+                double maxCost = double(maxError)*maxError;
+                double error = 0.0;
+                targetIndexCount -= targetIndexCount%3;
+                while(triangles.size() > targetIndexCount) {
+                    if(collapsePass(targetIndexCount, maxCost, error) == 0) break;
+                }
+                result = triangles;
+                return float(std::sqrt(error));
+            }
+
+        private:
+            bool isDegenerate(const unsigned int* t) const {
+                unsigned int a = positionIds[t[0]], b = positionIds[t[1]], c = positionIds[t[2]];
+                return a == b || b == c || a == c;
+            }
+
+            void getPositions(unsigned int t, vec3f* p) const {
+                for(unsigned int j = 0; j < 3; ++j)
+                    p[j] = positions[positionIds[triangles[t*3 + j]]];
+            }
+
+            static std::uint64_t edgeKey(unsigned int a, unsigned int b) {
+                return a < b ? (std::uint64_t(a) << 32) | b : (std::uint64_t(b) << 32) | a;
+            }
+
+            bool isBorderEdge(unsigned int a, unsigned int b) const {
+                Edge e = {edgeKey(a, b), false};
+                std::vector<Edge>::const_iterator it = std::lower_bound(edges.begin(), edges.end(), e);
+                return it != edges.end() && it->key == e.key && (it + 1 == edges.end() || (it + 1)->key != e.key);
+            }
+
+            // Finds the triangles around every position, the open borders and
+            // the positions that are not manifold, which are never collapsed
+            void classify() {
+                std::fill(offsets.begin(), offsets.end(), 0);
+                for(unsigned int index : triangles) ++offsets[positionIds[index] + 1];
+                for(unsigned int p = 0; p < positions.size(); ++p) offsets[p+1] += offsets[p];
+                adjacency.resize(triangles.size());
+                std::vector<unsigned int> cursor(offsets.begin(), offsets.end() - 1);
+                for(unsigned int i = 0; i < triangles.size(); ++i) adjacency[cursor[positionIds[triangles[i]]]++] = i/3;
+
+                edges.clear();
+                for(unsigned int i = 0; i < triangles.size(); ++i) {
+                    unsigned int a = positionIds[triangles[i]], b = positionIds[triangles[i - i%3 + (i+1)%3]];
+                    Edge e = {edgeKey(a, b), a < b};
+                    edges.push_back(e);
+                }
+                std::sort(edges.begin(), edges.end());
+
+                std::fill(border.begin(), border.end(), false);
+                std::fill(locked.begin(), locked.end(), false);
+                for(unsigned int i = 0; i < edges.size(); ) {
+                    unsigned int j = i + 1;
+                    while(j < edges.size() && edges[j].key == edges[i].key) ++j;
+                    unsigned int a = unsigned(edges[i].key >> 32), b = unsigned(edges[i].key);
+                    if(j - i == 1) {
+                        border[a] = border[b] = true;
+                        if(lockBorder) locked[a] = locked[b] = true;
+                    }
+                    // Edges shared by more than two triangles, or by two facing opposite ways
+                    else if(j - i > 2 || edges[i].forward == edges[i+1].forward)
+                        locked[a] = locked[b] = true;
+                    i = j;
+                }
+            }
+
+            // Pairs every vertex at position from with the vertex at position to it becomes.
+            // Fails when a vertex would need two different ones, or has none.
+            bool mapWedges(unsigned int from, unsigned int to, std::vector<std::pair<unsigned int, unsigned int>>& wedges) const {
+                wedges.clear();
+                for(unsigned int k = offsets[from]; k < offsets[from+1]; ++k) {
+                    const unsigned int* t = &triangles[adjacency[k]*3];
+                    unsigned int wedge = ~0u, target = ~0u;
+                    for(unsigned int j = 0; j < 3; ++j) {
+                        if(positionIds[t[j]] == from) wedge = t[j];
+                        else if(positionIds[t[j]] == to) target = t[j];
+                    }
+                    bool found = false;
+                    for(std::pair<unsigned int, unsigned int>& w : wedges) {
+                        if(w.first != wedge) continue;
+                        found = true;
+                        if(w.second == ~0u) w.second = target;
+                        else if(target != ~0u && w.second != target) return false;
+                    }
+                    if(!found) wedges.push_back(std::make_pair(wedge, target));
+                }
+                for(const std::pair<unsigned int, unsigned int>& w : wedges)
+                    if(w.second == ~0u) return false;
+                return true;
+            }
+
+            bool getCost(unsigned int from, unsigned int to, Collapse& c) {
+                if(!mapWedges(from, to, wedges)) return false;
+                Quadric q = quadrics[from];
+                q.add(quadrics[to]);
+                c.from = from;
+                c.to = to;
+                c.positionCost = (q.weight > 0.0 ? q.evaluate(positions[to])/q.weight : 0.0);
+                c.cost = c.positionCost;
+                for(const std::pair<unsigned int, unsigned int>& w : wedges) {
+                    for(const AttributeCost& a : attributes) {
+                        float x[3], y[3];
+                        std::memcpy(x, data + std::size_t(w.first)*vertexSize + a.offset, a.size*sizeof(float));
+                        std::memcpy(y, data + std::size_t(w.second)*vertexSize + a.offset, a.size*sizeof(float));
+                        for(unsigned int i = 0; i < a.size; ++i)
+                            c.cost += a.weight*(x[i] - y[i])*(x[i] - y[i]);
+                    }
+                }
+                return true;
+            }
+
+            void getNeighbours(unsigned int p, std::vector<unsigned int>& result) const {
+                result.clear();
+                for(unsigned int k = offsets[p]; k < offsets[p+1]; ++k)
+                    for(unsigned int j = 0; j < 3; ++j) {
+                        unsigned int q = positionIds[triangles[adjacency[k]*3 + j]];
+                        if(q != p && std::find(result.begin(), result.end(), q) == result.end()) result.push_back(q);
+                    }
+            }
+
+            // Only the triangles on the edge may share both ends, or the collapse would pinch the surface
+            bool keepsManifold(const Collapse& c) {
+                getNeighbours(c.from, neighboursFrom);
+                getNeighbours(c.to, neighboursTo);
+                unsigned int shared = 0;
+                for(unsigned int p : neighboursFrom)
+                    if(std::find(neighboursTo.begin(), neighboursTo.end(), p) != neighboursTo.end()) ++shared;
+                return shared <= c.triangles;
+            }
+
+            bool flipsTriangles(const Collapse& c) const {
+                for(unsigned int k = offsets[c.from]; k < offsets[c.from+1]; ++k) {
+                    unsigned int t = adjacency[k];
+                    vec3f p[3], moved[3];
+                    getPositions(t, p);
+                    bool removed = false;
+                    for(unsigned int j = 0; j < 3; ++j) {
+                        unsigned int id = positionIds[triangles[t*3 + j]];
+                        removed = removed || id == c.to;
+                        moved[j] = (id == c.from ? positions[c.to] : p[j]);
+                    }
+                    if(removed) continue;
+                    vec3f before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    vec3f after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                    if(glm::dot(before, after) <= 0.25f*glm::length(before)*glm::length(after)) return true;
+                }
+                return false;
+            }
+
+            unsigned int collapsePass(unsigned int targetIndexCount, double maxCost, double& error) {
+                classify();
+                std::vector<Collapse> collapses;
+                for(unsigned int i = 0; i < edges.size(); ) {
+                    unsigned int j = i + 1;
+                    while(j < edges.size() && edges[j].key == edges[i].key) ++j;
+                    unsigned int a = unsigned(edges[i].key >> 32), b = unsigned(edges[i].key);
+                    Collapse best, c;
+                    best.cost = -1.0;
+                    best.triangles = c.triangles = j - i;
+                    // Borders only slide along themselves
+                    for(unsigned int d = 0; d < 2 && j - i <= 2; ++d) {
+                        unsigned int from = (d == 0 ? a : b), to = (d == 0 ? b : a);
+                        if(locked[from] || (border[from] && (j - i != 1 || !border[to]))) continue;
+                        if(getCost(from, to, c) && (best.cost < 0.0 || c.cost < best.cost)) best = c;
+                    }
+                    if(best.cost >= 0.0) collapses.push_back(best);
+                    i = j;
+                }
+                std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+                    return a.cost < b.cost;
+                });
+
+                std::fill(touched.begin(), touched.end(), false);
+                unsigned int triangleCount = triangles.size()/3, targetTriangles = targetIndexCount/3;
+                unsigned int removed = 0, collapsed = 0;
+                for(const Collapse& c : collapses) {
+                    if(triangleCount - removed <= targetTriangles) break;
+                    if(touched[c.from] || touched[c.to] || c.positionCost > maxCost) continue;
+                    if(!keepsManifold(c) || flipsTriangles(c)) continue;
+                    mapWedges(c.from, c.to, wedges);
+                    for(const std::pair<unsigned int, unsigned int>& w : wedges)
+                        remap[w.first] = w.second;
+                    quadrics[c.to].add(quadrics[c.from]);
+                    touched[c.from] = touched[c.to] = true;
+                    for(unsigned int p : neighboursFrom) touched[p] = true;
+                    removed += c.triangles;
+                    error = std::max(error, c.positionCost);
+                    ++collapsed;
+                }
+
+                unsigned int kept = 0;
+                for(unsigned int i = 0; i < triangles.size(); i += 3) {
+                    unsigned int t[3] = {remap[triangles[i]], remap[triangles[i + 1]], remap[triangles[i + 2]]};
+                    if(isDegenerate(t)) continue;
+                    std::memcpy(&triangles[kept], t, sizeof(t));
+                    kept += 3;
+                }
+                triangles.resize(kept);
+                return collapsed;
+            }
+
+            const char* data;
+            unsigned int vertexSize;
+            bool lockBorder;
+            std::vector<AttributeCost> attributes;
+            std::vector<unsigned int> positionIds; // per vertex
+            std::vector<unsigned int> remap; // per vertex, the vertex it collapsed into
+            std::vector<vec3f> positions;
+            std::vector<Quadric> quadrics;
+            std::vector<bool> border;
+            std::vector<bool> locked;
+            std::vector<bool> touched;
+            std::vector<unsigned int> offsets;
+            std::vector<unsigned int> adjacency;
+            std::vector<Edge> edges;
+            std::vector<unsigned int> triangles;
+            std::vector<std::pair<unsigned int, unsigned int>> wedges;
+            std::vector<unsigned int> neighboursFrom;
+            std::vector<unsigned int> neighboursTo;
+    };
+}
+
+// static
+float MeshSimplifier::simplify(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                               const std::vector<unsigned int>& indices, std::vector<unsigned int>& result,
+                               unsigned int targetIndexCount, float maxError, const Options& options) {
+    VBE_ASSERT(indices.size()%3 == 0, "Index count must be a multiple of 3");
+    VBE_ASSERT(vertexData != nullptr || vertexCount == 0, "Vertex data cannot be nullptr");
+#ifdef VBE_DEBUG
+    for(unsigned int index : indices)
+        VBE_ASSERT(index < vertexCount, "Index " << index << " is out of range, there are " << vertexCount << " vertices");
+#endif
+    Simplifier simplifier(format, vertexData, vertexCount, options);
+    return simplifier.run(indices, result, targetIndexCount, maxError);
+}
+
+// static
+std::vector<MeshSimplifier::Lod> MeshSimplifier::buildLods(const Vertex::Format& format, const void* vertexData, unsigned int vertexCount,
+                                                           const std::vector<unsigned int>& indices, std::vector<unsigned int>& result,
+                                                           unsigned int levels, float ratio, const Options& options) {
+    VBE_ASSERT(ratio > 0.0f && ratio < 1.0f, "Ratio must be between 0 and 1");
+    std::vector<Lod> lods;
+    result = indices;
+    Lod full;
+    full.count = indices.size();
+    lods.push_back(full);
+
+    std::vector<unsigned int> current = indices, next;
+    for(unsigned int level = 1; level < levels; ++level) {
+        unsigned int target = (unsigned int)(current.size()*ratio);
+        float error = simplify(format, vertexData, vertexCount, current, next, target, std::numeric_limits<float>::max(), options);
+        // Errors add up, since every level is measured against the one before it
+        if(next.empty() || next.size() > current.size()*(1.0f + ratio)*0.5f) break;
+        Lod lod;
+        lod.offset = result.size();
+        lod.count = next.size();
+        lod.error = lods.back().error + error;
+        lods.push_back(lod);
+        result.insert(result.end(), next.begin(), next.end());
+        current.swap(next);
+    }
+    return lods;
+}
+
+// static
+unsigned int MeshSimplifier::selectLod(const std::vector<Lod>& lods, const AABB& box, const mat4f& viewProjection,
+                                       float viewportHeight, float pixelError) {
+    // The rows of the matrix that give clip y and w are scaled by the model and view, but not
+    // rotated out of length, so they turn object space lengths into clip space ones
+    vec4f center = viewProjection*vec4f(box.getCenter(), 1.0f);
+    float yScale = glm::length(vec3f(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1]));
+    float wScale = glm::length(vec3f(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3]));
+    float distance = center.w - box.getRadius()*wScale;
+    if(!(distance > 0.0f)) return 0;
+
+    float pixelsPerUnit = yScale/distance*viewportHeight*0.5f;
+    unsigned int level = 0;
+    for(unsigned int i = 1; i < lods.size(); ++i)
+        if(lods[i].error*pixelsPerUnit <= pixelError) level = i;
+    return level;
+}
@@ -1,23 +1,649 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
 #include <VBE/graphics/Mesh.hpp>
+#include <VBE/graphics/MeshCache.hpp>
 #include <VBE/graphics/MeshIndexed.hpp>
+#include <VBE/graphics/MeshOptimizer.hpp>
+#include <VBE/graphics/MeshQuantizer.hpp>
+#include <VBE/graphics/MeshSimplifier.hpp>
 #include <VBE/graphics/OBJLoader.hpp>
 #include <VBE/math.hpp>
 #include <VBE/system/Log.hpp>
+#include <VBE/system/Profiler.hpp>
+#include <VBE/system/Storage.hpp>
 
 std::string OBJLoader::positionAttribName = "position";
 std::string OBJLoader::normalAttribName = "normal";
 std::string OBJLoader::texcoordAttribName = "texcoord";
 std::string OBJLoader::tangentAttribName = "tangents";
+unsigned int OBJLoader::threadCount = 0;
+std::string OBJLoader::cachePath = "";
+bool OBJLoader::optimize = false;
+bool OBJLoader::quantize = false;
+bool OBJLoader::highPrecisionNormals = true;
+bool OBJLoader::triangleStrips = false;
+unsigned int OBJLoader::lodLevels = 4;
+float OBJLoader::lodRatio = 0.5f;
+
+namespace {
+    // Everything read from an OBJ file. Corners hold the position, texcoord and
+    // normal index of every triangle corner, 1-based and 0 when missing.
+    struct OBJData {
+            std::vector<vec3f> positions;
+            std::vector<vec3f> normals;
+            std::vector<vec2f> texcoords;
+            std::vector<vec3i> corners;
+            AABB box;
+    };
+
+    // The parser works on a null-terminated buffer, so it may always look one
+    // character ahead: '\0' and '\n' stop every token.
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline bool isDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    inline const char* skipSpaces(const char* p) {
+        while(isSpace(*p)) ++p;
+        return p;
+    }
+
+    inline const char* nextLine(const char* p, const char* end) {
+        const char* n = (const char*) std::memchr(p, '\n', end - p);
+        return n == nullptr ? end : n + 1;
+    }
+
+    const double powersOf10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    // Exact for up to 15 significant digits and small exponents, which covers what
+    // exporters write. Anything else goes through strtod.
+    const char* parseFloat(const char* p, float& value) {
+        p = skipSpaces(p);
+        const char* start = p;
+        bool negative = false;
+        if(*p == '-' || *p == '+') negative = (*p++ == '-');
+
+        unsigned long long mantissa = 0;
+        int digits = 0, exponent = 0;
+        bool any = false;
+        for(; isDigit(*p); ++p, any = true) {
+            if(digits < 19) {
+                mantissa = mantissa*10 + (*p - '0');
+                if(mantissa != 0) ++digits;
+            }
+            else ++exponent;
+        }
+        if(*p == '.') {
+            for(++p; isDigit(*p); ++p, any = true) {
+                if(digits < 19) {
+                    mantissa = mantissa*10 + (*p - '0');
+                    if(mantissa != 0) ++digits;
+                    --exponent;
+                }
+            }
+        }
+        if(any && (*p == 'e' || *p == 'E')) {
+            const char* e = p + 1;
+            bool negativeExponent = false;
+            if(*e == '-' || *e == '+') negativeExponent = (*e++ == '-');
+            if(isDigit(*e)) {
+                int n = 0;
+                for(; isDigit(*e); ++e)
+                    if(n < 10000) n = n*10 + (*e - '0');
+                exponent += negativeExponent ? -n : n;
+                p = e;
+            }
+        }
+
+        if(any && mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+            double d = double(mantissa);
+            d = exponent < 0 ? d/powersOf10[-exponent] : d*powersOf10[exponent];
+            value = float(negative ? -d : d);
+            return p;
+        }
+        if(*start == '\n' || *start == '\0') {
+            value = 0.0f;
+            return start;
+        }
+        // Long mantissas, huge exponents, nan and inf
+        char* end = nullptr;
+        value = float(std::strtod(start, &end));
+        return end == start ? start : end;
+    }
+
+    // Resolves negative indices, which count backwards from the last element read
+    inline const char* parseIndex(const char* p, int count, int& index, bool& relative) {
+        relative = false;
+        if(*p == '-' || *p == '+') relative = (*p++ == '-');
+        int n = 0;
+        for(; isDigit(*p); ++p) n = n*10 + (*p - '0');
+        index = relative ? count - n + 1 : n;
+        return p;
+    }
+
+    // v, v/t, v//n or v/t/n. Bit i of relative is set when component i was negative.
+    inline const char* parseCorner(const char* p, const OBJData& data, vec3i& corner, int& relative) {
+        bool negative = false;
+        corner = vec3i(0);
+        p = parseIndex(p, data.positions.size(), corner.x, negative);
+        relative = negative;
+        if(*p != '/') return p;
+        ++p;
+        if(*p != '/') {
+            p = parseIndex(p, data.texcoords.size(), corner.y, negative);
+            relative |= negative << 1;
+        }
+        if(*p != '/') return p;
+        p = parseIndex(p + 1, data.normals.size(), corner.z, negative);
+        relative |= negative << 2;
+        return p;
+    }
+
+    // A piece of the file, parsed on its own. Negative indices are resolved against
+    // the elements of the chunk, so they are remembered to be fixed up on merge.
+    struct OBJChunk {
+            OBJData data;
+            std::vector<unsigned int> relative; // corner*3 + component
+    };
+
+    inline void addCorner(OBJChunk& chunk, const vec3i& corner, int relative) {
+        for(int i = 0; relative != 0; ++i, relative >>= 1)
+            if(relative & 1) chunk.relative.push_back(chunk.data.corners.size()*3 + i);
+        chunk.data.corners.push_back(corner);
+    }
+
+    // Faces with more than three corners are split as a fan
+    const char* parseFace(const char* p, OBJChunk& chunk) {
+        vec3i first, previous, corner;
+        int firstRelative = 0, previousRelative = 0, relative = 0;
+        for(int n = 0;; ++n) {
+            p = skipSpaces(p);
+            if(!isDigit(*p) && *p != '-' && *p != '+') return p;
+            p = parseCorner(p, chunk.data, corner, relative);
+            if(n == 0) {
+                first = corner;
+                firstRelative = relative;
+            }
+            else if(n >= 2) {
+                addCorner(chunk, first, firstRelative);
+                addCorner(chunk, previous, previousRelative);
+                addCorner(chunk, corner, relative);
+            }
+            previous = corner;
+            previousRelative = relative;
+        }
+    }
 
-struct FunctorComparevec3i{
-        bool operator()(const vec3i& a, const vec3i& b) const {
-            if(a.x != b.x) return a.x < b.x;
-            if(a.y != b.y) return a.y < b.y;
-            if(a.z != b.z) return a.z < b.z;
-            return false;
+    // A cheap first pass, so the arrays are allocated once
+    void reserve(const char* p, const char* end, OBJData& data) {
+        unsigned int positions = 0, normals = 0, texcoords = 0, faces = 0;
+        for(; p < end; p = nextLine(p, end)) {
+            p = skipSpaces(p);
+            if(p[0] == 'v') {
+                if(isSpace(p[1])) ++positions;
+                else if(p[1] == 'n' && isSpace(p[2])) ++normals;
+                else if(p[1] == 't' && isSpace(p[2])) ++texcoords;
+            }
+            else if(p[0] == 'f' && isSpace(p[1])) ++faces;
         }
-};
+        data.positions.reserve(positions);
+        data.normals.reserve(normals);
+        data.texcoords.reserve(texcoords);
+        data.corners.reserve(faces*3);
+    }
 
+    // Parses whole lines from p to end. Tokens never cross a '\n', so
+    // chunks that end on a line boundary can be parsed independently.
+    void parseChunk(const char* p, const char* end, OBJChunk& chunk) {
+        OBJData& data = chunk.data;
+        reserve(p, end, data);
+        for(; p < end; p = nextLine(p, end)) {
+            p = skipSpaces(p);
+            if(p[0] == 'v') {
+                if(isSpace(p[1])) {
+                    vec3f v;
+                    p = parseFloat(p + 1, v.x);
+                    p = parseFloat(p, v.y);
+                    p = parseFloat(p, v.z);
+                    data.positions.push_back(v);
+                    data.box.extend(v);
+                }
+                else if(p[1] == 'n' && isSpace(p[2])) {
+                    vec3f v;
+                    p = parseFloat(p + 2, v.x);
+                    p = parseFloat(p, v.y);
+                    p = parseFloat(p, v.z);
+                    data.normals.push_back(v);
+                }
+                else if(p[1] == 't' && isSpace(p[2])) {
+                    vec2f v;
+                    p = parseFloat(p + 2, v.x);
+                    p = parseFloat(p, v.y);
+                    v.y = 1-v.y;
+                    data.texcoords.push_back(v);
+                }
+            }
+            else if(p[0] == 'f' && isSpace(p[1]))
+                p = parseFace(p + 1, chunk);
+        }
+    }
+
+    // Below these sizes spawning threads costs more than it saves
+    const std::size_t parallelMinBytes = 1 << 20;
+    const std::size_t parallelMinCorners = 1 << 16;
+
+    // Runs f(0) to f(tasks - 1) on up to threads threads, the caller included
+    template<typename Function>
+    void parallelFor(unsigned int tasks, unsigned int threads, const Function& f) {
+        std::atomic<unsigned int> next(0);
+        auto work = [&next, tasks, &f]() {
+            for(unsigned int i = next++; i < tasks; i = next++)
+                f(i);
+        };
+        std::vector<std::thread> workers;
+        for(unsigned int i = 1; i < std::min(threads, tasks); ++i)
+            workers.push_back(std::thread(work));
+        work();
+        for(std::thread& t : workers) t.join();
+    }
+
+    // Splits the buffer in newline-aligned chunks, parses them concurrently and
+    // appends them in order, offsetting the negative indices by what came before.
+    void parse(const std::string& buffer, OBJData& data, unsigned int threads) {
+        const char* begin = buffer.c_str();
+        const char* end = begin + buffer.size();
+        if(threads < 2 || buffer.size() < parallelMinBytes) {
+            OBJChunk chunk;
+            parseChunk(begin, end, chunk);
+            data = std::move(chunk.data);
+            return;
+        }
+
+        VBE_PROFILE_ZONE("OBJLoader::parse");
+        // More chunks than threads, so one slow chunk doesn't hold everyone back
+        unsigned int count = threads*4;
+        std::vector<const char*> bounds(1, begin);
+        for(unsigned int i = 1; i < count; ++i)
+            bounds.push_back(nextLine(std::max(bounds.back(), begin + buffer.size()/count*i), end));
+        bounds.push_back(end);
+
+        std::vector<OBJChunk> chunks(count);
+        parallelFor(count, threads, [&chunks, &bounds](unsigned int i) {
+            parseChunk(bounds[i], bounds[i+1], chunks[i]);
+        });
+
+        // Prefix sums give where every chunk goes in the merged arrays
+        struct Offsets {
+                std::size_t positions, normals, texcoords, corners;
+        };
+        std::vector<Offsets> offsets(count + 1, Offsets{0, 0, 0, 0});
+        for(unsigned int i = 0; i < count; ++i) {
+            const OBJData& c = chunks[i].data;
+            offsets[i+1].positions = offsets[i].positions + c.positions.size();
+            offsets[i+1].normals = offsets[i].normals + c.normals.size();
+            offsets[i+1].texcoords = offsets[i].texcoords + c.texcoords.size();
+            offsets[i+1].corners = offsets[i].corners + c.corners.size();
+            if(!c.positions.empty()) data.box.extend(c.box);
+        }
+        data.positions.resize(offsets[count].positions);
+        data.normals.resize(offsets[count].normals);
+        data.texcoords.resize(offsets[count].texcoords);
+        data.corners.resize(offsets[count].corners);
+
+        parallelFor(count, threads, [&chunks, &offsets, &data](unsigned int i) {
+            OBJChunk& chunk = chunks[i];
+            const Offsets& o = offsets[i];
+            std::copy(chunk.data.positions.begin(), chunk.data.positions.end(), data.positions.begin() + o.positions);
+            std::copy(chunk.data.normals.begin(), chunk.data.normals.end(), data.normals.begin() + o.normals);
+            std::copy(chunk.data.texcoords.begin(), chunk.data.texcoords.end(), data.texcoords.begin() + o.texcoords);
+            std::copy(chunk.data.corners.begin(), chunk.data.corners.end(), data.corners.begin() + o.corners);
+            const int base[3] = {int(o.positions), int(o.texcoords), int(o.normals)};
+            for(unsigned int r : chunk.relative)
+                data.corners[o.corners + r/3][r%3] += base[r%3];
+            chunk = OBJChunk();
+        });
+    }
+
+    inline unsigned int hashCorner(const vec3i& c) {
+        unsigned int h = unsigned(c.x)*0x9E3779B1u ^ unsigned(c.y)*0x85EBCA77u ^ unsigned(c.z)*0xC2B2AE3Du;
+        h ^= h >> 15;
+        h *= 0x2C1B3C6Du;
+        return h ^ (h >> 13);
+    }
+
+    // The table below indexes with the low bits, shards take the high ones
+    inline unsigned int getShard(unsigned int hash, unsigned int shards) {
+        return (unsigned long long) hash*shards >> 32;
+    }
+
+    // Maps corners to vertex ids with open addressing and linear probing. Keys and
+    // ids live in one flat array, so a lookup is usually a single cache miss.
+    class CornerTable {
+        public:
+            explicit CornerTable(std::size_t expected) {
+                std::size_t capacity = 16;
+                while(capacity < expected*2) capacity *= 2;
+                slots.resize(capacity);
+            }
+
+            // Returns the id of the corner, inserting it with id if it's new
+            unsigned int insert(const vec3i& corner, unsigned int hash, unsigned int id) {
+                if((count + 1)*10 > slots.size()*7) grow();
+                std::size_t mask = slots.size() - 1;
+                for(std::size_t i = hash & mask;; i = (i + 1) & mask) {
+                    Slot& slot = slots[i];
+                    if(slot.id == empty) {
+                        slot.corner = corner;
+                        slot.hash = hash;
+                        slot.id = id;
+                        ++count;
+                        return id;
+                    }
+                    if(slot.hash == hash && slot.corner == corner) return slot.id;
+                }
+            }
+
+        private:
+            static const unsigned int empty = ~0u;
+
+            struct Slot {
+                    vec3i corner;
+                    unsigned int hash;
+                    unsigned int id = empty;
+            };
+
+            void grow() {
+                std::vector<Slot> old(slots.size()*2);
+                old.swap(slots);
+                std::size_t mask = slots.size() - 1;
+                for(const Slot& slot : old) {
+                    if(slot.id == empty) continue;
+                    std::size_t i = slot.hash & mask;
+                    while(slots[i].id != empty) i = (i + 1) & mask;
+                    slots[i] = slot;
+                }
+            }
+
+            std::vector<Slot> slots;
+            std::size_t count = 0;
+    };
+
+    // Fills unique with every distinct corner in order of first appearance, and
+    // indices with where each corner landed in it. Tables are sized from expected,
+    // a guess of the distinct corners.
+    //
+    // The parallel path shards the corners by hash, so every distinct corner belongs
+    // to exactly one thread and the tables need no locking. Shards are then
+    // renumbered into first appearance order, so both paths give the same mesh.
+    void deduplicate(const std::vector<vec3i>& corners, std::size_t expected, std::vector<unsigned int>& indices, std::vector<vec3i>& unique, unsigned int threads) {
+        indices.resize(corners.size());
+        if(threads < 2 || corners.size() < parallelMinCorners) {
+            CornerTable table(expected);
+            for(std::size_t i = 0; i < corners.size(); ++i) {
+                indices[i] = table.insert(corners[i], hashCorner(corners[i]), unique.size());
+                if(indices[i] == unique.size()) unique.push_back(corners[i]);
+            }
+            return;
+        }
+
+        VBE_PROFILE_ZONE("OBJLoader::deduplicate");
+        unsigned int shards = threads;
+        unsigned int ranges = threads*4;
+        std::size_t rangeSize = (corners.size() + ranges - 1)/ranges;
+
+        // buckets[range*shards + shard] holds the corners of the range that hash to the shard
+        std::vector<std::vector<unsigned int>> buckets(ranges*shards);
+        parallelFor(ranges, threads, [&](unsigned int r) {
+            std::size_t first = std::min(corners.size(), r*rangeSize);
+            std::size_t last = std::min(corners.size(), first + rangeSize);
+            for(unsigned int s = 0; s < shards; ++s)
+                buckets[r*shards + s].reserve((last - first)/shards + 1);
+            for(std::size_t i = first; i < last; ++i)
+                buckets[r*shards + getShard(hashCorner(corners[i]), shards)].push_back(i);
+        });
+
+        // Walking the ranges in order keeps the local ids in order of first appearance
+        std::vector<std::vector<vec3i>> shardUnique(shards);
+        parallelFor(shards, threads, [&](unsigned int s) {
+            CornerTable table(expected/shards + 1);
+            std::vector<vec3i>& local = shardUnique[s];
+            for(unsigned int r = 0; r < ranges; ++r) {
+                for(unsigned int i : buckets[r*shards + s]) {
+                    indices[i] = table.insert(corners[i], hashCorner(corners[i]), local.size());
+                    if(indices[i] == local.size()) local.push_back(corners[i]);
+                }
+                std::vector<unsigned int>().swap(buckets[r*shards + s]);
+            }
+        });
+
+        std::vector<unsigned int> shardBase(shards + 1, 0);
+        for(unsigned int s = 0; s < shards; ++s)
+            shardBase[s+1] = shardBase[s] + shardUnique[s].size();
+
+        std::vector<unsigned int> remap(shardBase[shards], ~0u);
+        unique.reserve(shardBase[shards]);
+        for(std::size_t i = 0; i < corners.size(); ++i) {
+            unsigned int s = getShard(hashCorner(corners[i]), shards);
+            unsigned int& id = remap[shardBase[s] + indices[i]];
+            if(id == ~0u) {
+                id = unique.size();
+                unique.push_back(shardUnique[s][indices[i]]);
+            }
+            indices[i] = id;
+        }
+    }
+
+    template<typename T>
+    inline T getElement(const std::vector<T>& elements, int index) {
+        return (index > 0 && index <= int(elements.size())) ? elements[index-1] : T(0.0f);
+    }
+
+    // How the loaders turn the parsed data into a mesh
+    struct BuildSettings {
+            unsigned int threads = 1;
+            bool optimize = false;
+            bool quantize = false;
+            bool strips = false;
+            unsigned int lodLevels = 1;
+            float lodRatio = 0.5f;
+            MeshQuantizer::Options quantization;
+            std::string cacheFile = "";
+            unsigned long long cacheKey = 0;
+    };
+
+    BuildSettings makeBuildSettings(unsigned int threads, bool optimize, bool quantize, bool highPrecisionNormals, bool strips) {
+        BuildSettings settings;
+        settings.threads = threads;
+        settings.optimize = optimize;
+        settings.quantize = quantize;
+        // Strips are joined by primitive restart, without it meshes stay triangle lists
+        settings.strips = strips && MeshIndexed::isPrimitiveRestartSupported();
+        settings.quantization.highPrecisionNormals = highPrecisionNormals;
+        return settings;
+    }
+
+    // Cache files are named after the hash of the source and the settings,
+    // so a file whose source changed is simply not looked up anymore
+    MeshSeparate* loadFromCache(const std::string& cachePath, const std::string& source, const std::vector<Vertex::Attribute>& elements,
+                                Mesh::BufferType bufferType, AABB* box, BuildSettings& settings) {
+        if(cachePath.empty()) return nullptr;
+        std::string key = (settings.optimize ? "optimized\n" : "");
+        if(settings.quantize) key += (settings.quantization.highPrecisionNormals ? "quantized16\n" : "quantized8\n");
+        if(settings.strips) key += "strips\n";
+        for(const Vertex::Attribute& a : elements) key += a.name + '\n';
+        settings.cacheKey = MeshCache::hash(source.data(), source.size(), MeshCache::hash(key.data(), key.size()));
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.vbm", settings.cacheKey);
+        settings.cacheFile = cachePath + name;
+        MeshSeparate* mesh = MeshCache::load(settings.cacheFile, settings.cacheKey, bufferType, box);
+        if(mesh != nullptr) VBE_DLOG(" - Loaded from the cache " << settings.cacheFile);
+        return mesh;
+    }
+
+    template<typename Vert, typename MakeVertex>
+    MeshSeparate* buildMesh(const OBJData& data, const std::vector<Vertex::Attribute>& elements, Mesh::BufferType bufferType,
+                            const BuildSettings& settings, std::vector<MeshSimplifier::Lod>* lods, MakeVertex makeVertex) {
+        // Smooth meshes have about one vertex per position, hard edged ones more
+        std::size_t expected = std::max(data.positions.size(), std::max(data.normals.size(), data.texcoords.size()));
+        std::vector<unsigned int> indices;
+        std::vector<vec3i> unique;
+        deduplicate(data.corners, std::min(expected, data.corners.size()), indices, unique, settings.threads);
+
+        Vertex::Format format(elements);
+        if(settings.quantize) format = MeshQuantizer::getQuantizedFormat(format, settings.quantization);
+
+        // Both layouts are known from the counts, only the smaller one is built.
+        // Larger meshes may still get 16 bit indices by splitting them below.
+        std::size_t indexSize = (unique.size() < 0xFFFF ? sizeof(GLushort) : sizeof(GLuint));
+        std::size_t sizeWithIndex = unique.size()*format.vertexSize()+indices.size()*indexSize;
+        std::size_t sizeWithoutIndex = indices.size()*format.vertexSize();
+
+        VBE_DLOG(" - Vertex count without indexes: " << indices.size());
+        VBE_DLOG(" - Vertex count with indexes: " << unique.size() << " (" << indices.size() << ") indexes");
+        VBE_DLOG(" - Size with indexes: " << sizeWithIndex << ". Size without indexes: " << sizeWithoutIndex);
+        std::vector<Vert> vertices;
+        std::vector<MeshIndexed::SubMesh> subMeshes;
+        bool strips = false;
+        // Levels of detail are ranges of indices, so they need them
+        bool indexed = sizeWithoutIndex > sizeWithIndex || lods != nullptr;
+        if(indexed) {
+            vertices.reserve(unique.size());
+            for(const vec3i& corner : unique)
+                vertices.push_back(makeVertex(corner));
+            if(settings.optimize) {
+#ifdef VBE_DETAIL
+                MeshOptimizer::Statistics before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+#endif
+                vertices.resize(MeshOptimizer::optimize(vertices.data(), vertices.size(), sizeof(Vert), indices));
+#ifdef VBE_DETAIL
+                MeshOptimizer::Statistics after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+                VBE_DLOG(" - ACMR " << before.acmr << " -> " << after.acmr << ". ATVR " << before.atvr << " -> " << after.atvr);
+#endif
+            }
+            if(lods != nullptr) {
+                MeshSimplifier::Options options;
+                options.position = settings.quantization.position;
+                options.normal = settings.quantization.normal;
+                options.texcoord = settings.quantization.texcoord;
+                std::vector<unsigned int> chain;
+                *lods = MeshSimplifier::buildLods(Vertex::Format(elements), vertices.data(), vertices.size(), indices, chain,
+                                                  settings.lodLevels, settings.lodRatio, options);
+                // The full detail level is optimized already, the vertex order stays the one it wants
+                for(unsigned int i = 1; settings.optimize && i < lods->size(); ++i) {
+                    const MeshSimplifier::Lod& lod = (*lods)[i];
+                    std::vector<unsigned int> level(chain.begin() + lod.offset, chain.begin() + lod.offset + lod.count);
+                    MeshOptimizer::optimizeVertexCache(level, vertices.size());
+                    std::copy(level.begin(), level.end(), chain.begin() + lod.offset);
+                }
+                indices.swap(chain);
+                VBE_DLOG(" - Built " << lods->size() << " levels of detail, " << indices.size() << " indexes in total");
+            }
+#ifndef VBE_GLES2
+            // Sub-meshes would cut across the levels of detail
+            if(vertices.size() >= 0xFFFF && lods == nullptr) {
+                // Splitting pays off when the duplicated vertices take less than what 16 bit indices save
+                std::vector<unsigned int> split = indices;
+                std::vector<unsigned int> remap;
+                std::vector<MeshIndexed::SubMesh> splitMeshes = MeshOptimizer::splitIndices(split, vertices.size(), remap);
+                if((remap.size() - vertices.size())*format.vertexSize() < indices.size()*(sizeof(GLuint) - sizeof(GLushort))) {
+                    std::vector<Vert> copies;
+                    copies.reserve(remap.size());
+                    for(unsigned int v : remap)
+                        copies.push_back(vertices[v]);
+                    vertices.swap(copies);
+                    indices.swap(split);
+                    subMeshes.swap(splitMeshes);
+                    VBE_DLOG(" - Split in " << subMeshes.size() << " sub-meshes with " << vertices.size() << " vertexes");
+                }
+            }
+            if(settings.strips) {
+                // Every sub-mesh or level of detail becomes strips on its own, so their ranges stay drawable
+                std::vector<MeshIndexed::SubMesh> parts = subMeshes;
+                for(unsigned int i = 0; lods != nullptr && i < lods->size(); ++i) {
+                    MeshIndexed::SubMesh part = {(*lods)[i].offset, (*lods)[i].count, 0};
+                    parts.push_back(part);
+                }
+                if(parts.empty()) {
+                    MeshIndexed::SubMesh whole = {0, (unsigned int) indices.size(), 0};
+                    parts.push_back(whole);
+                }
+                std::vector<unsigned int> stripIndices;
+                for(unsigned int i = 0; i < parts.size(); ++i) {
+                    MeshIndexed::SubMesh& sub = parts[i];
+                    std::vector<unsigned int> part(indices.begin() + sub.offset, indices.begin() + sub.offset + sub.count);
+                    unsigned int end = (i + 1 < subMeshes.size() ? subMeshes[i+1].baseVertex : vertices.size());
+                    MeshOptimizer::stripify(part, end - sub.baseVertex);
+                    sub.offset = stripIndices.size();
+                    sub.count = part.size();
+                    stripIndices.insert(stripIndices.end(), part.begin(), part.end());
+                }
+                VBE_DLOG(" - Triangle strips take " << stripIndices.size() << " indexes, lists " << indices.size());
+                strips = stripIndices.size() < indices.size();
+                if(strips) {
+                    indices.swap(stripIndices);
+                    if(!subMeshes.empty()) subMeshes.swap(parts);
+                    for(unsigned int i = 0; lods != nullptr && i < lods->size(); ++i) {
+                        (*lods)[i].offset = parts[i].offset;
+                        (*lods)[i].count = parts[i].count;
+                    }
+                }
+            }
+#endif
+        }
+        else {
+            vertices.reserve(indices.size());
+            for(unsigned int ind : indices)
+                vertices.push_back(makeVertex(unique[ind]));
+        }
+
+        const void* vertexData = vertices.data();
+        std::vector<char> quantized;
+        if(settings.quantize) {
+            MeshQuantizer::quantize(Vertex::Format(elements), vertices.data(), vertices.size(), data.box, settings.quantization, quantized);
+            vertexData = quantized.data();
+            VBE_DLOG(" - Quantized to " << format.vertexSize() << " bytes per vertex");
+        }
+
+        MeshSeparate* mesh = nullptr;
+        std::vector<GLushort> compacted;
+        bool compact = indexed && MeshIndexed::compactIndices(indices, compacted);
+        MeshIndexed::IndexFormat indexFormat = (compact ? MeshIndexed::UNSIGNED_SHORT : MeshIndexed::UNSIGNED_INT);
+        const void* indexData = (compact ? (const void*) compacted.data() : (const void*) indices.data());
+        Mesh::PrimitiveType primitiveType = (strips ? Mesh::TRIANGLE_STRIP : Mesh::TRIANGLES);
+        if(indexed) {
+            MeshIndexed* indexedMesh = new MeshIndexed(format, bufferType, indexFormat);
+            indexedMesh->setVertexData(vertexData, vertices.size());
+            indexedMesh->setIndexData(indexData, indices.size());
+            indexedMesh->setPrimitiveType(primitiveType);
+#ifndef VBE_GLES2
+            indexedMesh->setSubMeshes(subMeshes);
+            indexedMesh->setPrimitiveRestart(strips);
+#endif
+            mesh = indexedMesh;
+            VBE_DLOG("    Using " << (compact ? 16 : 32) << " bit indexes");
+        }
+        else {
+            mesh = new Mesh(format, bufferType);
+            mesh->setVertexData(vertexData, vertices.size());
+            VBE_DLOG("    Not using indexes");
+        }
+        if(!settings.cacheFile.empty())
+            MeshCache::write(settings.cacheFile, settings.cacheKey, format, data.box, vertexData, vertices.size(),
+                             indexed ? indexData : nullptr, indexed ? indices.size() : 0, indexFormat, primitiveType, strips, subMeshes);
+        return mesh;
+    }
+}
 
 void OBJLoader::setPositionAttribName(const std::string& name) {
     positionAttribName = name;
@@ -35,7 +661,42 @@ void OBJLoader::setTangentAttribName(const std::string& name) {
     tangentAttribName = name;
 }
 
-MeshSeparate* OBJLoader::loadFromOBJStandard(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box) {
+void OBJLoader::setThreadCount(unsigned int threads) {
+    threadCount = threads;
+}
+
+unsigned int OBJLoader::getThreadCount() {
+    if(threadCount != 0) return threadCount;
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void OBJLoader::setCachePath(const std::string& path) {
+    cachePath = path;
+}
+
+void OBJLoader::setOptimize(bool enabled) {
+    optimize = enabled;
+}
+
+void OBJLoader::setQuantize(bool enabled, bool highPrecision) {
+    quantize = enabled;
+    highPrecisionNormals = highPrecision;
+}
+
+void OBJLoader::setTriangleStrips(bool enabled) {
+    triangleStrips = enabled;
+}
+
+void OBJLoader::setLodLevels(unsigned int levels, float ratio) {
+    VBE_ASSERT(levels >= 1, "There is always at least the full detail level");
+    VBE_ASSERT(ratio > 0.0f && ratio < 1.0f, "Ratio must be between 0 and 1");
+    lodLevels = levels;
+    lodRatio = ratio;
+}
+
+MeshSeparate* OBJLoader::loadFromOBJStandard(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box,
+                                             std::vector<MeshSimplifier::Lod>* lods) {
+    VBE_PROFILE_ZONE("OBJLoader::loadFromOBJStandard");
     VBE_DLOG("* Loading new OBJ from file. Expected format: V/T/N");
     std::vector<Vertex::Attribute> elements;
     elements.push_back(Vertex::Attribute(positionAttribName, Vertex::Attribute::Float, 3));
@@ -43,92 +704,42 @@ MeshSeparate* OBJLoader::loadFromOBJStandard(std::unique_ptr<std::istream> in, M
     elements.push_back(Vertex::Attribute(texcoordAttribName, Vertex::Attribute::Float, 2));
 
     struct vert {
-            vert(vec3f pos, vec3f nor, vec2f tex) : pos(pos) , nor(nor), tex(tex) {}
             vec3f pos, nor;
             vec2f tex;
     };
 
-    std::vector<vec3f> vertices;
-    std::vector<vec3f> normals;
-    std::vector<vec2f> textures;
-    std::vector<unsigned int> indices;
-    std::vector<vert> dataIndexed;
-    std::vector<vert> dataNotIndexed;
-    std::map<vec3i, int, FunctorComparevec3i> indexMap;
-
-    AABB loadedBox;
-
-    std::string line;
-    while (getline(*in, line)) {
-        if (line.substr(0, 2) == "v ") {
-            std::istringstream s(line.substr(2));
-            vec3f v;
-            s >> v.x >> v.y >> v.z;
-            vertices.push_back(v);
-
-            loadedBox.extend(v);
-        }
-        else if (line.substr(0, 3) == "vn ") {
-            std::istringstream s(line.substr(3));
-            vec3f v;
-            s >> v.x >> v.y >> v.z;
-            normals.push_back(v);
-        }
-        else if (line.substr(0, 3) == "vt ") {
-            std::istringstream s(line.substr(3));
-            vec2f v;
-            s >> v.x >> v.y;
-            v.y = 1-v.y;
-            textures.push_back(v);
-        }
-        //f 1/1/1 2/2/2 3/3/3
-        else if (line.substr(0, 2) == "f ") {
-            std::istringstream s(line.substr(2));
-            std::vector<vec3i> vInf(3, vec3i(0));
-            char b;
-            s   >> vInf[0].x >> b >> vInf[0].y >> b >> vInf[0].z
-                    >> vInf[1].x >> b >> vInf[1].y >> b >> vInf[1].z
-                    >> vInf[2].x >> b >> vInf[2].y >> b >> vInf[2].z;
-            for(unsigned int i = 0; i < 3; ++i) {
-                std::map<vec3i, int, FunctorComparevec3i>::iterator it = indexMap.find(vInf[i]);
-                int ind = 0;
-                if(it == indexMap.end()) {
-                    ind = indexMap.size();
-                    indexMap.insert(std::pair<vec3i, int>(vInf[i], dataIndexed.size()));
-                    dataIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], textures[vInf[i].y-1]));
-                }
-                else ind = it->second;
-                indices.push_back(ind);
-                dataNotIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], textures[vInf[i].y-1]));
-            }
-        }
-    }
-    int sizeWithIndex = dataIndexed.size()*sizeof(vert)+indices.size()*sizeof(int);
-    int sizeWithoutIndex = dataNotIndexed.size()*sizeof(vert);
+    BuildSettings settings = makeBuildSettings(getThreadCount(), optimize, quantize, highPrecisionNormals, triangleStrips);
+    settings.quantization.position = positionAttribName;
+    settings.quantization.normal = normalAttribName;
+    settings.quantization.texcoord = texcoordAttribName;
+    settings.lodLevels = lodLevels;
+    settings.lodRatio = lodRatio;
+    std::string source = Storage::readToString(std::move(in));
+    // The cache has nowhere to keep the levels of detail
+    if(lods == nullptr)
+        if(MeshSeparate* mesh = loadFromCache(cachePath, source, elements, bufferType, box, settings))
+            return mesh;
 
-    VBE_DLOG(" - Vertex count without indexes: " << dataNotIndexed.size());
-    VBE_DLOG(" - Vertex count with indexes: " << dataIndexed.size() << " (" << indices.size() << ") indexes");
-    VBE_DLOG(" - Size with indexes: " << sizeWithIndex << ". Size without indexes: " << sizeWithoutIndex);
-    MeshSeparate* mesh = nullptr;
-    if(sizeWithoutIndex > sizeWithIndex) { //indexed
-        mesh = new MeshIndexed(Vertex::Format(elements), bufferType);
-        mesh->setVertexData(&dataIndexed[0], dataIndexed.size());
-        ((MeshIndexed*)mesh)->setIndexData(&indices[0], indices.size());
-        VBE_DLOG("    Using indexes");
-    }
-    else { //not indexed
-        mesh = new Mesh(Vertex::Format(elements), bufferType);
-        mesh->setVertexData(&dataNotIndexed[0], dataNotIndexed.size());
-        VBE_DLOG("    Not using indexes");
-    }
+    OBJData data;
+    parse(source, data, settings.threads);
+
+    MeshSeparate* mesh = buildMesh<vert>(data, elements, bufferType, settings, lods, [&data](const vec3i& c) {
+        vert v;
+        v.pos = getElement(data.positions, c.x);
+        v.nor = getElement(data.normals, c.z);
+        v.tex = getElement(data.texcoords, c.y);
+        return v;
+    });
 
     if (box != nullptr) {
-        *box = loadedBox;
+        *box = data.box;
     }
     return mesh;
 }
 
-MeshSeparate* OBJLoader::loadFromOBJTangents(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box) {
+MeshSeparate* OBJLoader::loadFromOBJTangents(std::unique_ptr<std::istream> in, Mesh::BufferType bufferType, AABB* box,
+                                             std::vector<MeshSimplifier::Lod>* lods) {
+    VBE_PROFILE_ZONE("OBJLoader::loadFromOBJTangents");
     VBE_DLOG("* Loading new OBJ from file. Expected format: V/T/N");
     std::vector<Vertex::Attribute> elements;
     elements.push_back(Vertex::Attribute(positionAttribName, Vertex::Attribute::Float, 3));
@@ -137,90 +748,45 @@ MeshSeparate* OBJLoader::loadFromOBJTangents(std::unique_ptr<std::istream> in, M
     elements.push_back(Vertex::Attribute(texcoordAttribName, Vertex::Attribute::Float, 2));
 
     struct vert {
-            vert(vec3f pos, vec3f nor, vec3f tan, vec2f tex) : pos(pos) , nor(nor), tan(tan), tex(tex) {}
             vec3f pos, nor, tan;
             vec2f tex;
     };
 
-    std::vector<vec3f> vertices;
-    std::vector<vec3f> normals;
+    BuildSettings settings = makeBuildSettings(getThreadCount(), optimize, quantize, highPrecisionNormals, triangleStrips);
+    settings.quantization.position = positionAttribName;
+    settings.quantization.normal = normalAttribName;
+    settings.quantization.texcoord = texcoordAttribName;
+    settings.quantization.tangent = tangentAttribName;
+    settings.lodLevels = lodLevels;
+    settings.lodRatio = lodRatio;
+    std::string source = Storage::readToString(std::move(in));
+    // The cache has nowhere to keep the levels of detail
+    if(lods == nullptr)
+        if(MeshSeparate* mesh = loadFromCache(cachePath, source, elements, bufferType, box, settings))
+            return mesh;
+
+    OBJData data;
+    parse(source, data, settings.threads);
+
     std::vector<vec3f> tangents;
-    std::vector<vec2f> textures;
-    std::vector<unsigned int> indices;
-    std::vector<vert> dataIndexed;
-    std::vector<vert> dataNotIndexed;
-    std::map<vec3i, int, FunctorComparevec3i> indexMap;
-
-    AABB loadedBox;
-
-    std::string line;
-    while (getline(*in, line)) {
-        if (line.substr(0, 2) == "v ") {
-            std::istringstream s(line.substr(2));
-            vec3f v;
-            s >> v.x >> v.y >> v.z;
-            vertices.push_back(v);
-
-            loadedBox.extend(v);
-        }
-        else if (line.substr(0, 3) == "vn ") {
-            std::istringstream s(line.substr(3));
-            vec3f v;
-            s >> v.x >> v.y >> v.z;
-            normals.push_back(v);
-            vec3f t = glm::cross(glm::normalize(v), vec3f(0, 0, 1));
-            if (glm::length(t) < 0.01) t = glm::cross(glm::normalize(v), vec3f(0, 1, 0));
-            tangents.push_back(t);
-        }
-        else if (line.substr(0, 3) == "vt ") {
-            std::istringstream s(line.substr(3));
-            vec2f v;
-            s >> v.x >> v.y;
-            v.y = 1-v.y;
-            textures.push_back(v);
-        }
-        else if (line.substr(0, 2) == "f ") {
-            std::istringstream s(line.substr(2));
-            std::vector<vec3i> vInf(3, vec3i(0));
-            char b;
-            s   >> vInf[0].x >> b >> vInf[0].y >> b >> vInf[0].z
-                    >> vInf[1].x >> b >> vInf[1].y >> b >> vInf[1].z
-                    >> vInf[2].x >> b >> vInf[2].y >> b >> vInf[2].z;
-            for(unsigned int i = 0; i < 3; ++i) {
-                std::map<vec3i, int, FunctorComparevec3i>::iterator it = indexMap.find(vInf[i]);
-                int ind = 0;
-                if(it == indexMap.end()) {
-                    ind = indexMap.size();
-                    indexMap.insert(std::pair<vec3i, int>(vInf[i], dataIndexed.size()));
-                    dataIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], tangents[vInf[i].z-1], textures[vInf[i].y-1]));
-                }
-                else ind = it->second;
-                indices.push_back(ind);
-                dataNotIndexed.push_back(vert(vertices[vInf[i].x-1], normals[vInf[i].z-1], tangents[vInf[i].z-1], textures[vInf[i].y-1]));
-            }
-        }
+    tangents.reserve(data.normals.size());
+    for(const vec3f& n : data.normals) {
+        vec3f t = glm::cross(glm::normalize(n), vec3f(0, 0, 1));
+        if (glm::length(t) < 0.01) t = glm::cross(glm::normalize(n), vec3f(0, 1, 0));
+        tangents.push_back(t);
     }
-    int sizeWithIndex = dataIndexed.size()*sizeof(vert)+indices.size()*sizeof(int);
-    int sizeWithoutIndex = dataNotIndexed.size()*sizeof(vert);
 
-    VBE_DLOG(" - Vertex count without indexes: " << dataNotIndexed.size());
-    VBE_DLOG(" - Vertex count with indexes: " << dataIndexed.size() << " (" << indices.size() << ") indexes");
-    VBE_DLOG(" - Size with indexes: " << sizeWithIndex << ". Size without indexes: " << sizeWithoutIndex);
-    MeshSeparate* mesh = nullptr;
-    if(sizeWithoutIndex > sizeWithIndex) { //indexed
-        mesh = new MeshIndexed(Vertex::Format(elements), bufferType);
-        mesh->setVertexData(&dataIndexed[0], dataIndexed.size());
-        ((MeshIndexed*)mesh)->setIndexData(&indices[0], indices.size());
-        VBE_DLOG("    Using indexes");
-    }
-    else { //not indexed
-        mesh = new Mesh(Vertex::Format(elements), bufferType);
-        mesh->setVertexData(&dataNotIndexed[0], dataNotIndexed.size());
-        VBE_DLOG("    Not using indexes");
-    }
+    MeshSeparate* mesh = buildMesh<vert>(data, elements, bufferType, settings, lods, [&data, &tangents](const vec3i& c) {
+        vert v;
+        v.pos = getElement(data.positions, c.x);
+        v.nor = getElement(data.normals, c.z);
+        v.tan = getElement(tangents, c.z);
+        v.tex = getElement(data.texcoords, c.y);
+        return v;
+    });
 
     if (box != nullptr) {
-        *box = loadedBox;
+        *box = data.box;
     }
     return mesh;
 }
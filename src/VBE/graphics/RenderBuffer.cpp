@@ -8,6 +8,13 @@ RenderBuffer::RenderBuffer(vec2ui size, TextureFormat::Format format) : size(siz
     resize(size);
 }
 
+#ifndef VBE_GLES2
+RenderBuffer::RenderBuffer(vec2ui size, TextureFormat::Format format, unsigned int samples) : size(size), format(format), samples(samples) {
+    GL_ASSERT(glGenRenderbuffers(1, &handle));
+    resize(size);
+}
+#endif
+
 RenderBuffer::RenderBuffer(RenderBuffer&& rhs) : RenderBuffer() {
     using std::swap;
     swap(*this, rhs);
@@ -31,12 +38,18 @@ void swap(RenderBuffer& a, RenderBuffer& b) {
     swap(a.format, b.format);
     swap(a.size, b.size);
     swap(a.handle, b.handle);
+    swap(a.samples, b.samples);
 }
 
 void RenderBuffer::resize(vec2ui size) {
     if(handle == 0) return;
     bind();
-    GL_ASSERT(glRenderbufferStorage(GL_RENDERBUFFER, format, size.x, size.y));
+#ifndef VBE_GLES2
+    if(samples > 0)
+        GL_ASSERT(glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, size.x, size.y));
+    else
+#endif
+        GL_ASSERT(glRenderbufferStorage(GL_RENDERBUFFER, format, size.x, size.y));
     this->size = size;
 }
 
@@ -49,6 +62,10 @@ void RenderBuffer::bind() const {
     GL_ASSERT(glBindRenderbuffer(GL_RENDERBUFFER, handle));
 }
 
+unsigned int RenderBuffer::getSamples() const {
+    return samples;
+}
+
 GLuint RenderBuffer::getHandle() const {
     return handle;
 }
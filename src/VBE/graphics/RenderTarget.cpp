@@ -1,6 +1,16 @@
+#include <utility>
+
 #include <VBE/config.hpp>
 #include <VBE/graphics/RenderBuffer.hpp>
 #include <VBE/graphics/RenderTarget.hpp>
+#include <VBE/system/Log.hpp>
+#include <VBE/system/Window.hpp>
+
+#ifndef VBE_GLES2
+// static
+std::vector<RenderTarget::Readback> RenderTarget::readbacks;
+unsigned int RenderTarget::pendingReadbacks = 0;
+#endif
 
 RenderTarget::RenderTarget() : RenderTargetBase(0, 0, 1) {
 }
@@ -27,12 +37,172 @@ void RenderTarget::setBuffer(RenderTargetBase::Attachment a, RenderBuffer* buff)
     dirty = true;
 }
 
+#ifndef VBE_GLES2
+void RenderTarget::setTexture(RenderTargetBase::Attachment a, Texture2DMultisample* tex) {
+    VBE_ASSERT(tex->getSize() == getSize(), "Incorrect size for Texture2DMultisample");
+    enableAttachment(a);
+    if(entries.find(a) != entries.end()) entries.erase(a);
+    entries.insert(std::pair<RenderTargetBase::Attachment, RenderTargetEntry>(a, RenderTargetEntry(tex)));
+    dirty = true;
+}
+
+void RenderTarget::resolveTo(const RenderTarget* other, GLbitfield mask) const {
+    VBE_ASSERT(other != this, "Can't resolve a RenderTarget into itself");
+    ensureValid();
+    vec2ui dstSize = (other == nullptr ? Window::getInstance()->getSize() : other->getSize());
+    VBE_ASSERT(dstSize == getSize(), "Resolving requires both targets to have the same size");
+    if(other != nullptr) other->ensureValid();
+
+    GL_ASSERT(glBindFramebuffer(GL_READ_FRAMEBUFFER, handle));
+    GL_ASSERT(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, other == nullptr ? 0 : other->getHandle()));
+    if(mask & GL_COLOR_BUFFER_BIT)
+        GL_ASSERT(glReadBuffer(COLOR0));
+    GL_ASSERT(glBlitFramebuffer(0, 0, getSize().x, getSize().y, 0, 0, dstSize.x, dstSize.y, mask, GL_NEAREST));
+    GL_ASSERT(glBindFramebuffer(GL_FRAMEBUFFER, current == nullptr ? 0 : current->getHandle()));
+}
+#endif
+
 Texture2D* RenderTarget::getTexture(RenderTargetBase::Attachment a) const {
     VBE_ASSERT(entries.find(a) != entries.end(), "No texture found for the provided attachment");
     VBE_ASSERT(entries.at(a).type == RenderTargetEntry::Texture2DEntry, "This attachment has a renderbuffer, not a texture");
     return entries.at(a).texture2D;
 }
 
+#ifndef VBE_GLES2
+void RenderTarget::readbackAsync(RenderTargetBase::Attachment a, vec2ui offset, vec2ui regionSize, ReadbackCallback callback,
+                                 TextureFormat::Format sourceFormat, TextureFormat::SourceType sourceType) const {
+    VBE_ASSERT(entries.find(a) != entries.end(), "No texture nor buffer found for the provided attachment");
+    VBE_ASSERT(offset.x + regionSize.x <= getSize().x && offset.y + regionSize.y <= getSize().y, "Readback region out of bounds");
+    VBE_ASSERT(regionSize.x != 0 && regionSize.y != 0, "Readback region can't be empty");
+    ensureValid();
+
+    // Reuse the first free buffer. They are recycled, so after a few frames this never allocates.
+    if(pendingReadbacks == readbacks.size())
+        readbacks.push_back(Readback());
+    Readback& r = readbacks[pendingReadbacks];
+    r.size = regionSize;
+    r.bytes = regionSize.x*regionSize.y*getReadbackPixelSize(sourceFormat, sourceType);
+    r.callback = callback;
+    if(r.buffer == 0)
+        GL_ASSERT(glGenBuffers(1, &r.buffer));
+    GL_ASSERT(glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer));
+    if(r.capacity < r.bytes) {
+        r.capacity = r.bytes;
+        GL_ASSERT(glBufferData(GL_PIXEL_PACK_BUFFER, r.capacity, nullptr, GL_STREAM_READ));
+    }
+
+    GL_ASSERT(glBindFramebuffer(GL_READ_FRAMEBUFFER, handle));
+    if(isColorAttachment(a))
+        GL_ASSERT(glReadBuffer(a));
+    GL_ASSERT(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GL_ASSERT(glReadPixels(offset.x, offset.y, regionSize.x, regionSize.y, sourceFormat, sourceType, 0));
+    GL_ASSERT(r.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    GL_ASSERT(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    GL_ASSERT(glBindFramebuffer(GL_READ_FRAMEBUFFER, current == nullptr ? 0 : current->getHandle()));
+    ++pendingReadbacks;
+}
+
+// static
+void RenderTarget::pollReadbacks(bool wait) {
+    unsigned int i = 0;
+    while(i < pendingReadbacks) {
+        GLenum status = GL_TIMEOUT_EXPIRED;
+        GL_ASSERT(status = glClientWaitSync(readbacks[i].fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0));
+        if(status == GL_TIMEOUT_EXPIRED) {
+            ++i;
+            continue;
+        }
+        VBE_ASSERT(status != GL_WAIT_FAILED, "Readback fence wait failed");
+
+        // Take it out of the vector first, the callback may start new readbacks and grow it
+        Readback r = std::move(readbacks[i]);
+        readbacks.erase(readbacks.begin() + i);
+        --pendingReadbacks;
+
+        GL_ASSERT(glDeleteSync(r.fence));
+        r.fence = 0;
+        GL_ASSERT(glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer));
+        void* pixels = nullptr;
+        GL_ASSERT(pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, r.bytes, GL_MAP_READ_BIT));
+        VBE_ASSERT(pixels != nullptr, "glMapBufferRange Failed!");
+        r.callback(pixels, r.size);
+        // The callback may have bound another buffer
+        GL_ASSERT(glBindBuffer(GL_PIXEL_PACK_BUFFER, r.buffer));
+        GL_ASSERT(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+        GL_ASSERT(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+        r.callback = nullptr;
+
+        // The now free buffer goes behind the pending ones
+        readbacks.push_back(std::move(r));
+    }
+}
+
+// static
+unsigned int RenderTarget::getPendingReadbacks() {
+    return pendingReadbacks;
+}
+
+// static
+unsigned int RenderTarget::getReadbackPixelSize(TextureFormat::Format format, TextureFormat::SourceType type) {
+    switch(type) {
+        case TextureFormat::UNSIGNED_BYTE_3_3_2:
+        case TextureFormat::UNSIGNED_BYTE_2_3_3_REV:
+            return 1;
+        case TextureFormat::UNSIGNED_SHORT_5_6_5:
+        case TextureFormat::UNSIGNED_SHORT_5_6_5_REV:
+        case TextureFormat::UNSIGNED_SHORT_4_4_4_4:
+        case TextureFormat::UNSIGNED_SHORT_4_4_4_4_REV:
+        case TextureFormat::UNSIGNED_SHORT_5_5_5_1:
+        case TextureFormat::UNSIGNED_SHORT_1_5_5_5_REV:
+            return 2;
+        case TextureFormat::UNSIGNED_INT_8_8_8_8:
+        case TextureFormat::UNSIGNED_INT_8_8_8_8_REV:
+        case TextureFormat::UNSIGNED_INT_10_10_10_2:
+        case TextureFormat::UNSIGNED_INT_2_10_10_10_REV:
+        case TextureFormat::UNSIGNED_INT_24_8:
+        case TextureFormat::UNSIGNED_INT_10F_11F_11F_REV:
+        case TextureFormat::UNSIGNED_INT_5_9_9_9_REV:
+            return 4;
+        case TextureFormat::FLOAT_32_UNSIGNED_INT_24_8_REV:
+            return 8;
+        default:
+            break;
+    }
+    unsigned int components = 4;
+    switch(format) {
+        case TextureFormat::RED:
+        case TextureFormat::RED_INTEGER:
+        case TextureFormat::DEPTH_COMPONENT:
+        case TextureFormat::STENCIL:
+            components = 1; break;
+        case TextureFormat::RG:
+        case TextureFormat::RG_INTEGER:
+            components = 2; break;
+        case TextureFormat::RGB:
+        case TextureFormat::BGR:
+        case TextureFormat::RGB_INTEGER:
+        case TextureFormat::BGR_INTEGER:
+            components = 3; break;
+        default:
+            break;
+    }
+    unsigned int componentSize = 1;
+    switch(type) {
+        case TextureFormat::SHORT:
+        case TextureFormat::UNSIGNED_SHORT:
+        case TextureFormat::HALF_FLOAT:
+            componentSize = 2; break;
+        case TextureFormat::INT:
+        case TextureFormat::UNSIGNED_INT:
+        case TextureFormat::FLOAT:
+            componentSize = 4; break;
+        default:
+            break;
+    }
+    return components*componentSize;
+}
+#endif
+
 RenderTarget::RenderTarget(RenderTarget&& rhs) : RenderTarget() {
     using std::swap;
     swap(*this, rhs);
@@ -1,8 +1,22 @@
 #include <VBE/config.hpp>
 #include <VBE/graphics/RenderBuffer.hpp>
 #include <VBE/graphics/RenderTargetBase.hpp>
+#include <VBE/graphics/Texture.hpp>
+#include <VBE/system/Log.hpp>
 #include <VBE/system/Window.hpp>
 #include <algorithm>
+#include <cstring>
+
+#ifdef VBE_GLES2
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+namespace {
+    // GL_EXT_discard_framebuffer is the GLES2 version of glInvalidateFramebuffer
+    PFNGLDISCARDFRAMEBUFFEREXTPROC discardFramebuffer = nullptr;
+    bool discardChecked = false;
+}
+#endif
 
 const RenderTargetBase* RenderTargetBase::current = nullptr;
 
@@ -28,11 +42,26 @@ void swap(RenderTargetBase& a, RenderTargetBase& b) {
     swap(a.drawAttachments, b.drawAttachments);
     swap(a.allAttachments, b.allAttachments);
     swap(a.entries, b.entries);
+    swap(a.loadActions, b.loadActions);
+    swap(a.storeActions, b.storeActions);
+    swap(a.clearColor, b.clearColor);
+    swap(a.clearDepth, b.clearDepth);
+    swap(a.clearStencil, b.clearStencil);
 }
 
 // static
 void RenderTargetBase::bind(const RenderTargetBase *target) {
+    bindFramebuffer(target, true);
+}
+
+// static
+void RenderTargetBase::bindFramebuffer(const RenderTargetBase *target, bool runActions) {
     if(current == target && (target == nullptr || !target->dirty)) return;
+#ifdef VBE_DEBUG
+    unsigned long long textureBinds = Texture::getBindCount();
+#endif
+    bool changed = (current != target);
+    if(runActions && changed && current != nullptr) current->store();
     if(target == nullptr) { //BIND SCREEN FRAMEBUFFER
         vec2ui screenSize = Window::getInstance()->getSize();
         GL_ASSERT(glViewport(0, 0, screenSize.x, screenSize.y));
@@ -42,14 +71,20 @@ void RenderTargetBase::bind(const RenderTargetBase *target) {
         GL_ASSERT(glViewport(0, 0, target->size.x, target->size.y));
         GL_ASSERT(glBindFramebuffer(GL_FRAMEBUFFER, target->handle));
         target->valid();
+        if(runActions && changed) target->load();
     }
     current = target;
+    VBE_ASSERT(textureBinds == Texture::getBindCount(), "Binding a RenderTarget must not change the texture bindings");
 }
 
 const RenderTargetBase* RenderTargetBase::getCurrent() {
     return current;
 }
 
+GLuint RenderTargetBase::getHandle() const {
+    return handle;
+}
+
 vec2ui RenderTargetBase::getSize() const {
     return size;
 }
@@ -61,8 +96,104 @@ unsigned int RenderTargetBase::getNumLayers() const {
 void RenderTargetBase::ensureValid() const {
     const RenderTargetBase* last = current;
     if(last == this) return;
-    bind(this);
-    bind(last);
+    // Just validating, this is not a pass: don't run the load and store actions
+    bindFramebuffer(this, false);
+    bindFramebuffer(last, false);
+}
+
+void RenderTargetBase::setLoadAction(Attachment a, LoadAction action) {
+    loadActions[a] = action;
+}
+
+void RenderTargetBase::setStoreAction(Attachment a, StoreAction action) {
+    storeActions[a] = action;
+}
+
+RenderTargetBase::LoadAction RenderTargetBase::getLoadAction(Attachment a) const {
+    std::map<Attachment, LoadAction>::const_iterator it = loadActions.find(a);
+    return it == loadActions.end() ? LOAD : it->second;
+}
+
+RenderTargetBase::StoreAction RenderTargetBase::getStoreAction(Attachment a) const {
+    std::map<Attachment, StoreAction>::const_iterator it = storeActions.find(a);
+    return it == storeActions.end() ? STORE : it->second;
+}
+
+void RenderTargetBase::setClearColor(vec4f color) {
+    clearColor = color;
+}
+
+void RenderTargetBase::setClearDepth(float depth) {
+    clearDepth = depth;
+}
+
+void RenderTargetBase::setClearStencil(int stencil) {
+    clearStencil = stencil;
+}
+
+void RenderTargetBase::load() const { //assumes this target is bound
+    std::vector<GLenum> dontCare;
+#ifdef VBE_GLES2
+    GLbitfield mask = 0;
+#endif
+    for(const std::pair<const Attachment, LoadAction>& l : loadActions) {
+        if(l.second == LOAD || allAttachments.find(l.first) == allAttachments.end()) continue;
+        if(l.second == DONT_CARE) {
+            dontCare.push_back(l.first);
+            continue;
+        }
+#ifdef VBE_GLES2
+        if(l.first == DEPTH) mask |= GL_DEPTH_BUFFER_BIT;
+        else if(l.first == STENCIL) mask |= GL_STENCIL_BUFFER_BIT;
+        else mask |= GL_COLOR_BUFFER_BIT;
+#else
+        // glClearBuffer doesn't touch the global clear values, unlike glClear
+        if(l.first == DEPTH)
+            GL_ASSERT(glClearBufferfv(GL_DEPTH, 0, &clearDepth));
+        else if(l.first == STENCIL)
+            GL_ASSERT(glClearBufferiv(GL_STENCIL, 0, &clearStencil));
+        else if(l.first == DEPTH_STENCIL)
+            GL_ASSERT(glClearBufferfi(GL_DEPTH_STENCIL, 0, clearDepth, clearStencil));
+        else {
+            GLint drawBuffer = std::find(drawAttachments.begin(), drawAttachments.end(), l.first) - drawAttachments.begin();
+            GL_ASSERT(glClearBufferfv(GL_COLOR, drawBuffer, &clearColor[0]));
+        }
+#endif
+    }
+#ifdef VBE_GLES2
+    if(mask != 0) {
+        GL_ASSERT(glClearColor(clearColor.r, clearColor.g, clearColor.b, clearColor.a));
+        GL_ASSERT(glClearDepthf(clearDepth));
+        GL_ASSERT(glClearStencil(clearStencil));
+        GL_ASSERT(glClear(mask));
+    }
+#endif
+    invalidate(dontCare);
+}
+
+void RenderTargetBase::store() const { //assumes this target is bound
+    std::vector<GLenum> discard;
+    for(const std::pair<const Attachment, StoreAction>& s : storeActions)
+        if(s.second == DISCARD && allAttachments.find(s.first) != allAttachments.end())
+            discard.push_back(s.first);
+    invalidate(discard);
+}
+
+// static
+void RenderTargetBase::invalidate(const std::vector<GLenum>& attachments) {
+    if(attachments.empty()) return;
+#ifdef VBE_GLES2
+    if(!discardChecked) {
+        discardChecked = true;
+        const char* extensions = (const char*) glGetString(GL_EXTENSIONS);
+        if(extensions != nullptr && strstr(extensions, "GL_EXT_discard_framebuffer") != nullptr)
+            discardFramebuffer = (PFNGLDISCARDFRAMEBUFFEREXTPROC) eglGetProcAddress("glDiscardFramebufferEXT");
+    }
+    if(discardFramebuffer != nullptr)
+        GL_ASSERT(discardFramebuffer(GL_FRAMEBUFFER, attachments.size(), &attachments[0]));
+#else
+    GL_ASSERT(glInvalidateFramebuffer(GL_FRAMEBUFFER, attachments.size(), &attachments[0]));
+#endif
 }
 
 void RenderTargetBase::valid() const {
@@ -81,15 +212,17 @@ void RenderTargetBase::valid() const {
                 e.renderBuffer->bind();
                 GL_ASSERT(glFramebufferRenderbuffer(GL_FRAMEBUFFER, a, GL_RENDERBUFFER, e.renderBuffer->getHandle()));
                 break;
+            // Attaching a texture doesn't need it bound to any unit, so the Texture binding cache is left alone
             case RenderTargetEntry::Texture2DEntry:
-                Texture2D::bind(e.texture2D, rand()%10); //wow, such determinism
                 GL_ASSERT(glFramebufferTexture2D(GL_FRAMEBUFFER, a, GL_TEXTURE_2D, e.texture2D->getHandle(), 0));
                 break;
 #ifndef VBE_GLES2
             case RenderTargetEntry::Texture2DArrayEntry:
-                Texture2DArray::bind(e.texture2DArray, 0);
                 GL_ASSERT(glFramebufferTexture(GL_FRAMEBUFFER, a, e.texture2DArray->getHandle(), 0));
                 break;
+            case RenderTargetEntry::Texture2DMultisampleEntry:
+                GL_ASSERT(glFramebufferTexture2D(GL_FRAMEBUFFER, a, GL_TEXTURE_2D_MULTISAMPLE, e.texture2DMultisample->getHandle(), 0));
+                break;
 #endif
         }
     }
@@ -0,0 +1,100 @@
+#include <functional>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Sampler.hpp>
+#include <VBE/graphics/Texture.hpp>
+#include <VBE/system/Log.hpp>
+
+// Sampler objects are not supported in GLES2
+#ifndef VBE_GLES2
+
+// static
+std::unordered_map<Sampler::State, Sampler*, Sampler::StateHash> Sampler::cache;
+std::vector<GLuint> Sampler::current;
+
+bool Sampler::State::operator == (const State& s) const {
+    return minFilter == s.minFilter && magFilter == s.magFilter &&
+            wrapS == s.wrapS && wrapT == s.wrapT && wrapR == s.wrapR &&
+            compareMode == s.compareMode && compareFunc == s.compareFunc &&
+            minLod == s.minLod && maxLod == s.maxLod && lodBias == s.lodBias;
+}
+
+bool Sampler::State::operator != (const State& s) const {
+    return !(*this == s);
+}
+
+std::size_t Sampler::State::hash() const {
+    std::hash<unsigned int> hashInt;
+    std::hash<float> hashFloat;
+    std::size_t h = hashInt(minFilter);
+    h = h*31 + hashInt(magFilter);
+    h = h*31 + hashInt(wrapS);
+    h = h*31 + hashInt(wrapT);
+    h = h*31 + hashInt(wrapR);
+    h = h*31 + hashInt(compareMode);
+    h = h*31 + hashInt(compareFunc);
+    h = h*31 + hashFloat(minLod);
+    h = h*31 + hashFloat(maxLod);
+    h = h*31 + hashFloat(lodBias);
+    return h;
+}
+
+// static
+const Sampler* Sampler::get(const State& state) {
+    std::unordered_map<State, Sampler*, StateHash>::iterator it = cache.find(state);
+    if(it != cache.end()) return it->second;
+    Sampler* sampler = new Sampler(state);
+    cache.insert(std::pair<State, Sampler*>(state, sampler));
+    return sampler;
+}
+
+// static
+void Sampler::clearCache() {
+    for(unsigned int i = 0; i < current.size(); ++i)
+        if(current[i] != 0) bind(nullptr, i);
+    for(const std::pair<const State, Sampler*>& s : cache)
+        delete s.second;
+    cache.clear();
+}
+
+// static
+void Sampler::bind(const Sampler* sampler, unsigned int slot) {
+    VBE_ASSERT(slot < Texture::getMaxSlots(), "Invalid texture slot on Sampler::bind");
+    if(current.empty())
+        current = std::vector<GLuint>(Texture::getMaxSlots(), 0);
+
+    GLuint handle = (sampler == nullptr ? 0 : sampler->handle);
+    if(current[slot] == handle) return;
+    current[slot] = handle;
+    GL_ASSERT(glBindSampler(slot, handle));
+}
+
+Sampler::Sampler(const State& state) : state(state) {
+    GL_ASSERT(glGenSamplers(1, &handle));
+    VBE_ASSERT(handle != 0, "Failed to create sampler");
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_MIN_FILTER, state.minFilter));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_MAG_FILTER, state.magFilter));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_WRAP_S, state.wrapS));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_WRAP_T, state.wrapT));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_WRAP_R, state.wrapR));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_COMPARE_MODE, state.compareMode));
+    GL_ASSERT(glSamplerParameteri(handle, GL_TEXTURE_COMPARE_FUNC, state.compareFunc));
+    GL_ASSERT(glSamplerParameterf(handle, GL_TEXTURE_MIN_LOD, state.minLod));
+    GL_ASSERT(glSamplerParameterf(handle, GL_TEXTURE_MAX_LOD, state.maxLod));
+    GL_ASSERT(glSamplerParameterf(handle, GL_TEXTURE_LOD_BIAS, state.lodBias));
+}
+
+Sampler::~Sampler() {
+    GL_ASSERT(glDeleteSamplers(1, &handle));
+}
+
+GLuint Sampler::getHandle() const {
+    return handle;
+}
+
+const Sampler::State& Sampler::getState() const {
+    return state;
+}
+
+#endif // VBE_GLES2
@@ -14,6 +14,7 @@ ShaderBinding::ShaderBinding(const ShaderProgram* program, const MeshSeparate* m
 #ifdef SHADERBINDING_USE_VAO
     GL_ASSERT(glGenVertexArrays(1, &vertexArrayObject));
     GL_ASSERT(glBindVertexArray(vertexArrayObject));
+    currentBind = this;
     enableAttributes();
 #endif
 }
@@ -24,14 +25,26 @@ ShaderBinding::ShaderBinding(const ShaderProgram* program, const MeshBatched::Bu
 #ifdef SHADERBINDING_USE_VAO
     GL_ASSERT(glGenVertexArrays(1, &vertexArrayObject));
     GL_ASSERT(glBindVertexArray(vertexArrayObject));
+    currentBind = this;
     enableAttributes();
 #endif
 }
 
 ShaderBinding::~ShaderBinding() {
 #ifdef SHADERBINDING_USE_VAO
+    // Deleting the bound vertex array binds 0
     GL_ASSERT(glDeleteVertexArrays(1, &vertexArrayObject));
+#else
+    // The mesh or the program may be gone already, so disable every array
+    if(currentBind == this) {
+        GLint maxAttributes = 0;
+        GL_ASSERT(glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttributes));
+        for(GLint i = 0; i < maxAttributes; ++i)
+            GL_ASSERT(glDisableVertexAttribArray(i));
+    }
 #endif
+    // A new binding could get the same address and be taken as bound
+    if(currentBind == this) currentBind = nullptr;
 }
 
 const ShaderBinding* ShaderBinding::currentBind = nullptr;
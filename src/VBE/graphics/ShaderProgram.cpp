@@ -7,6 +7,7 @@
 #include <VBE/graphics/ShaderProgram.hpp>
 #include <VBE/graphics/Uniform.hpp>
 #include <VBE/system/Log.hpp>
+#include <VBE/system/Profiler.hpp>
 #include <VBE/system/Storage.hpp>
 
 GLuint ShaderProgram::current = 0;
@@ -89,6 +90,7 @@ void ShaderProgram::printInfoLog() {
 }
 
 void ShaderProgram::use() const {
+    VBE_PROFILE_ZONE("ShaderProgram::use");
     VBE_ASSERT(programHandle != 0, "Trying to use null program");
     if(current != programHandle) {
         current = programHandle;
@@ -1,12 +1,16 @@
 #include <VBE/config.hpp>
 #include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Sampler.hpp>
 #include <VBE/graphics/Texture.hpp>
+#include <VBE/graphics/TextureCache.hpp>
 #include <VBE/system/Log.hpp>
+#include <VBE/system/Profiler.hpp>
 
 // static
 int Texture::maxSlots = -1;
 std::vector<std::vector<GLuint>> Texture::current;
 unsigned int Texture::currentUnit = 0;
+unsigned long long Texture::bindCount = 0;
 
 //static
 unsigned int Texture::getMaxSlots() {
@@ -19,18 +23,37 @@ unsigned int Texture::getMaxSlots() {
     return maxSlots;
 }
 
+//static
+unsigned long long Texture::getBindCount() {
+    return bindCount;
+}
+
 void swap(Texture& a, Texture& b) {
     using std::swap;
 
     swap(a.handle, b.handle);
     swap(a.format, b.format);
     swap(a.type, b.type);
+    swap(a.mipmaps, b.mipmaps);
+    swap(a.cached, b.cached);
+#ifndef VBE_GLES2
+    swap(a.bindlessHandle, b.bindlessHandle);
+    swap(a.samplerBindlessHandles, b.samplerBindlessHandles);
+#endif
+    if(a.cached || b.cached)
+        TextureCache::swapEntries(&a, &b);
 }
 
 // static
 void Texture::bind(Texture::Type type, const Texture* tex, unsigned int slot) {
+    VBE_PROFILE_ZONE("Texture::bind");
     VBE_ASSERT(slot < getMaxSlots(), "Invalid texture slot on Texture::bind");
 
+    // Must happen before touching any binding state: reloading an evicted
+    // texture may bind it to another slot.
+    if(tex != nullptr && tex->cached)
+        TextureCache::touch(tex);
+
     if(currentUnit != slot) {
         GL_ASSERT(glActiveTexture(GL_TEXTURE0 + slot));
         currentUnit = slot;
@@ -42,6 +65,7 @@ void Texture::bind(Texture::Type type, const Texture* tex, unsigned int slot) {
         current[type][slot] = tex->handle;
     }
 
+    ++bindCount;
     if(tex != nullptr)
         GL_ASSERT(glBindTexture(typeToGL(type), tex->handle));
     else
@@ -58,6 +82,9 @@ GLenum Texture::typeToGL(Texture::Type t) {
 #endif
         case TypeCubemap: return GL_TEXTURE_CUBE_MAP;
         case TypeCubemapArray: return GL_TEXTURE_CUBE_MAP_ARRAY;
+#ifndef VBE_GLES2
+        case Type2DMultisample: return GL_TEXTURE_2D_MULTISAMPLE;
+#endif
         default: break;
     }
     VBE_ASSERT(false, "Unknown type when trying to convert from Texture::Type to GL enum");
@@ -66,9 +93,21 @@ GLenum Texture::typeToGL(Texture::Type t) {
 
 Texture::Texture(Type type, TextureFormat::Format format): format(format), type(type) {
     getMaxSlots();
-    GL_ASSERT(glGenTextures(1, &handle));
+#ifndef VBE_GLES2
+    // Names from glGenTextures are not objects until first bound, which DSA calls need
+    if(GLEW_ARB_direct_state_access) {
+        GL_ASSERT(glCreateTextures(typeToGL(type), 1, &handle));
+    }
+    else
+#endif
+    {
+        GL_ASSERT(glGenTextures(1, &handle));
+    }
     VBE_ASSERT(handle != 0, "Failed to create texture");
 
+    // Multisample textures have no sampler state
+    if(type == Type2DMultisample) return;
+
     // Default filtering in OpenGL uses mipmaps, which will show black in most cases
     // where mipmaps are not generated. Change it to a saner default here.
     setFilter(GL_LINEAR, GL_LINEAR);
@@ -78,6 +117,13 @@ Texture::Texture(Type type, TextureFormat::Format format): format(format), type(
 }
 
 Texture::~Texture(){
+    if(cached) TextureCache::remove(this);
+#ifndef VBE_GLES2
+    if(bindlessHandle != 0)
+        GL_ASSERT(glMakeTextureHandleNonResidentARB(bindlessHandle));
+    for(const std::pair<Sampler::State, GLuint64>& h : samplerBindlessHandles)
+        GL_ASSERT(glMakeTextureHandleNonResidentARB(h.second));
+#endif
     GL_ASSERT(glDeleteTextures(1, (GLuint*) &handle));
 }
 
@@ -93,35 +139,96 @@ Texture::Type Texture::getType() const {
     return type;
 }
 
+unsigned long long Texture::getEstimatedMemory() const {
+    unsigned long long bytes = (unsigned long long) getTexelCount() * TextureFormat::getPixelSize(format);
+    // A full mip chain adds roughly one third of the base level
+    if(mipmaps) bytes += bytes/3;
+    return bytes;
+}
+
+bool Texture::hasMipmaps() const {
+    return mipmaps;
+}
+
 #ifndef VBE_GLES2
 void Texture::setComparison(GLenum func, GLenum mode) {
     VBE_ASSERT(TextureFormat::isDepth(format), "Can't set comparison for a non-depth, non_stencil texture");
-    Texture::bind(type, this, 0);
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_COMPARE_FUNC, func));
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_COMPARE_MODE, mode));
+    setParameter(GL_TEXTURE_COMPARE_FUNC, func);
+    setParameter(GL_TEXTURE_COMPARE_MODE, mode);
+}
+
+void Texture::setMaxLevel(unsigned int level) {
+    setParameter(GL_TEXTURE_MAX_LEVEL, level);
 }
 #endif
 
 void Texture::setDepthStencilTextureMode(GLenum mode) {
     VBE_ASSERT(TextureFormat::isDepthStencil(format), "Can't set depth stencil texture mode for a non depth-stencil texture");
-    Texture::bind(type, this, 0);
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_DEPTH_STENCIL_TEXTURE_MODE, mode));
+    setParameter(GL_DEPTH_STENCIL_TEXTURE_MODE, mode);
 }
 
 void Texture::setFilter(GLenum min, GLenum mag) {
-    Texture::bind(type, this, 0);
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_MIN_FILTER, min));
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_MAG_FILTER, mag));
+    setParameter(GL_TEXTURE_MIN_FILTER, min);
+    setParameter(GL_TEXTURE_MAG_FILTER, mag);
 }
 
 void Texture::setWrap(GLenum wrap) {
+    setParameter(GL_TEXTURE_WRAP_S, wrap);
+    setParameter(GL_TEXTURE_WRAP_T, wrap);
+}
+
+void Texture::setParameter(GLenum pname, GLint value) {
+#ifndef VBE_GLES2
+    VBE_ASSERT(!isBindless(), "Can't change the parameters of a texture with bindless handles");
+    // With DSA the parameter is set without touching the texture bindings
+    if(GLEW_ARB_direct_state_access) {
+        GL_ASSERT(glTextureParameteri(handle, pname, value));
+        return;
+    }
+#endif
     Texture::bind(type, this, 0);
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_WRAP_S, wrap));
-    GL_ASSERT(glTexParameteri(typeToGL(type), GL_TEXTURE_WRAP_T, wrap));
+    GL_ASSERT(glTexParameteri(typeToGL(type), pname, value));
+}
+
+#ifndef VBE_GLES2
+// static
+bool Texture::isBindlessSupported() {
+    return GLEW_ARB_bindless_texture;
+}
+
+GLuint64 Texture::getBindlessHandle() const {
+    VBE_ASSERT(isBindlessSupported(), "ARB_bindless_texture is not supported");
+    VBE_ASSERT(!cached, "Textures managed by the TextureCache can't be bindless");
+    if(bindlessHandle != 0) return bindlessHandle;
+    GL_ASSERT(bindlessHandle = glGetTextureHandleARB(handle));
+    VBE_ASSERT(bindlessHandle != 0, "Failed to create bindless texture handle");
+    GL_ASSERT(glMakeTextureHandleResidentARB(bindlessHandle));
+    return bindlessHandle;
 }
 
+GLuint64 Texture::getBindlessHandle(const Sampler& sampler) const {
+    VBE_ASSERT(isBindlessSupported(), "ARB_bindless_texture is not supported");
+    VBE_ASSERT(!cached, "Textures managed by the TextureCache can't be bindless");
+    // The handle keeps the sampling state it was created with. Sampler names are
+    // reused after Sampler::clearCache(), but a sampler's state never changes.
+    for(const std::pair<Sampler::State, GLuint64>& h : samplerBindlessHandles)
+        if(h.first == sampler.getState()) return h.second;
+    GLuint64 h = 0;
+    GL_ASSERT(h = glGetTextureSamplerHandleARB(handle, sampler.getHandle()));
+    VBE_ASSERT(h != 0, "Failed to create bindless texture handle");
+    GL_ASSERT(glMakeTextureHandleResidentARB(h));
+    samplerBindlessHandles.push_back(std::pair<Sampler::State, GLuint64>(sampler.getState(), h));
+    return h;
+}
+
+bool Texture::isBindless() const {
+    return bindlessHandle != 0 || !samplerBindlessHandles.empty();
+}
+#endif
+
 void Texture::generateMipmap() {
     Texture::bind(type, this, 0);
     GL_ASSERT(glGenerateMipmap(typeToGL(type)));
+    mipmaps = true;
     setFilter(GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
 }
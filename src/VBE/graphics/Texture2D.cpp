@@ -46,10 +46,28 @@ void Texture2D::setData(
     GL_ASSERT(glTexImage2D(GL_TEXTURE_2D, 0, getFormat(), size.x, size.y, 0, sourceFormat, sourceType, (GLvoid*) pixels));
 }
 
+void Texture2D::setSubData(
+        const void* pixels,
+        vec2ui offset,
+        vec2ui regionSize,
+        TextureFormat::Format sourceFormat,
+        TextureFormat::SourceType sourceType) {
+    VBE_ASSERT(TextureFormat::isBaseFormat(sourceFormat), "Only base formats are accepted as source format for pixel data on texture loads. Specify the sizing of your input through the sourceType only");
+    VBE_ASSERT(offset.x + regionSize.x <= size.x && offset.y + regionSize.y <= size.y, "Region out of the texture bounds");
+
+    Texture2D::bind(this, 0);
+    GL_ASSERT(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_ASSERT(glTexSubImage2D(GL_TEXTURE_2D, 0, offset.x, offset.y, regionSize.x, regionSize.y, sourceFormat, sourceType, (GLvoid*) pixels));
+}
+
 vec2ui Texture2D::getSize() const {
     return size;
 }
 
+unsigned int Texture2D::getTexelCount() const {
+    return size.x*size.y;
+}
+
 Texture2D::Texture2D(Texture2D&& rhs) : Texture2D() {
     using std::swap;
     swap(*this, rhs);
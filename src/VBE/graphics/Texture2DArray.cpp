@@ -65,10 +65,28 @@ void Texture2DArray::setData(
     GL_ASSERT(glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, getFormat(), size.x, size.y, size.z, 0, sourceFormat, sourceType, (GLvoid*) pixels));
 }
 
+void Texture2DArray::setSubData(
+        const void* pixels,
+        vec3ui offset,
+        vec3ui regionSize,
+        TextureFormat::Format sourceFormat,
+        TextureFormat::SourceType sourceType) {
+    VBE_ASSERT(TextureFormat::isBaseFormat(sourceFormat), "Only base formats are accepted as source format for pixel data on texture loads. Specify the sizing of your input through the sourceType only");
+    VBE_ASSERT(offset.x + regionSize.x <= size.x && offset.y + regionSize.y <= size.y && offset.z + regionSize.z <= size.z, "Region out of the texture bounds");
+
+    Texture2DArray::bind(this, 0);
+    GL_ASSERT(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_ASSERT(glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, offset.x, offset.y, offset.z, regionSize.x, regionSize.y, regionSize.z, sourceFormat, sourceType, (GLvoid*) pixels));
+}
+
 vec3ui Texture2DArray::getSize() const {
     return size;
 }
 
+unsigned int Texture2DArray::getTexelCount() const {
+    return size.x*size.y*size.z;
+}
+
 Texture2DArray::Texture2DArray(Texture2DArray&& rhs) : Texture2DArray() {
     using std::swap;
     swap(*this, rhs);
@@ -0,0 +1,62 @@
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Texture2DMultisample.hpp>
+#include <VBE/system/Log.hpp>
+
+// Multisample textures are not supported in GLES2
+#ifndef VBE_GLES2
+
+Texture2DMultisample::Texture2DMultisample() : Texture(Texture::Type2DMultisample) {
+}
+
+Texture2DMultisample::Texture2DMultisample(vec2ui size, unsigned int samples, TextureFormat::Format format) :
+    Texture(Texture::Type2DMultisample, format), size(size), samples(samples) {
+    VBE_ASSERT(!TextureFormat::isBaseFormat(format), "Multisample textures need a sized format");
+    VBE_ASSERT(samples > 0 && samples <= getMaxSamples(format), "Invalid sample count " << samples << ", the maximum for this format is " << getMaxSamples(format));
+    Texture2DMultisample::bind(this, 0);
+    GL_ASSERT(glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, samples, format, size.x, size.y, GL_TRUE));
+}
+
+vec2ui Texture2DMultisample::getSize() const {
+    return size;
+}
+
+unsigned int Texture2DMultisample::getSamples() const {
+    return samples;
+}
+
+unsigned int Texture2DMultisample::getTexelCount() const {
+    return size.x*size.y*samples;
+}
+
+// static
+unsigned int Texture2DMultisample::getMaxSamples(TextureFormat::Format format) {
+    GLenum limit = GL_MAX_COLOR_TEXTURE_SAMPLES;
+    if(TextureFormat::isDepth(format) || format == TextureFormat::STENCIL8)
+        limit = GL_MAX_DEPTH_TEXTURE_SAMPLES;
+    else if(TextureFormat::isInteger(format))
+        limit = GL_MAX_INTEGER_SAMPLES;
+    GLint maxSamples = 0;
+    GL_ASSERT(glGetIntegerv(limit, &maxSamples));
+    return maxSamples;
+}
+
+Texture2DMultisample::Texture2DMultisample(Texture2DMultisample&& rhs) : Texture2DMultisample() {
+    using std::swap;
+    swap(*this, rhs);
+}
+
+Texture2DMultisample& Texture2DMultisample::operator=(Texture2DMultisample&& rhs) {
+    using std::swap;
+    swap(*this, rhs);
+    return *this;
+}
+
+void swap(Texture2DMultisample& a, Texture2DMultisample& b) {
+    using std::swap;
+    swap(static_cast<Texture&>(a), static_cast<Texture&>(b));
+    swap(a.size, b.size);
+    swap(a.samples, b.samples);
+}
+
+#endif // VBE_GLES2
@@ -28,6 +28,10 @@ vec3ui Texture3D::getSize() const {
     return size;
 }
 
+unsigned int Texture3D::getTexelCount() const {
+    return size.x*size.y*size.z;
+}
+
 Texture3D::Texture3D(Texture3D&& rhs) : Texture3D() {
     using std::swap;
     swap(*this, rhs);
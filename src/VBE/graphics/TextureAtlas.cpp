@@ -0,0 +1,292 @@
+#include <algorithm>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/Image.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/TextureAtlas.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    // Levels where a gutter of this width is still at least a texel wide
+    unsigned int getSafeMipLevels(unsigned int padding) {
+        unsigned int levels = 1;
+        while(padding >= (2u << (levels - 1))) ++levels;
+        return levels;
+    }
+
+    unsigned int roundUp(unsigned int value, unsigned int multiple) {
+        return (value + multiple - 1)/multiple*multiple;
+    }
+}
+
+TextureAtlas::TextureAtlas(vec2ui pageSize, unsigned int padding, PageType type, TextureFormat::Format format) :
+    pageSize(pageSize), padding(padding), mipLevelCount(getSafeMipLevels(padding)), type(type), format(format) {
+    VBE_ASSERT(pageSize.x > 0 && pageSize.y > 0, "Page size must not be zero");
+}
+
+TextureAtlas::~TextureAtlas() {
+    for(Texture2D* t : textures) delete t;
+#ifndef VBE_GLES2
+    delete array;
+#endif
+}
+
+unsigned int TextureAtlas::insert(const Image& img) {
+    return insert(img.getData(), img.getSize(), img.getChannels());
+}
+
+unsigned int TextureAtlas::insert(const void* pixels, vec2ui size, unsigned int channels) {
+    VBE_ASSERT(pixels != nullptr, "Pixels cannot be nullptr");
+    VBE_ASSERT(channels >= 1 && channels <= 4, "Only images with 1 to 4 channels can be packed");
+    VBE_ASSERT(size.x > 0 && size.y > 0, "Image size must not be zero");
+
+    // Every padded size is a multiple of the grid, so every skyline position stays on it
+    // and a texel of the last safe level never covers two images
+    unsigned int grid = 1u << (mipLevelCount - 1);
+    Entry e;
+    e.paddedSize = vec2ui(roundUp(size.x + 2*padding, grid), roundUp(size.y + 2*padding, grid));
+    VBE_ASSERT(e.paddedSize.x <= pageSize.x && e.paddedSize.y <= pageSize.y, "Image of size " << size.x << "x" << size.y << " does not fit in an atlas page");
+    e.region.size = size;
+
+    // Expand to RGBA and extrude the borders into the gutter
+    const unsigned char* src = (const unsigned char*) pixels;
+    e.pixels.resize(e.paddedSize.x*e.paddedSize.y*4);
+    for(unsigned int y = 0; y < e.paddedSize.y; ++y) {
+        unsigned int sy = std::min(size.y - 1, (unsigned int) std::max(0, int(y) - int(padding)));
+        for(unsigned int x = 0; x < e.paddedSize.x; ++x) {
+            unsigned int sx = std::min(size.x - 1, (unsigned int) std::max(0, int(x) - int(padding)));
+            const unsigned char* s = &src[(sy*size.x + sx)*channels];
+            unsigned char* d = &e.pixels[(y*e.paddedSize.x + x)*4];
+            d[0] = s[0];
+            d[1] = channels > 1 ? s[1] : 0;
+            d[2] = channels > 2 ? s[2] : 0;
+            d[3] = channels > 3 ? s[3] : 255;
+        }
+    }
+
+    bool lost = place(e);
+    unsigned int id = nextId++;
+    const Entry& entry = entries.insert(std::pair<unsigned int, Entry>(id, std::move(e))).first->second;
+    if(lost) {
+        for(const std::pair<const unsigned int, Entry>& other : entries) upload(other.second);
+    }
+    else
+        upload(entry);
+    return id;
+}
+
+void TextureAtlas::remove(unsigned int id) {
+    std::map<unsigned int, Entry>::iterator it = entries.find(id);
+    VBE_ASSERT(it != entries.end(), "Invalid atlas id " << id);
+    Page& p = pages[it->second.region.page];
+    entries.erase(it);
+    if(--p.entryCount == 0) resetPage(p);
+}
+
+bool TextureAtlas::contains(unsigned int id) const {
+    return entries.find(id) != entries.end();
+}
+
+const TextureAtlas::Region& TextureAtlas::getRegion(unsigned int id) const {
+    std::map<unsigned int, Entry>::const_iterator it = entries.find(id);
+    VBE_ASSERT(it != entries.end(), "Invalid atlas id " << id);
+    return it->second.region;
+}
+
+void TextureAtlas::repack() {
+    // Tallest first packs best with a skyline
+    std::vector<Entry*> sorted;
+    for(std::pair<const unsigned int, Entry>& e : entries) sorted.push_back(&e.second);
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b) {
+        return a->paddedSize.y > b->paddedSize.y || (a->paddedSize.y == b->paddedSize.y && a->paddedSize.x > b->paddedSize.x);
+    });
+
+    unsigned int oldPageCount = pages.size();
+    pages.clear();
+    // Everything is uploaded again below, so lost array contents do not matter
+    for(Entry* e : sorted) place(*e);
+
+    // Release the pages that are no longer needed
+    if(type == Pages2D) {
+        for(unsigned int i = pages.size(); i < oldPageCount; ++i) delete textures[i];
+        textures.resize(pages.size());
+    }
+    for(Entry* e : sorted) upload(*e);
+}
+
+void TextureAtlas::generateMipmaps() {
+    for(unsigned int i = 0; i < pages.size(); ++i) {
+        if(!pages[i].dirty) continue;
+        pages[i].dirty = false;
+#ifndef VBE_GLES2
+        if(type == PagesArray) {
+            array->generateMipmap();
+            for(Page& p : pages) p.dirty = false;
+            return;
+        }
+#endif
+        textures[i]->generateMipmap();
+    }
+}
+
+unsigned int TextureAtlas::getMipLevelCount() const {
+    return mipLevelCount;
+}
+
+unsigned int TextureAtlas::getPageCount() const {
+    return pages.size();
+}
+
+vec2ui TextureAtlas::getPageSize() const {
+    return pageSize;
+}
+
+float TextureAtlas::getOccupancy() const {
+    if(pages.empty()) return 0.0f;
+    unsigned long long used = 0;
+    for(const std::pair<const unsigned int, Entry>& e : entries)
+        used += e.second.paddedSize.x*e.second.paddedSize.y;
+    return float(used)/(float(pageSize.x)*float(pageSize.y)*pages.size());
+}
+
+const Texture2D& TextureAtlas::getPage(unsigned int page) const {
+    VBE_ASSERT(type == Pages2D, "getPage is only valid for Pages2D atlases");
+    VBE_ASSERT(page < textures.size(), "Invalid atlas page " << page);
+    return *textures[page];
+}
+
+#ifndef VBE_GLES2
+const Texture2DArray& TextureAtlas::getPageArray() const {
+    VBE_ASSERT(type == PagesArray, "getPageArray is only valid for PagesArray atlases");
+    VBE_ASSERT(array != nullptr, "The atlas has no pages yet");
+    return *array;
+}
+#endif
+
+void TextureAtlas::resetPage(Page& p) const {
+    p.skyline.clear();
+    p.skyline.push_back(SkylineNode(0, 0, pageSize.x));
+}
+
+bool TextureAtlas::fit(const Page& p, unsigned int index, vec2ui size, unsigned int& y) const {
+    unsigned int x = p.skyline[index].x;
+    if(x + size.x > pageSize.x) return false;
+    int widthLeft = size.x;
+    y = p.skyline[index].y;
+    // The skyline always spans the whole page width, so this never runs past the end
+    for(unsigned int i = index; widthLeft > 0; ++i) {
+        y = std::max(y, p.skyline[i].y);
+        if(y + size.y > pageSize.y) return false;
+        widthLeft -= p.skyline[i].width;
+    }
+    return true;
+}
+
+bool TextureAtlas::findPosition(const Page& p, vec2ui size, unsigned int& index, vec2ui& position) const {
+    unsigned int bestY = pageSize.y + 1;
+    unsigned int bestWidth = pageSize.x + 1;
+    bool found = false;
+    for(unsigned int i = 0; i < p.skyline.size(); ++i) {
+        unsigned int y = 0;
+        if(!fit(p, i, size, y)) continue;
+        // Bottom-left: lowest position first, then the narrowest level
+        if(y < bestY || (y == bestY && p.skyline[i].width < bestWidth)) {
+            bestY = y;
+            bestWidth = p.skyline[i].width;
+            index = i;
+            position = vec2ui(p.skyline[i].x, y);
+            found = true;
+        }
+    }
+    return found;
+}
+
+void TextureAtlas::addSkylineLevel(Page& p, unsigned int index, vec2ui position, vec2ui size) const {
+    p.skyline.insert(p.skyline.begin() + index, SkylineNode(position.x, position.y + size.y, size.x));
+
+    // Shrink or remove the levels now covered by the new one
+    for(unsigned int i = index + 1; i < p.skyline.size(); ++i) {
+        unsigned int prevEnd = p.skyline[i-1].x + p.skyline[i-1].width;
+        if(p.skyline[i].x >= prevEnd) break;
+        unsigned int shrink = prevEnd - p.skyline[i].x;
+        if(p.skyline[i].width <= shrink) {
+            p.skyline.erase(p.skyline.begin() + i);
+            --i;
+        }
+        else {
+            p.skyline[i].x += shrink;
+            p.skyline[i].width -= shrink;
+            break;
+        }
+    }
+
+    // Merge levels at the same height
+    for(unsigned int i = 0; i + 1 < p.skyline.size(); ++i) {
+        if(p.skyline[i].y == p.skyline[i+1].y) {
+            p.skyline[i].width += p.skyline[i+1].width;
+            p.skyline.erase(p.skyline.begin() + i + 1);
+            --i;
+        }
+    }
+}
+
+bool TextureAtlas::place(Entry& e) {
+    unsigned int index = 0;
+    vec2ui position(0);
+    unsigned int page = 0;
+    while(page < pages.size() && !findPosition(pages[page], e.paddedSize, index, position))
+        ++page;
+    bool lost = false;
+    if(page == pages.size()) {
+        lost = addPage();
+        bool found = findPosition(pages[page], e.paddedSize, index, position);
+        VBE_ASSERT(found, "Image does not fit in an empty atlas page");
+        (void) found;
+    }
+    addSkylineLevel(pages[page], index, position, e.paddedSize);
+    pages[page].entryCount++;
+
+    e.region.page = page;
+    e.region.position = position + vec2ui(padding);
+    e.region.uvMin = vec2f(e.region.position)/vec2f(pageSize);
+    e.region.uvMax = vec2f(e.region.position + e.region.size)/vec2f(pageSize);
+    return lost;
+}
+
+bool TextureAtlas::addPage() {
+    pages.push_back(Page());
+    resetPage(pages.back());
+    unsigned int count = pages.size();
+
+#ifndef VBE_GLES2
+    if(type == PagesArray) {
+        if(array != nullptr && array->getSize().z >= count) return false;
+        // Grow the array geometrically. The previous contents are lost.
+        bool lost = (array != nullptr);
+        unsigned int slices = (array == nullptr ? 1 : array->getSize().z*2);
+        delete array;
+        array = new Texture2DArray(vec3ui(pageSize, slices), format);
+        array->setMaxLevel(mipLevelCount - 1);
+        return lost;
+    }
+#endif
+    if(textures.size() < count) {
+        textures.push_back(new Texture2D(pageSize, format));
+#ifndef VBE_GLES2
+        textures.back()->setMaxLevel(mipLevelCount - 1);
+#endif
+    }
+    return false;
+}
+
+void TextureAtlas::upload(const Entry& e) {
+    vec2ui corner = e.region.position - vec2ui(padding);
+    pages[e.region.page].dirty = true;
+#ifndef VBE_GLES2
+    if(type == PagesArray) {
+        array->setSubData(&e.pixels[0], vec3ui(corner, e.region.page), vec3ui(e.paddedSize, 1), TextureFormat::RGBA, TextureFormat::UNSIGNED_BYTE);
+        return;
+    }
+#endif
+    textures[e.region.page]->setSubData(&e.pixels[0], corner, e.paddedSize, TextureFormat::RGBA, TextureFormat::UNSIGNED_BYTE);
+}
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <vector>
+
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/TextureCache.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    // Otherwise the driver keeps the mip chain allocated
+    void dropMipmaps(vec2ui size, GLenum internalFormat, GLenum format, GLenum type) {
+        for(unsigned int level = 1; (size.x >> level) > 0 || (size.y >> level) > 0; ++level)
+            GL_ASSERT(glTexImage2D(GL_TEXTURE_2D, level, internalFormat, 0, 0, 0, format, type, nullptr));
+    }
+
+#ifndef VBE_GLES2
+    GLenum getIntegerFormat(TextureFormat::Format base) {
+        switch(base) {
+            case TextureFormat::RED: return GL_RED_INTEGER;
+            case TextureFormat::RG: return GL_RG_INTEGER;
+            case TextureFormat::RGB: return GL_RGB_INTEGER;
+            default: return GL_RGBA_INTEGER;
+        }
+    }
+#endif
+}
+
+// static
+std::list<TextureCache::Entry> TextureCache::entries;
+std::map<const Texture*, std::list<TextureCache::Entry>::iterator> TextureCache::lookup;
+unsigned long long TextureCache::budget = 0;
+unsigned long long TextureCache::usage = 0;
+unsigned int TextureCache::evictionLevel = 4;
+unsigned long long TextureCache::hits = 0;
+unsigned long long TextureCache::misses = 0;
+unsigned long long TextureCache::evictions = 0;
+bool TextureCache::updating = false;
+
+// static
+void TextureCache::add(Texture2D* tex, Loader loader) {
+    VBE_ASSERT(tex != nullptr, "Texture cannot be nullptr");
+    VBE_ASSERT(!tex->cached, "This texture is already managed by the TextureCache");
+#ifndef VBE_GLES2
+    VBE_ASSERT(!TextureFormat::isDepth(tex->getFormat()), "Depth textures cannot be managed by the TextureCache");
+    VBE_ASSERT(!tex->isBindless(), "Bindless textures cannot be managed by the TextureCache");
+#endif
+    entries.push_front(Entry(tex, loader));
+    lookup.insert(std::pair<const Texture*, std::list<Entry>::iterator>(tex, entries.begin()));
+    tex->cached = true;
+    entries.front().memory = tex->getEstimatedMemory();
+    usage += entries.front().memory;
+    trim();
+}
+
+// static
+void TextureCache::release(Texture2D* tex) {
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator it = lookup.find(tex);
+    if(it == lookup.end()) return;
+    if(it->second->evicted) reload(*it->second);
+    remove(tex);
+    tex->cached = false;
+}
+
+// static
+bool TextureCache::contains(const Texture* tex) {
+    return lookup.find(tex) != lookup.end();
+}
+
+// static
+bool TextureCache::isEvicted(const Texture* tex) {
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator it = lookup.find(tex);
+    return it != lookup.end() && it->second->evicted;
+}
+
+// static
+void TextureCache::setBudget(unsigned long long bytes) {
+    budget = bytes;
+    trim();
+}
+
+// static
+unsigned long long TextureCache::getBudget() {
+    return budget;
+}
+
+// static
+unsigned long long TextureCache::getUsage() {
+    return usage;
+}
+
+// static
+void TextureCache::setEvictionLevel(unsigned int level) {
+    evictionLevel = level;
+}
+
+// static
+unsigned int TextureCache::getEvictionLevel() {
+    return evictionLevel;
+}
+
+// static
+void TextureCache::trim() {
+    if(budget == 0 || entries.empty()) return;
+    // Never evict the most recently bound texture, it is probably about to be used.
+    std::list<Entry>::iterator it = entries.end();
+    --it;
+    while(usage > budget && it != entries.begin()) {
+        if(!it->evicted) evict(*it);
+        --it;
+    }
+}
+
+// static
+unsigned long long TextureCache::getHits() {
+    return hits;
+}
+
+// static
+unsigned long long TextureCache::getMisses() {
+    return misses;
+}
+
+// static
+unsigned long long TextureCache::getEvictions() {
+    return evictions;
+}
+
+// static
+void TextureCache::resetCounters() {
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+}
+
+// static
+void TextureCache::touch(const Texture* tex) {
+    if(updating) return;
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator it = lookup.find(tex);
+    if(it == lookup.end()) return;
+
+    // Move it to the front, list iterators stay valid
+    entries.splice(entries.begin(), entries, it->second);
+    Entry& e = entries.front();
+    if(!e.evicted) {
+        ++hits;
+        return;
+    }
+    ++misses;
+    reload(e);
+    trim();
+}
+
+// static
+void TextureCache::remove(const Texture* tex) {
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator it = lookup.find(tex);
+    if(it == lookup.end()) return;
+    usage -= it->second->memory;
+    entries.erase(it->second);
+    lookup.erase(it);
+}
+
+// static
+void TextureCache::swapEntries(Texture* a, Texture* b) {
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator ia = lookup.find(a);
+    std::map<const Texture*, std::list<Entry>::iterator>::iterator ib = lookup.find(b);
+    bool hasA = ia != lookup.end();
+    bool hasB = ib != lookup.end();
+    std::list<Entry>::iterator ea, eb;
+    if(hasA) { ea = ia->second; lookup.erase(ia); }
+    if(hasB) { eb = ib->second; lookup.erase(ib); }
+    // Only Texture2D can be managed, and swap only happens between textures of the same type.
+    if(hasA) {
+        ea->tex = static_cast<Texture2D*>(b);
+        lookup.insert(std::pair<const Texture*, std::list<Entry>::iterator>(b, ea));
+    }
+    if(hasB) {
+        eb->tex = static_cast<Texture2D*>(a);
+        lookup.insert(std::pair<const Texture*, std::list<Entry>::iterator>(a, eb));
+    }
+}
+
+// static
+void TextureCache::evict(Entry& e) {
+    VBE_DLOG("* TextureCache: evicting texture " << e.tex->getHandle() << " (" << e.memory << " bytes)");
+    updating = true;
+
+    Texture2D* tex = e.tex;
+    vec2ui size = tex->getSize();
+    vec2ui lowSize = glm::max(vec2ui(size.x >> evictionLevel, size.y >> evictionLevel), vec2ui(1));
+    TextureFormat::Format sourceFormat = TextureFormat::getBaseFormat(tex->getFormat());
+
+    Texture2D::bind(tex, 0);
+    GL_ASSERT(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GL_ASSERT(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+#ifndef VBE_GLES2
+    if(!TextureFormat::isInteger(tex->getFormat())) {
+        // Keep the mip level it shrinks to, so it still shows a blurry version of itself.
+        // Levels past the last one are 1x1, like the last one.
+        if(!tex->hasMipmaps())
+            GL_ASSERT(glGenerateMipmap(GL_TEXTURE_2D));
+        unsigned int level = 0;
+        while(level < evictionLevel && ((size.x >> (level + 1)) > 0 || (size.y >> (level + 1)) > 0))
+            ++level;
+        std::vector<float> pixels(std::size_t(lowSize.x)*lowSize.y*4);
+        GL_ASSERT(glGetTexImage(GL_TEXTURE_2D, level, sourceFormat, GL_FLOAT, pixels.data()));
+        dropMipmaps(size, tex->getFormat(), sourceFormat, GL_FLOAT);
+        GL_ASSERT(glTexImage2D(GL_TEXTURE_2D, 0, tex->getFormat(), lowSize.x, lowSize.y, 0, sourceFormat, GL_FLOAT, pixels.data()));
+    }
+    else {
+        // Integer textures can't be filtered, they are cleared instead
+        if(tex->hasMipmaps()) dropMipmaps(size, tex->getFormat(), getIntegerFormat(sourceFormat), GL_UNSIGNED_INT);
+        std::vector<GLuint> zeros(std::size_t(lowSize.x)*lowSize.y*4, 0);
+        GL_ASSERT(glTexImage2D(GL_TEXTURE_2D, 0, tex->getFormat(), lowSize.x, lowSize.y, 0, getIntegerFormat(sourceFormat), GL_UNSIGNED_INT, zeros.data()));
+    }
+#else
+    // Texture contents can't be read back on GLES2, they are cleared instead
+    if(tex->hasMipmaps()) dropMipmaps(size, tex->getFormat(), sourceFormat, GL_UNSIGNED_BYTE);
+    std::vector<GLubyte> zeros(std::size_t(lowSize.x)*lowSize.y*4, 0);
+    GL_ASSERT(glTexImage2D(GL_TEXTURE_2D, 0, tex->getFormat(), lowSize.x, lowSize.y, 0, sourceFormat, GL_UNSIGNED_BYTE, zeros.data()));
+#endif
+
+    // Only level 0 is left, sampling with a mipmap filter would find the texture incomplete
+#ifndef VBE_GLES2
+    GL_ASSERT(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &e.maxLevel));
+    GL_ASSERT(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0));
+#else
+    // There is no max level on GLES2, the filter is changed instead
+    GL_ASSERT(glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &e.minFilter));
+    if(e.minFilter != GL_NEAREST && e.minFilter != GL_LINEAR)
+        GL_ASSERT(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+#endif
+
+    usage -= e.memory;
+    e.memory = evictedMemory(tex);
+    usage += e.memory;
+    e.evicted = true;
+    ++evictions;
+
+    updating = false;
+}
+
+// static
+void TextureCache::reload(Entry& e) {
+    VBE_DLOG("* TextureCache: reloading texture " << e.tex->getHandle());
+    updating = true;
+
+    Texture2D* tex = e.tex;
+    Texture2D::bind(tex, 0);
+#ifndef VBE_GLES2
+    GL_ASSERT(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, e.maxLevel));
+#else
+    GL_ASSERT(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, e.minFilter));
+#endif
+    e.loader(*tex);
+    if(tex->hasMipmaps())
+        tex->generateMipmap();
+
+    usage -= e.memory;
+    e.memory = tex->getEstimatedMemory();
+    usage += e.memory;
+    e.evicted = false;
+
+    updating = false;
+}
+
+// static
+unsigned long long TextureCache::evictedMemory(const Texture2D* tex) {
+    vec2ui size = tex->getSize();
+    unsigned long long w = std::max(size.x >> evictionLevel, 1u);
+    unsigned long long h = std::max(size.y >> evictionLevel, 1u);
+    return w*h*TextureFormat::getPixelSize(tex->getFormat());
+}
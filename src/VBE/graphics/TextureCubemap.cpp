@@ -85,6 +85,10 @@ unsigned int TextureCubemap::getSize() const {
     return size;
 }
 
+unsigned int TextureCubemap::getTexelCount() const {
+    return 6*size*size;
+}
+
 TextureCubemap::TextureCubemap(TextureCubemap&& rhs) : TextureCubemap() {
     using std::swap;
     swap(*this, rhs);
@@ -73,6 +73,10 @@ unsigned int TextureCubemapArray::getSlices() const {
 	return slices;
 }
 
+unsigned int TextureCubemapArray::getTexelCount() const {
+	return 6*slices*size*size;
+}
+
 TextureCubemapArray::TextureCubemapArray(TextureCubemapArray&& rhs) : TextureCubemapArray() {
 	using std::swap;
 	swap(*this, rhs);
@@ -0,0 +1,84 @@
+#include <VBE/config.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Sampler.hpp>
+#include <VBE/graphics/Texture.hpp>
+#include <VBE/graphics/TextureHandleTable.hpp>
+#include <VBE/system/Log.hpp>
+
+// Bindless textures are not supported in GLES2
+#ifndef VBE_GLES2
+
+TextureHandleTable::TextureHandleTable() {
+    VBE_ASSERT(Texture::isBindlessSupported(), "ARB_bindless_texture is not supported");
+    GL_ASSERT(glGenBuffers(1, &buffer));
+}
+
+TextureHandleTable::~TextureHandleTable() {
+    GL_ASSERT(glDeleteBuffers(1, &buffer));
+}
+
+unsigned int TextureHandleTable::add(const Texture& tex) {
+    return add(tex.getBindlessHandle());
+}
+
+unsigned int TextureHandleTable::add(const Texture& tex, const Sampler& sampler) {
+    return add(tex.getBindlessHandle(sampler));
+}
+
+void TextureHandleTable::set(unsigned int index, const Texture& tex) {
+    set(index, tex.getBindlessHandle());
+}
+
+void TextureHandleTable::set(unsigned int index, const Texture& tex, const Sampler& sampler) {
+    set(index, tex.getBindlessHandle(sampler));
+}
+
+void TextureHandleTable::clear() {
+    handles.clear();
+    indices.clear();
+    dirty = true;
+}
+
+unsigned int TextureHandleTable::size() const {
+    return handles.size();
+}
+
+void TextureHandleTable::bind(unsigned int bindingPoint) const {
+    if(dirty && !handles.empty()) {
+        GL_ASSERT(glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer));
+        if(handles.size() > bufferSize) {
+            bufferSize = handles.size();
+            GL_ASSERT(glBufferData(GL_SHADER_STORAGE_BUFFER, bufferSize*sizeof(GLuint64), &handles[0], GL_DYNAMIC_DRAW));
+        }
+        else
+            GL_ASSERT(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, handles.size()*sizeof(GLuint64), &handles[0]));
+        dirty = false;
+    }
+    GL_ASSERT(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, buffer));
+}
+
+GLuint TextureHandleTable::getHandle() const {
+    return buffer;
+}
+
+unsigned int TextureHandleTable::add(GLuint64 handle) {
+    std::map<GLuint64, unsigned int>::iterator it = indices.find(handle);
+    if(it != indices.end()) return it->second;
+    unsigned int index = handles.size();
+    handles.push_back(handle);
+    indices.insert(std::pair<GLuint64, unsigned int>(handle, index));
+    dirty = true;
+    return index;
+}
+
+void TextureHandleTable::set(unsigned int index, GLuint64 handle) {
+    VBE_ASSERT(index < handles.size(), "Invalid index on TextureHandleTable::set");
+    std::map<GLuint64, unsigned int>::iterator it = indices.find(handles[index]);
+    if(it != indices.end() && it->second == index) indices.erase(it);
+    handles[index] = handle;
+    if(indices.find(handle) == indices.end())
+        indices.insert(std::pair<GLuint64, unsigned int>(handle, index));
+    dirty = true;
+}
+
+#endif // VBE_GLES2
@@ -1,10 +1,12 @@
 #include <VBE/config.hpp>
 #include <VBE/graphics/OpenGL.hpp>
+#include <VBE/graphics/Sampler.hpp>
 #include <VBE/graphics/Texture2D.hpp>
 #include <VBE/graphics/Texture3D.hpp>
 #include <VBE/graphics/Texture2DArray.hpp>
 #include <VBE/graphics/TextureCubemap.hpp>
 #include <VBE/graphics/TextureCubemapArray.hpp>
+#include <VBE/graphics/Texture2DMultisample.hpp>
 #include <VBE/graphics/Uniform.hpp>
 #include <VBE/system/Log.hpp>
 
@@ -67,6 +69,9 @@ Uniform::Uniform(unsigned int count, GLenum type, GLint location) :
         case GL_UNSIGNED_INT_SAMPLER_CUBE:
         case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
         case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
 #endif
             size = sizeof(GLint);
             break;
@@ -198,6 +203,7 @@ void Uniform::set(const Texture2D& val) {
     VBE_ASSERT(type == GL_SAMPLER_2D, "Wrong uniform type. Location " << this->location);
 #else
     VBE_ASSERT(type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW || type == GL_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_2D, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(nullptr, texUnit);
 #endif
     Texture2D::bind(&val, texUnit);
     setBytes((char*)&texUnit);
@@ -211,6 +217,7 @@ void Uniform::set(const Texture3D* val) {
 
 void Uniform::set(const Texture3D& val) {
     VBE_ASSERT(type == GL_SAMPLER_3D || type == GL_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_3D, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(nullptr, texUnit);
     Texture3D::bind(&val, texUnit);
     setBytes((char*)&texUnit);
 }
@@ -222,6 +229,7 @@ void Uniform::set(const Texture2DArray* val) {
 
 void Uniform::set(const Texture2DArray& val) {
     VBE_ASSERT(type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_INT_SAMPLER_2D_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(nullptr, texUnit);
     Texture2DArray::bind(&val, texUnit);
     setBytes((char*)&texUnit);
 }
@@ -233,6 +241,7 @@ void Uniform::set(const TextureCubemap* val) {
 
 void Uniform::set(const TextureCubemap& val) {
     VBE_ASSERT(type == GL_SAMPLER_CUBE || type == GL_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_CUBE, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(nullptr, texUnit);
     TextureCubemap::bind(&val, texUnit);
     setBytes((char*)&texUnit);
 }
@@ -244,6 +253,53 @@ void Uniform::set(const TextureCubemapArray* val) {
 
 void Uniform::set(const TextureCubemapArray& val) {
     VBE_ASSERT(type == GL_SAMPLER_CUBE_MAP_ARRAY || type == GL_INT_SAMPLER_CUBE_MAP_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(nullptr, texUnit);
+    TextureCubemapArray::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const Texture2DMultisample* val) {
+    VBE_ASSERT(val != nullptr, "Texture 'val' cannot be nullptr");
+    set(*val);
+}
+
+void Uniform::set(const Texture2DMultisample& val) {
+    VBE_ASSERT(type == GL_SAMPLER_2D_MULTISAMPLE || type == GL_INT_SAMPLER_2D_MULTISAMPLE || type == GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE, "Wrong uniform type. Location " << this->location);
+    Texture2DMultisample::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const Texture2D& val, const Sampler& sampler) {
+    VBE_ASSERT(type == GL_SAMPLER_2D || type == GL_SAMPLER_2D_SHADOW || type == GL_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_2D, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(&sampler, texUnit);
+    Texture2D::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const Texture3D& val, const Sampler& sampler) {
+    VBE_ASSERT(type == GL_SAMPLER_3D || type == GL_INT_SAMPLER_3D || type == GL_UNSIGNED_INT_SAMPLER_3D, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(&sampler, texUnit);
+    Texture3D::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const Texture2DArray& val, const Sampler& sampler) {
+    VBE_ASSERT(type == GL_SAMPLER_2D_ARRAY || type == GL_SAMPLER_2D_ARRAY_SHADOW || type == GL_INT_SAMPLER_2D_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_2D_ARRAY, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(&sampler, texUnit);
+    Texture2DArray::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const TextureCubemap& val, const Sampler& sampler) {
+    VBE_ASSERT(type == GL_SAMPLER_CUBE || type == GL_INT_SAMPLER_CUBE || type == GL_UNSIGNED_INT_SAMPLER_CUBE, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(&sampler, texUnit);
+    TextureCubemap::bind(&val, texUnit);
+    setBytes((char*)&texUnit);
+}
+
+void Uniform::set(const TextureCubemapArray& val, const Sampler& sampler) {
+    VBE_ASSERT(type == GL_SAMPLER_CUBE_MAP_ARRAY || type == GL_INT_SAMPLER_CUBE_MAP_ARRAY || type == GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY, "Wrong uniform type. Location " << this->location);
+    Sampler::bind(&sampler, texUnit);
     TextureCubemapArray::bind(&val, texUnit);
     setBytes((char*)&texUnit);
 }
@@ -282,6 +338,9 @@ void Uniform::ready() { //assumes program is binded already. Only to be called b
         case GL_UNSIGNED_INT_SAMPLER_CUBE:
         case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
         case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
 #endif
         case GL_SAMPLER_2D:	GL_ASSERT(glUniform1iv(location, count, (GLint*)&lastValue[0])); break;
         case GL_INT_VEC2:	GL_ASSERT(glUniform2iv(location, count, (GLint*)&lastValue[0])); break;
@@ -376,6 +435,9 @@ bool Uniform::isSampler(GLenum uniformType) {
         case GL_UNSIGNED_INT_SAMPLER_CUBE:
         case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
         case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
 #endif
         case GL_SAMPLER_2D:
             return true;
@@ -58,6 +58,9 @@ namespace Vertex {
                 case Attribute::UnsignedInt:   size = sizeof(GLuint); break;
                 case Attribute::Float:         size = sizeof(GLfloat); break;
                 case Attribute::Fixed:         size = sizeof(GLint); break; //FIXME: GLFixed no existe para mi (?)
+#ifndef VBE_GLES2
+                case Attribute::HalfFloat:     size = sizeof(GLhalf); break;
+#endif
                 default: VBE_ASSERT(0, "Not a knownt element type " << elements[i].type); break;
             }
             offset += elements[i].size * size;
@@ -1,22 +1,66 @@
+#include <atomic>
+
 #include <VBE/system/Clock.hpp>
 #include <VBE/system/ClockImpl.hpp>
 
+namespace {
+    // Running estimate of how late the OS sleep wakes up, in nanoseconds
+    std::atomic<long long> oversleepMean(500000);
+    std::atomic<long long> oversleepDeviation(250000);
+
+    // The platform counters start at boot, which is far enough for a float to lose whole frames
+    long long getElapsedNanoseconds() {
+        static const long long epoch = ClockImpl::getNanoseconds();
+        return ClockImpl::getNanoseconds() - epoch;
+    }
+}
+
 // static
 float Clock::getSeconds() {
-    return ClockImpl::getMicroseconds() * 1e-6f;
+    return getElapsedNanoseconds() * 1e-9;
 }
 
 // static
 long long Clock::getMicroseconds() {
-    return ClockImpl::getMicroseconds();
+    return getElapsedNanoseconds() / 1000;
+}
+
+// static
+long long Clock::getNanoseconds() {
+    return getElapsedNanoseconds();
 }
 
 // static
 void Clock::sleepSeconds(float seconds) {
-    ClockImpl::sleepMicroseconds(seconds * 1e6);
+    sleepNanoseconds(seconds * 1e9);
 }
 
 // static
 void Clock::sleepMicroseconds(long long useconds) {
-    ClockImpl::sleepMicroseconds(useconds);
+    sleepNanoseconds(useconds * 1000);
+}
+
+// static
+void Clock::sleepNanoseconds(long long nseconds) {
+    if(nseconds <= 0) return;
+    long long now = ClockImpl::getNanoseconds();
+    const long long deadline = now + nseconds;
+
+    // The OS sleeps with millisecond granularity and wakes up late by a varying amount.
+    // Sleep while even a late wakeup lands before the deadline, learning how late it is.
+    long long margin = oversleepMean + 2*oversleepDeviation;
+    while(deadline - now > 1000000 + margin) {
+        unsigned int mseconds = (deadline - now - margin)/1000000;
+        long long before = now;
+        ClockImpl::sleepMilliseconds(mseconds);
+        now = ClockImpl::getNanoseconds();
+
+        long long delta = (now - before - mseconds*1000000LL) - oversleepMean;
+        oversleepMean += delta/16;
+        oversleepDeviation += ((delta < 0 ? -delta : delta) - oversleepDeviation)/16;
+        margin = oversleepMean + 2*oversleepDeviation;
+    }
+
+    // Busy-wait the remaining fraction of a millisecond
+    while(now < deadline) now = ClockImpl::getNanoseconds();
 }
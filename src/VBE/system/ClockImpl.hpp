@@ -4,6 +4,8 @@
 #include <VBE/system/sdl2/ClockImpl.hpp>
 #elif defined(VBE_SYSTEM_ANDROID)
 #include <VBE/system/android/ClockImpl.hpp>
+#elif defined(VBE_SYSTEM_HEADLESS)
+#include <VBE/system/headless/ClockImpl.hpp>
 #else
 #error No system defined
 #endif
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cmath>
+
+#include <VBE/system/Clock.hpp>
+#include <VBE/system/FramePacer.hpp>
+#include <VBE/system/Log.hpp>
+#include <VBE/system/Window.hpp>
+
+namespace {
+    float toMilliseconds(long long nseconds) {
+        return nseconds * 1e-6f;
+    }
+
+    // Nearest-rank percentile of sorted values
+    long long percentile(const std::vector<long long>& sorted, float p) {
+        if(sorted.empty()) return 0;
+        long long rank = (long long) std::ceil(p/100.0f*sorted.size());
+        return sorted[std::min(std::max(rank, 1LL), (long long) sorted.size()) - 1];
+    }
+}
+
+FramePacer::FramePacer(float targetFrameRate, unsigned int historySize) : historySize(historySize) {
+    VBE_ASSERT(historySize > 0, "Frame history size must not be zero");
+    history.reserve(historySize);
+    setTargetFrameRate(targetFrameRate);
+}
+
+void FramePacer::setTargetFrameRate(float fps) {
+    VBE_ASSERT(fps >= 0.0f, "Target frame rate can't be negative");
+    period = (fps > 0.0f ? (long long) (1e9/fps) : 0);
+    // Start a new cadence from the next frame
+    deadline = 0;
+}
+
+float FramePacer::getTargetFrameRate() const {
+    return period > 0 ? 1e9f/period : 0.0f;
+}
+
+void FramePacer::wait() {
+    long long now = Clock::getNanoseconds();
+    sleepTime = 0;
+    frameStart = now;
+    if(period == 0) return;
+    if(deadline == 0) deadline = now + period;
+
+    long long wake = deadline - (costMean + 2*costDeviation);
+    if(wake <= now) return;
+    Clock::sleepNanoseconds(wake - now);
+    frameStart = Clock::getNanoseconds();
+    sleepTime = frameStart - now;
+}
+
+void FramePacer::swapBuffers(const Window& window) {
+    long long before = Clock::getNanoseconds();
+    window.swapBuffers();
+    swapTime = Clock::getNanoseconds() - before;
+    endFrame();
+}
+
+void FramePacer::endFrame() {
+    long long now = Clock::getNanoseconds();
+
+    Frame f;
+    f.work = (frameStart == 0 ? 0 : now - frameStart);
+    f.sleep = sleepTime;
+    f.swap = swapTime;
+    if(lastPresent != 0) {
+        f.interval = now - lastPresent;
+        if(history.size() < historySize)
+            history.push_back(f);
+        else
+            history[historyNext] = f;
+        historyNext = (historyNext + 1) % historySize;
+    }
+
+    // Running average and deviation of the frame cost, used to predict the next one
+    long long delta = f.work - costMean;
+    costMean += delta/8;
+    costDeviation += ((delta < 0 ? -delta : delta) - costDeviation)/8;
+
+    if(period > 0 && deadline != 0) {
+        if(now > deadline) ++missedDeadlines;
+        deadline += period;
+        // Don't rush frames to catch up after a stall
+        if(deadline <= now) deadline = now + period;
+    }
+
+    lastPresent = now;
+    frameStart = now;
+    sleepTime = 0;
+    swapTime = 0;
+}
+
+FramePacer::Stats FramePacer::getStats() const {
+    Stats s;
+    s.missedDeadlines = missedDeadlines;
+    s.frames = history.size();
+    if(history.empty()) return s;
+
+    std::vector<long long> intervals;
+    intervals.reserve(history.size());
+    long long interval = 0, work = 0, sleep = 0, swap = 0;
+    for(const Frame& f : history) {
+        intervals.push_back(f.interval);
+        interval += f.interval;
+        work += f.work;
+        sleep += f.sleep;
+        swap += f.swap;
+    }
+    std::sort(intervals.begin(), intervals.end());
+
+    s.average = toMilliseconds(interval/s.frames);
+    s.min = toMilliseconds(intervals.front());
+    s.max = toMilliseconds(intervals.back());
+    s.p50 = toMilliseconds(percentile(intervals, 50.0f));
+    s.p95 = toMilliseconds(percentile(intervals, 95.0f));
+    s.p99 = toMilliseconds(percentile(intervals, 99.0f));
+    s.work = toMilliseconds(work/s.frames);
+    s.sleep = toMilliseconds(sleep/s.frames);
+    s.swap = toMilliseconds(swap/s.frames);
+    return s;
+}
+
+float FramePacer::getPercentile(float p) const {
+    VBE_ASSERT(p >= 0.0f && p <= 100.0f, "Percentile must be between 0 and 100");
+    std::vector<long long> intervals;
+    intervals.reserve(history.size());
+    for(const Frame& f : history) intervals.push_back(f.interval);
+    std::sort(intervals.begin(), intervals.end());
+    return toMilliseconds(percentile(intervals, p));
+}
+
+std::vector<unsigned int> FramePacer::getHistogram(float bucketWidth, unsigned int buckets) const {
+    VBE_ASSERT(bucketWidth > 0.0f, "Histogram bucket width must be positive");
+    VBE_ASSERT(buckets > 0, "Histogram must have at least one bucket");
+    std::vector<unsigned int> histogram(buckets, 0);
+    for(const Frame& f : history) {
+        unsigned int b = (unsigned int) std::min(toMilliseconds(f.interval)/bucketWidth, float(buckets - 1));
+        histogram[b]++;
+    }
+    return histogram;
+}
+
+float FramePacer::getPredictedCost() const {
+    return toMilliseconds(costMean + 2*costDeviation);
+}
+
+unsigned int FramePacer::getHistorySize() const {
+    return historySize;
+}
+
+void FramePacer::reset() {
+    history.clear();
+    historyNext = 0;
+    missedDeadlines = 0;
+}
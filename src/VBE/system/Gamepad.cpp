@@ -1,5 +1,6 @@
 #include <VBE/system/Gamepad.hpp>
 #include <VBE/system/InputImpl.hpp>
+#include <VBE/system/Log.hpp>
 
 bool Gamepad::buttonsOld[COUNT][Gamepad::ButtonCount];
 
@@ -4,6 +4,8 @@
 #include <VBE/system/sdl2/InputImpl.hpp>
 #elif defined(VBE_SYSTEM_ANDROID)
 #include <VBE/system/android/InputImpl.hpp>
+#elif defined(VBE_SYSTEM_HEADLESS)
+#include <VBE/system/headless/InputImpl.hpp>
 #else
 #error No system defined
 #endif
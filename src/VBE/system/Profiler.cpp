@@ -0,0 +1,207 @@
+#include <VBE/system/Profiler.hpp>
+
+#ifdef VBE_PROFILER
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <ostream>
+
+#include <VBE/graphics/GpuProfiler.hpp>
+#include <VBE/system/Clock.hpp>
+#include <VBE/system/Log.hpp>
+
+namespace {
+    void writeJsonString(std::ostream& out, const std::string& s) {
+        out << '"';
+        for(char c : s) {
+            if(c == '"' || c == '\\') out << '\\' << c;
+            else if((unsigned char) c < 0x20) out << ' ';
+            else out << c;
+        }
+        out << '"';
+    }
+
+    void writeTraceEvent(std::ostream& out, bool& first, const std::string& name, const char* category,
+                         unsigned int tid, long long beginNs, long long endNs) {
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        writeJsonString(out, name);
+        out << ",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid
+            << ",\"ts\":" << beginNs/1000.0 << ",\"dur\":" << (endNs - beginNs)/1000.0 << "}";
+        first = false;
+    }
+
+    void writeThreadName(std::ostream& out, bool& first, unsigned int tid, const std::string& name) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":";
+        writeJsonString(out, name);
+        out << "}}";
+        first = false;
+    }
+}
+
+// static
+std::atomic<unsigned int> Profiler::capacity(65536);
+std::mutex Profiler::threadsMutex;
+std::vector<Profiler::ThreadBuffer*> Profiler::threads;
+thread_local Profiler::ThreadBuffer* Profiler::threadBuffer = nullptr;
+
+// static
+void Profiler::begin(const char* name) {
+    ThreadBuffer* b = getThreadBuffer();
+    Open o;
+    o.name = name;
+    o.children = 0;
+    b->open.push_back(o);
+    // Read the clock last so the bookkeeping is not measured
+    b->open.back().begin = Clock::getNanoseconds();
+}
+
+// static
+void Profiler::end() {
+    long long now = Clock::getNanoseconds();
+    ThreadBuffer* b = threadBuffer;
+    VBE_ASSERT(b != nullptr && !b->open.empty(), "Profiler::end called without a matching begin");
+    Open o = b->open.back();
+    b->open.pop_back();
+    long long duration = now - o.begin;
+    if(!b->open.empty()) b->open.back().children += duration;
+
+    unsigned long long n = b->count.load(std::memory_order_relaxed);
+    Event& e = b->events[n % b->events.size()];
+    e.name = o.name;
+    e.begin = o.begin;
+    e.end = now;
+    e.self = duration - o.children;
+    e.depth = b->open.size();
+    // Publishes the event to readers
+    b->count.store(n + 1, std::memory_order_release);
+}
+
+// static
+void Profiler::setThreadName(const char* name) {
+    ThreadBuffer* b = getThreadBuffer();
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    b->name = name;
+}
+
+// static
+void Profiler::setThreadCapacity(unsigned int zones) {
+    VBE_ASSERT(zones > 0, "Profiler thread capacity must not be zero");
+    capacity = zones;
+}
+
+// static
+std::vector<Profiler::ZoneStats> Profiler::getSummary() {
+    std::map<std::string, ZoneStats> zones;
+    std::vector<Event> events;
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for(ThreadBuffer* b : threads) {
+        events.clear();
+        collect(*b, events);
+        for(const Event& e : events) {
+            ZoneStats& s = zones[e.name];
+            double ms = (e.end - e.begin)*1e-6;
+            s.min = (s.calls == 0 ? ms : std::min(s.min, ms));
+            s.max = (s.calls == 0 ? ms : std::max(s.max, ms));
+            s.total += ms;
+            s.self += e.self*1e-6;
+            s.calls++;
+        }
+    }
+
+    std::vector<ZoneStats> result;
+    for(std::pair<const std::string, ZoneStats>& z : zones) {
+        z.second.name = z.first;
+        z.second.avg = z.second.total/z.second.calls;
+        result.push_back(z.second);
+    }
+    return result;
+}
+
+// static
+void Profiler::writeSummary(std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(3);
+    out << std::left << std::setw(40) << "zone" << std::right
+        << std::setw(10) << "calls" << std::setw(12) << "total" << std::setw(12) << "self"
+        << std::setw(10) << "min" << std::setw(10) << "avg" << std::setw(10) << "max" << " (ms)\n";
+    for(const ZoneStats& s : getSummary()) {
+        out << std::left << std::setw(40) << s.name << std::right
+            << std::setw(10) << s.calls << std::setw(12) << s.total << std::setw(12) << s.self
+            << std::setw(10) << s.min << std::setw(10) << s.avg << std::setw(10) << s.max << "\n";
+    }
+    out.flags(flags);
+}
+
+// static
+void Profiler::writeChromeTrace(std::ostream& out) {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    std::vector<Event> events;
+    unsigned int threadCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        threadCount = threads.size();
+        for(ThreadBuffer* b : threads) {
+            if(!b->name.empty()) writeThreadName(out, first, b->id, b->name);
+            events.clear();
+            collect(*b, events);
+            for(const Event& e : events)
+                writeTraceEvent(out, first, e.name, "cpu", b->id, e.begin, e.end);
+        }
+    }
+#ifndef VBE_GLES2
+    // GPU scopes get a track after the last thread
+    if(!GpuProfiler::getEvents().empty()) {
+        writeThreadName(out, first, threadCount, "GPU");
+        for(const GpuProfiler::Event& e : GpuProfiler::getEvents())
+            writeTraceEvent(out, first, e.name, "gpu", threadCount, e.begin*1000, e.end*1000);
+    }
+#endif
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out.precision(precision);
+    out.flags(flags);
+}
+
+// static
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    for(ThreadBuffer* b : threads)
+        b->start = b->count.load(std::memory_order_acquire);
+}
+
+// static
+Profiler::ThreadBuffer* Profiler::getThreadBuffer() {
+    if(threadBuffer == nullptr) {
+        // Once per thread. Buffers are never freed so traces keep the zones of finished threads.
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        threadBuffer = new ThreadBuffer(threads.size(), capacity);
+        threadBuffer->open.reserve(64);
+        threads.push_back(threadBuffer);
+    }
+    return threadBuffer;
+}
+
+// static
+void Profiler::collect(ThreadBuffer& b, std::vector<Event>& out) {
+    const unsigned long long size = b.events.size();
+    unsigned long long end = b.count.load(std::memory_order_acquire);
+    unsigned long long begin = std::max(b.start.load(), end > size ? end - size : 0);
+    unsigned int first = out.size();
+    for(unsigned long long i = begin; i < end; ++i)
+        out.push_back(b.events[i % size]);
+
+    // The owner thread may have wrapped around while copying. Drop what it overwrote,
+    // including the slot it may be writing right now.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    unsigned long long now = b.count.load(std::memory_order_relaxed);
+    if(now + 1 > begin + size) {
+        unsigned long long overwritten = std::min(end, now + 1 - size) - begin;
+        out.erase(out.begin() + first, out.begin() + first + overwritten);
+    }
+}
+
+#endif // VBE_PROFILER
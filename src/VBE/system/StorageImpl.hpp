@@ -4,6 +4,8 @@
 #include <VBE/system/sdl2/StorageImpl.hpp>
 #elif defined(VBE_SYSTEM_ANDROID)
 #include <VBE/system/android/StorageImpl.hpp>
+#elif defined(VBE_SYSTEM_HEADLESS)
+#include <VBE/system/headless/StorageImpl.hpp>
 #else
 #error No system defined
 #endif
@@ -4,6 +4,8 @@
 #include <VBE/system/sdl2/WindowImpl.hpp>
 #elif defined(VBE_SYSTEM_ANDROID)
 #include <VBE/system/android/WindowImpl.hpp>
+#elif defined(VBE_SYSTEM_HEADLESS)
+#include <VBE/system/headless/WindowImpl.hpp>
 #else
 #error No system defined
 #endif
@@ -1,17 +1,18 @@
 #include <VBE/system/android/ClockImpl.hpp>
 
 #include <time.h>
-#include <unistd.h>
 
 // static
-float ClockImpl::getSeconds() {
+long long ClockImpl::getNanoseconds() {
     struct timespec monotime;
     clock_gettime(CLOCK_MONOTONIC, &monotime);
-
-    return monotime.tv_sec + monotime.tv_nsec*1e-9f;
+    return monotime.tv_sec*1000000000LL + monotime.tv_nsec;
 }
 
 // static
-void ClockImpl::sleepSeconds(float seconds) {
-    usleep(seconds*1e6f + 0.5);
+void ClockImpl::sleepMilliseconds(unsigned int mseconds) {
+    struct timespec duration;
+    duration.tv_sec = mseconds/1000;
+    duration.tv_nsec = (mseconds%1000)*1000000L;
+    nanosleep(&duration, nullptr);
 }
@@ -4,8 +4,8 @@
 class ClockImpl
 {
     public:
-        static float getSeconds();
-        static void sleepSeconds(float seconds);
+        static long long getNanoseconds();
+        static void sleepMilliseconds(unsigned int mseconds);
 };
 
 #endif // CLOCKIMPL_HPP
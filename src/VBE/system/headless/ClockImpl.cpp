@@ -0,0 +1,18 @@
+#include <VBE/system/headless/ClockImpl.hpp>
+
+#include <time.h>
+
+// static
+long long ClockImpl::getNanoseconds() {
+    struct timespec monotime;
+    clock_gettime(CLOCK_MONOTONIC, &monotime);
+    return monotime.tv_sec*1000000000LL + monotime.tv_nsec;
+}
+
+// static
+void ClockImpl::sleepMilliseconds(unsigned int mseconds) {
+    struct timespec duration;
+    duration.tv_sec = mseconds/1000;
+    duration.tv_nsec = (mseconds%1000)*1000000L;
+    nanosleep(&duration, nullptr);
+}
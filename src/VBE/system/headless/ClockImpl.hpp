@@ -0,0 +1,11 @@
+#ifndef CLOCKIMPL_HPP
+#define CLOCKIMPL_HPP
+
+class ClockImpl
+{
+    public:
+        static long long getNanoseconds();
+        static void sleepMilliseconds(unsigned int mseconds);
+};
+
+#endif // CLOCKIMPL_HPP
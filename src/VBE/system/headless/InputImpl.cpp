@@ -0,0 +1,89 @@
+#include <VBE/system/headless/InputImpl.hpp>
+
+// static
+bool InputImpl::keyPresses[Keyboard::KeyCount];
+bool InputImpl::mouseButtonPresses[Mouse::ButtonCount];
+vec2i InputImpl::mousePos;
+std::vector<Touch::Finger> InputImpl::fingers;
+
+// static
+void InputImpl::init() {
+    mousePos = vec2i(0, 0);
+    for(int i = 0; i < Keyboard::KeyCount; i++)
+        keyPresses[i] = false;
+    for(int i = 0; i < Mouse::ButtonCount; i++)
+        mouseButtonPresses[i] = false;
+}
+
+// static
+void InputImpl::update() {
+}
+
+// static
+const bool* InputImpl::getKeyPresses() {
+    return keyPresses;
+}
+
+// static
+const bool* InputImpl::getMouseButtonPresses() {
+    return mouseButtonPresses;
+}
+
+// static
+void InputImpl::setMousePosition(int x, int y) {
+    mousePos = vec2i(x, y);
+}
+
+// static
+bool InputImpl::isGamepadConnected(int id) {
+    (void) id;
+    return false;
+}
+
+// static
+float InputImpl::getGamepadAxis(int id, int axis) {
+    (void) id;
+    (void) axis;
+    return 0.0f;
+}
+
+// static
+bool InputImpl::getGamepadButtonPressed(int id, Gamepad::Button but) {
+    (void) id;
+    (void) but;
+    return false;
+}
+
+// static
+bool InputImpl::getGamepadButtonJustPressed(int id, int but) {
+    (void) id;
+    (void) but;
+    return false;
+}
+
+// static
+bool InputImpl::getGamepadButtonJustReleased(int id, int but) {
+    (void) id;
+    (void) but;
+    return false;
+}
+
+// static
+void InputImpl::setCursorVisible(bool visible) {
+    (void) visible;
+}
+
+// static
+void InputImpl::setGrab(bool grab) {
+    (void) grab;
+}
+
+// static
+void InputImpl::setRelativeMouseMode(bool relative) {
+    (void) relative;
+}
+
+// static
+const std::vector<Touch::Finger>& InputImpl::getFingers() {
+    return fingers;
+}
@@ -0,0 +1,44 @@
+#ifndef INPUTIMPL_HPP
+#define INPUTIMPL_HPP
+
+#include <vector>
+
+#include <VBE/system/Mouse.hpp>
+#include <VBE/system/Keyboard.hpp>
+#include <VBE/system/Gamepad.hpp>
+#include <VBE/system/Touch.hpp>
+
+// There are no input devices without a display, everything stays released
+class InputImpl {
+    public:
+        static void init();
+        static void update();
+
+        static const bool* getKeyPresses();
+        static const bool* getMouseButtonPresses();
+
+        static void setMousePosition(int x, int y);
+
+        static vec2i getMousePosition() { return mousePos; }
+        static vec2i getMouseWheelPosition() { return vec2i(0, 0); }
+
+        static bool isGamepadConnected(int id);
+        static float getGamepadAxis(int id, int axis);
+        static bool getGamepadButtonPressed(int id, Gamepad::Button but);
+        static bool getGamepadButtonJustPressed(int id, int but);
+        static bool getGamepadButtonJustReleased(int id, int but);
+
+        static void setCursorVisible(bool visible);
+        static void setGrab(bool grab);
+        static void setRelativeMouseMode(bool relative);
+
+        static const std::vector<Touch::Finger>& getFingers();
+
+    private:
+        static bool keyPresses[Keyboard::KeyCount];
+        static bool mouseButtonPresses[Mouse::ButtonCount];
+        static vec2i mousePos;
+        static std::vector<Touch::Finger> fingers;
+};
+
+#endif // INPUTIMPL_HPP
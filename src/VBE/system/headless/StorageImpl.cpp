@@ -0,0 +1,19 @@
+#include <fstream>
+
+#include <VBE/system/headless/StorageImpl.hpp>
+#include <VBE/system/Log.hpp>
+
+static std::string assetPath = "assets/";
+
+// static
+std::unique_ptr<std::istream> StorageImpl::openAsset(const std::string& filename) {
+    std::ifstream* stream = new std::ifstream(assetPath+filename, std::ios::binary);
+
+    VBE_ASSERT(stream->good(), "Could not open asset: "+filename);
+    return std::unique_ptr<std::istream>(stream);
+}
+
+// static
+void StorageImpl::setAssetPath(std::string path) {
+    assetPath = path;
+}
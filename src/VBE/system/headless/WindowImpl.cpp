@@ -0,0 +1,183 @@
+#include <cstring>
+
+#include <VBE/system/headless/WindowImpl.hpp>
+#include <EGL/eglext.h>
+#include <VBE/system/headless/InputImpl.hpp>
+#include <VBE/system/Log.hpp>
+#include <VBE/graphics/OpenGL.hpp>
+
+// static
+EGLDisplay WindowImpl::display = EGL_NO_DISPLAY;
+EGLSurface WindowImpl::surface = EGL_NO_SURFACE;
+EGLContext WindowImpl::context = EGL_NO_CONTEXT;
+EGLConfig WindowImpl::eglConfig;
+vec2ui WindowImpl::size(0);
+bool WindowImpl::closing = false;
+
+// static
+std::vector<Window::DisplayMode> WindowImpl::getFullscreenModes() {
+    // There is no monitor, fullscreen behaves like a window of the same size
+    std::vector<Window::DisplayMode> v;
+    Window::DisplayMode dm(1920, 1080, 60, Window::DisplayMode::Fullscreen);
+    v.push_back(dm);
+    return v;
+}
+
+// static
+EGLDisplay WindowImpl::openDisplay() {
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if(extensions != nullptr && std::strstr(extensions, "EGL_MESA_platform_surfaceless") != nullptr) {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if(getPlatformDisplay != nullptr) {
+            EGLDisplay d = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if(d != EGL_NO_DISPLAY) return d;
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+// static
+void WindowImpl::create(Window::DisplayMode mode, ContextSettings config) {
+    display = openDisplay();
+    VBE_ASSERT(display != EGL_NO_DISPLAY, "Failed to open an EGL display");
+    EGLint major = 0, minor = 0;
+    EGLBoolean ok = eglInitialize(display, &major, &minor);
+    VBE_ASSERT(ok == EGL_TRUE, "Failed to initialize EGL: EGL error " << eglGetError());
+    VBE_DLOG("* Headless EGL " << major << "." << minor << ": " << eglQueryString(display, EGL_VENDOR));
+    ok = eglBindAPI(EGL_OPENGL_API);
+    VBE_ASSERT(ok == EGL_TRUE, "EGL can't create desktop OpenGL contexts");
+
+    // The default framebuffer is a pbuffer, the closest thing to a window without a display
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, (EGLint) config.redBits,
+        EGL_GREEN_SIZE, (EGLint) config.greenBits,
+        EGL_BLUE_SIZE, (EGLint) config.blueBits,
+        EGL_ALPHA_SIZE, (EGLint) config.alphaBits,
+        EGL_DEPTH_SIZE, (EGLint) config.depthBits,
+        EGL_STENCIL_SIZE, (EGLint) config.stencilBits,
+        EGL_SAMPLE_BUFFERS, (EGLint) config.multisampleBuffers,
+        EGL_SAMPLES, (EGLint) config.multisampleSamples,
+        EGL_NONE
+    };
+    EGLint count = 0;
+    ok = eglChooseConfig(display, configAttribs, &eglConfig, 1, &count);
+    VBE_ASSERT(ok == EGL_TRUE && count > 0, "No EGL config matches the requested context settings");
+    (void) ok;
+
+    // ContextSettings uses the same bits as EGL_KHR_create_context
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION_KHR, (EGLint) config.versionMajor,
+        EGL_CONTEXT_MINOR_VERSION_KHR, (EGLint) config.versionMinor,
+        EGL_CONTEXT_FLAGS_KHR, (EGLint) (config.contextFlags & (ContextSettings::DebugContext |
+                                                                ContextSettings::ForwardCompatibleContext |
+                                                                ContextSettings::RobustAccessContext)),
+        EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, (EGLint) (config.profile & (ContextSettings::CoreProfile |
+                                                                         ContextSettings::CompatibilityProfile)),
+        EGL_NONE
+    };
+    context = eglCreateContext(display, eglConfig, EGL_NO_CONTEXT, contextAttribs);
+    VBE_ASSERT(context != EGL_NO_CONTEXT, "Failed to create OpenGL context: EGL error " << eglGetError());
+
+    createSurface(vec2ui(mode.getWidth(), mode.getHeight()));
+
+    //Init glew. glewInit() would also look for a GLX display, which doesn't exist here.
+    glewExperimental = true;
+    GLenum err = glewContextInit();
+    VBE_ASSERT(err == GLEW_OK, "Failed to initialize GLEW");
+    (void) err;
+    glGetError();
+
+    closing = false;
+    // Init input
+    InputImpl::init();
+}
+
+// static
+void WindowImpl::createSurface(vec2ui newSize) {
+    VBE_ASSERT(newSize.x > 0 && newSize.y > 0, "Window size must not be zero");
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if(surface != EGL_NO_SURFACE) eglDestroySurface(display, surface);
+
+    const EGLint attribs[] = {
+        EGL_WIDTH, (EGLint) newSize.x,
+        EGL_HEIGHT, (EGLint) newSize.y,
+        EGL_NONE
+    };
+    surface = eglCreatePbufferSurface(display, eglConfig, attribs);
+    VBE_ASSERT(surface != EGL_NO_SURFACE, "Failed to create a " << newSize.x << "x" << newSize.y << " pbuffer: EGL error " << eglGetError());
+    EGLBoolean ok = eglMakeCurrent(display, surface, surface, context);
+    VBE_ASSERT(ok == EGL_TRUE, "Failed to make the OpenGL context current");
+    (void) ok;
+    size = newSize;
+}
+
+// static
+void WindowImpl::destroy() {
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroySurface(display, surface);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    surface = EGL_NO_SURFACE;
+    context = EGL_NO_CONTEXT;
+    display = EGL_NO_DISPLAY;
+}
+
+// static
+void WindowImpl::setDisplayMode(Window::DisplayMode mode) {
+    // The pbuffer can't be resized, so a new one replaces it. The context keeps all its objects.
+    createSurface(vec2ui(mode.getWidth(), mode.getHeight()));
+}
+
+// static
+void WindowImpl::setVsync(Window::VsyncMode mode) {
+    // Nothing is presented, so there is nothing to synchronize with
+    (void) mode;
+}
+
+// static
+vec2ui WindowImpl::getSize() {
+    return size;
+}
+
+// static
+void WindowImpl::update() {
+    // No events without a display. Only setClosing() closes the window.
+}
+
+// static
+void WindowImpl::setTitle(std::string newTitle) {
+    // Not applicable
+    (void) newTitle;
+}
+
+// static
+void WindowImpl::setClosing(bool newClosing) {
+    closing = newClosing;
+}
+
+// static
+bool WindowImpl::isFocused() {
+    return true;
+}
+
+// static
+bool WindowImpl::isClosing() {
+    return closing;
+}
+
+// static
+void WindowImpl::setPosition(unsigned int x, unsigned int y) {
+    // Not applicable
+    (void) x;
+    (void) y;
+}
+
+// static
+void WindowImpl::swapBuffers() {
+    // Swapping a pbuffer has no effect, flush so the frame is submitted like a real swap would
+    eglSwapBuffers(display, surface);
+    glFlush();
+}
@@ -0,0 +1,44 @@
+#ifndef WINDOWIMPL_HPP
+#define WINDOWIMPL_HPP
+
+#include <string>
+#include <vector>
+#include <EGL/egl.h>
+
+#include <VBE/math.hpp>
+#include <VBE/system/Window.hpp>
+#include <VBE/system/ContextSettings.hpp>
+
+class WindowImpl {
+    public:
+        static std::vector<Window::DisplayMode> getFullscreenModes();
+        static void create(Window::DisplayMode mode, ContextSettings contextSettings);
+        static void destroy();
+
+        static void setDisplayMode(Window::DisplayMode mode);
+        static void setVsync(Window::VsyncMode mode);
+        static vec2ui getSize();
+
+        static void update();
+        static void setTitle(std::string newTitle);
+        static void setClosing(bool newClosing);
+        static bool isFocused();
+        static bool isClosing();
+        static void setPosition(unsigned int x, unsigned int y);
+
+        static void swapBuffers();
+
+    private:
+        // Opens a display that needs no display server if the driver allows it
+        static EGLDisplay openDisplay();
+        static void createSurface(vec2ui newSize);
+
+        static EGLDisplay display;
+        static EGLSurface surface;
+        static EGLContext context;
+        static EGLConfig eglConfig;
+        static vec2ui size;
+        static bool closing;
+};
+
+#endif // WINDOWIMPL_HPP
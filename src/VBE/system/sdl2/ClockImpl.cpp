@@ -2,11 +2,14 @@
 #include <VBE/system/sdl2/sdl2.hpp>
 
 // static
-long long ClockImpl::getMicroseconds() {
-    return SDL_GetTicks() * 1000;
+long long ClockImpl::getNanoseconds() {
+    static const Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 counter = SDL_GetPerformanceCounter();
+    // Split the conversion so counter*1e9 can't overflow
+    return (counter/frequency)*1000000000LL + (counter%frequency)*1000000000LL/frequency;
 }
 
 // static
-void ClockImpl::sleepMicroseconds(long long useconds) {
-    SDL_Delay((useconds+500)/1000);
+void ClockImpl::sleepMilliseconds(unsigned int mseconds) {
+    SDL_Delay(mseconds);
 }
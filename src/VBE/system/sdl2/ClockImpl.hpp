@@ -4,8 +4,8 @@
 class ClockImpl
 {
     public:
-        static long long getMicroseconds();
-        static void sleepMicroseconds(long long useconds);
+        static long long getNanoseconds();
+        static void sleepMilliseconds(unsigned int mseconds);
 };
 
 #endif // CLOCKIMPL_HPP